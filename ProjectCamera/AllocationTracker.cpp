@@ -0,0 +1,153 @@
+// AllocationTracker.cpp
+// Per-subsystem heap allocation counters and, in tracking builds, the replacement global operator new.
+#include "AllocationTracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> allocationCount[AllocationSubsystemCount];
+static std::atomic<uint64_t> allocationBytes[AllocationSubsystemCount];
+static std::atomic<bool> strictMode{ false };
+static thread_local AllocationSubsystem currentSubsystem = AllocationSubsystem::Other;
+
+AllocationCounters AllocationCounters::Since(const AllocationCounters& earlier) const
+{
+    AllocationCounters difference;
+    for (size_t i = 0; i < AllocationSubsystemCount; ++i)
+    {
+        difference.count[i] = count[i] - earlier.count[i];
+        difference.bytes[i] = bytes[i] - earlier.bytes[i];
+    }
+    return difference;
+}
+
+AllocationCounters AllocationTracker::Read()
+{
+    AllocationCounters counters;
+    for (size_t i = 0; i < AllocationSubsystemCount; ++i)
+    {
+        counters.count[i] = allocationCount[i].load(std::memory_order_relaxed);
+        counters.bytes[i] = allocationBytes[i].load(std::memory_order_relaxed);
+    }
+    return counters;
+}
+
+const char* AllocationTracker::Name(AllocationSubsystem subsystem)
+{
+    switch (subsystem)
+    {
+    case AllocationSubsystem::Other: return "other";
+    case AllocationSubsystem::World: return "world";
+    case AllocationSubsystem::Commands: return "commands";
+    case AllocationSubsystem::Snapshot: return "snapshot";
+    case AllocationSubsystem::Render: return "render";
+    case AllocationSubsystem::Overlay: return "overlay";
+    case AllocationSubsystem::Count: break;
+    }
+    return "?";
+}
+
+void AllocationTracker::SetStrict(bool strict)
+{
+    strictMode.store(strict, std::memory_order_relaxed);
+}
+
+bool AllocationTracker::IsStrict()
+{
+    return strictMode.load(std::memory_order_relaxed);
+}
+
+void AllocationTracker::Record(size_t bytes)
+{
+    size_t i = (size_t)currentSubsystem;
+    allocationCount[i].fetch_add(1, std::memory_order_relaxed);
+    allocationBytes[i].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+AllocationSubsystem AllocationTracker::Current()
+{
+    return currentSubsystem;
+}
+
+AllocationSubsystem AllocationTracker::Exchange(AllocationSubsystem subsystem)
+{
+    AllocationSubsystem previous = currentSubsystem;
+    currentSubsystem = subsystem;
+    return previous;
+}
+
+#ifdef PHYSICS_TRACK_ALLOCATIONS
+
+// Counted malloc; never returns null for a zero-byte request.
+static void* TrackedAllocate(size_t size) noexcept
+{
+    AllocationTracker::Record(size);
+    return std::malloc(size ? size : 1);
+}
+
+// Counted over-aligned allocation.
+static void* TrackedAllocateAligned(size_t size, std::align_val_t alignment) noexcept
+{
+    AllocationTracker::Record(size);
+    size_t align = (size_t)alignment;
+#ifdef _MSC_VER
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    size_t rounded = (size + align) / align * align; // A nonzero multiple of the alignment, as aligned_alloc requires
+    return std::aligned_alloc(align, rounded);
+#endif
+}
+
+static void TrackedFreeAligned(void* memory) noexcept
+{
+#ifdef _MSC_VER
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void* operator new(size_t size)
+{
+    if (void* memory = TrackedAllocate(size)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    if (void* memory = TrackedAllocate(size)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return TrackedAllocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return TrackedAllocate(size); }
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (void* memory = TrackedAllocateAligned(size, alignment)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    if (void* memory = TrackedAllocateAligned(size, alignment)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return TrackedAllocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return TrackedAllocateAligned(size, alignment); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { TrackedFreeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { TrackedFreeAligned(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { TrackedFreeAligned(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { TrackedFreeAligned(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { TrackedFreeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { TrackedFreeAligned(memory); }
+
+#endif
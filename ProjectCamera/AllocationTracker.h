@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @enum AllocationSubsystem
+ * @brief Part of the program a heap allocation is charged to.
+ */
+enum class AllocationSubsystem : uint8_t
+{
+    Other,    ///< Anything outside the scopes below
+    World,    ///< World::Update, including its thread-pool loops
+    Commands, ///< Debugger commands and other changes posted to the simulation thread
+    Snapshot, ///< Publishing render snapshots
+    Render,   ///< Drawing a snapshot
+    Overlay,  ///< Chat window, properties panel and their text
+    Count
+};
+
+/// Number of subsystems, for per-subsystem arrays.
+constexpr size_t AllocationSubsystemCount = (size_t)AllocationSubsystem::Count;
+
+/**
+ * @struct AllocationCounters
+ * @brief Heap allocations and requested bytes per subsystem, summed over all threads.
+ */
+struct AllocationCounters
+{
+    uint64_t count[AllocationSubsystemCount] = {};
+    uint64_t bytes[AllocationSubsystemCount] = {};
+
+    /**
+     * @brief Allocations between an earlier reading and this one.
+     * @param earlier Reading taken before
+     * @return Per-subsystem differences
+     */
+    AllocationCounters Since(const AllocationCounters& earlier) const;
+};
+
+/**
+ * @class AllocationTracker
+ * @brief Counts heap allocations per subsystem in builds with PHYSICS_TRACK_ALLOCATIONS.
+ *
+ * Such builds replace the global operator new (all forms) with one that charges every
+ * allocation to the subsystem of the innermost AllocationScope on the calling thread, using
+ * relaxed atomic counters, and then calls malloc. Frees are not counted. Other builds keep the
+ * standard allocator; Read returns zeros and AllocationScope compiles to nothing.
+ *
+ * In strict mode World::Update must not allocate once the world has settled: Benchmarks fail
+ * when it does, and the overlay reports it.
+ */
+class AllocationTracker
+{
+public:
+#ifdef PHYSICS_TRACK_ALLOCATIONS
+    static constexpr bool Enabled = true;
+#else
+    static constexpr bool Enabled = false;
+#endif
+
+    /**
+     * @brief Totals since the program started.
+     */
+    static AllocationCounters Read();
+
+    /**
+     * @brief Display name of a subsystem.
+     */
+    static const char* Name(AllocationSubsystem subsystem);
+
+    static void SetStrict(bool strict);  ///< Turn strict mode on or off
+    static bool IsStrict();              ///< True in strict mode
+
+    /**
+     * @brief Charge an allocation to the calling thread's subsystem (called by operator new).
+     * @param bytes Requested size
+     */
+    static void Record(size_t bytes);
+
+    /**
+     * @brief Subsystem the calling thread currently charges allocations to.
+     */
+    static AllocationSubsystem Current();
+
+private:
+    friend class AllocationScope;
+    static AllocationSubsystem Exchange(AllocationSubsystem subsystem);
+};
+
+/**
+ * @class AllocationScope
+ * @brief Charges the allocations of the current thread to a subsystem until it goes out of scope.
+ */
+class AllocationScope
+{
+public:
+#ifdef PHYSICS_TRACK_ALLOCATIONS
+    explicit AllocationScope(AllocationSubsystem subsystem) : previous(AllocationTracker::Exchange(subsystem)) {}
+    ~AllocationScope() { AllocationTracker::Exchange(previous); }
+#else
+    explicit AllocationScope(AllocationSubsystem) {}
+#endif
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+private:
+#ifdef PHYSICS_TRACK_ALLOCATIONS
+    AllocationSubsystem previous;
+#endif
+};
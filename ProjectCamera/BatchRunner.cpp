@@ -0,0 +1,161 @@
+// BatchRunner.cpp
+// Runs parameter sweeps as many independent worlds spread over a thread pool.
+#include "BatchRunner.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
+#include "Circle.h"
+#include "ThreadPool.h"
+#include "World.h"
+
+// Store one sweep value into its field. Returns false for an unknown parameter name.
+static bool SetParameter(BatchParameters& parameters, const std::string& name, double value)
+{
+    if (name == "restitution") parameters.restitution = value;
+    else if (name == "friction") parameters.friction = value;
+    else if (name == "mass") parameters.mass = value;
+    else if (name == "dt") parameters.timeStep = value;
+    else if (name == "steps") parameters.steps = (size_t)value;
+    else if (name == "bodies") parameters.bodies = (size_t)value;
+    else if (name == "gravity") parameters.gravity = value != 0.0;
+    else if (name == "seed") parameters.seed = (uint32_t)value;
+    else return false;
+    return true;
+}
+
+bool BatchRunner::LoadSweep(const std::string& path, std::string& error)
+{
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    // Expand axis by axis: every existing configuration times every value of the new axis
+    std::vector<BatchParameters> product(1);
+    std::string line;
+    for (int lineNumber = 1; std::getline(in, line); ++lineNumber)
+    {
+        std::istringstream iss(line.substr(0, line.find('#')));
+        std::string name;
+        if (!(iss >> name)) continue;
+        std::vector<double> values;
+        for (double value; iss >> value; )
+            values.push_back(value);
+        if (name == "restitution" || name == "friction") {
+            // Bodies carry these coefficients, but no contact solver reads them yet
+            error = path + ":" + std::to_string(lineNumber) + ": " + name + " has no effect (there is no collision response)";
+            return false;
+        }
+        BatchParameters probe;
+        if (values.empty() || !iss.eof() || !SetParameter(probe, name, values[0])) {
+            error = path + ":" + std::to_string(lineNumber) + ": expected <parameter> <value>...";
+            return false;
+        }
+        std::vector<BatchParameters> next;
+        next.reserve(product.size() * values.size());
+        for (const auto& base : product)
+            for (double value : values) {
+                next.push_back(base);
+                SetParameter(next.back(), name, value);
+            }
+        product.swap(next);
+    }
+    runs.insert(runs.end(), product.begin(), product.end());
+    return true;
+}
+
+double BatchRunner::Run(size_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    results.assign(runs.size(), BatchResult{});
+
+    // Hand out the most expensive runs first so a long one does not start last
+    std::vector<size_t> order(runs.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return runs[a].steps * runs[a].bodies > runs[b].steps * runs[b].bodies;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    ThreadPool pool(threadCount - 1); // The calling thread takes part as well
+    pool.ParallelFor(order.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            results[order[i]] = RunOne(runs[order[i]]); // Each slot is written by exactly one thread
+    });
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+BatchResult BatchRunner::RunOne(const BatchParameters& parameters)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    World world;
+    world.threadPool = nullptr; // Runs are the unit of parallelism; never nest into a shared pool
+    world.mutualGravity.enabled = parameters.gravity;
+
+    std::mt19937 rng(parameters.seed);
+    std::uniform_real_distribution<double> position(50.0, 750.0);
+    std::uniform_real_distribution<double> velocity(-50.0, 50.0);
+    std::uniform_real_distribution<float> radius(4.0f, 12.0f);
+    for (size_t i = 0; i < parameters.bodies; ++i)
+    {
+        double x = position(rng), y = position(rng);
+        double vx = velocity(rng), vy = velocity(rng);
+        world.AddBody(x, y, vx, vy, 0, 0, new Circle(radius(rng)));
+        Body& body = *world.bodies.back();
+        body.SetMass(parameters.mass);
+        body.coeff_friction = parameters.friction;
+        body.coeff_restitution = parameters.restitution;
+    }
+
+    for (size_t step = 0; step < parameters.steps; ++step)
+        world.Update(parameters.timeStep);
+
+    BatchResult result;
+    double totalMass = 0.0;
+    for (const auto& body : world.bodies)
+    {
+        double vx = double(body->velocity.x), vy = double(body->velocity.y);
+        double mass = double(body->mass);
+        double speedSquared = vx * vx + vy * vy;
+        result.kineticEnergy += 0.5 * mass * speedSquared;
+        result.momentumX += mass * vx;
+        result.momentumY += mass * vy;
+        result.centerX += mass * double(body->position.x);
+        result.centerY += mass * double(body->position.y);
+        result.maxSpeed = std::max(result.maxSpeed, std::sqrt(speedSquared));
+        totalMass += mass;
+    }
+    if (totalMass > 0.0) {
+        result.centerX /= totalMass;
+        result.centerY /= totalMass;
+    }
+    result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+bool BatchRunner::WriteSummary(const std::string& path) const
+{
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "run,restitution,friction,mass,dt,steps,bodies,gravity,seed,"
+           "kinetic_energy,momentum_x,momentum_y,center_x,center_y,max_speed,wall_ms\n";
+    out.precision(10);
+    for (size_t i = 0; i < runs.size() && i < results.size(); ++i)
+    {
+        const BatchParameters& p = runs[i];
+        const BatchResult& r = results[i];
+        out << i << ',' << p.restitution << ',' << p.friction << ',' << p.mass << ',' << p.timeStep << ','
+            << p.steps << ',' << p.bodies << ',' << (p.gravity ? 1 : 0) << ',' << p.seed << ','
+            << r.kineticEnergy << ',' << r.momentumX << ',' << r.momentumY << ','
+            << r.centerX << ',' << r.centerY << ',' << r.maxSpeed << ',' << r.wallMs << '\n';
+    }
+    return (bool)out;
+}
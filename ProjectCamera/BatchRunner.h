@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct BatchParameters
+ * @brief One configuration of a parameter sweep.
+ */
+struct BatchParameters
+{
+    double restitution = 0.5;        ///< Coefficient of restitution of every body (unused until there is a contact solver)
+    double friction = 0.5;           ///< Coefficient of friction of every body (unused until there is a contact solver)
+    double mass = 0.1;               ///< Mass of every body
+    double timeStep = 1.0 / 120.0;   ///< Fixed step passed to World::Update
+    size_t steps = 1000;             ///< Number of steps to run
+    size_t bodies = 100;             ///< Number of bodies in the generated scene
+    bool gravity = false;            ///< Enable Barnes-Hut mutual gravity
+    uint32_t seed = 1;               ///< Seed for the generated scene
+};
+
+/**
+ * @struct BatchResult
+ * @brief Final state of one run, reduced to a few numbers for the summary file.
+ */
+struct BatchResult
+{
+    double kineticEnergy = 0.0; ///< Total linear kinetic energy after the last step
+    double momentumX = 0.0;     ///< Total linear momentum, x
+    double momentumY = 0.0;     ///< Total linear momentum, y
+    double centerX = 0.0;       ///< Center of mass, x
+    double centerY = 0.0;       ///< Center of mass, y
+    double maxSpeed = 0.0;      ///< Fastest body after the last step
+    double wallMs = 0.0;        ///< Time spent building and stepping the world
+};
+
+/**
+ * @class BatchRunner
+ * @brief Runs many independent worlds in one process for parameter sweeps.
+ *
+ * Every run builds its own World (with its own body arena) on whichever pool thread picks
+ * it up, steps it serially and keeps only a BatchResult. Runs share nothing mutable, so
+ * throughput scales with the number of threads. Results are written to one summary file.
+ */
+class BatchRunner
+{
+public:
+    /**
+     * @brief Add the Cartesian product of a sweep file to the run list.
+     *
+     * Each non-empty line names a parameter followed by one or more values, e.g.
+     * "mass 0.1 1 10". Parameters are mass, dt, steps, bodies, gravity (0 or 1) and
+     * seed; anything after '#' is a comment. restitution and friction are rejected:
+     * the engine has no collision response, so they would not change any result.
+     * @param path Sweep file to read
+     * @param error Receives a message if the file cannot be used
+     * @return False if the file could not be read or parsed
+     */
+    bool LoadSweep(const std::string& path, std::string& error);
+
+    /**
+     * @brief Add a single configuration to the run list.
+     * @param parameters Configuration to run
+     */
+    void Add(const BatchParameters& parameters) { runs.push_back(parameters); }
+
+    /**
+     * @brief Run every configuration and wait for all of them.
+     * @param threadCount Threads to spread the runs over, 0 for one per core
+     * @return Wall time of the whole batch in milliseconds
+     */
+    double Run(size_t threadCount);
+
+    /**
+     * @brief Write one CSV line per run (parameters followed by results).
+     * @param path Summary file to create
+     * @return False if the file could not be written
+     */
+    bool WriteSummary(const std::string& path) const;
+
+    /**
+     * @brief Build, step and measure a single world.
+     * @param parameters Configuration to run
+     * @return Final state of the run
+     */
+    static BatchResult RunOne(const BatchParameters& parameters);
+
+    const std::vector<BatchParameters>& GetRuns() const { return runs; }
+    const std::vector<BatchResult>& GetResults() const { return results; }
+
+private:
+    std::vector<BatchParameters> runs;   ///< Configurations in summary order
+    std::vector<BatchResult> results;    ///< Parallel to runs after Run
+};
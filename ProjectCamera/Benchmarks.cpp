@@ -0,0 +1,1192 @@
+// Benchmarks.cpp
+// Headless benchmarks comparing engine paths on synthetic scenes.
+#include "Benchmarks.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include "AllocationTracker.h"
+#include "ContactStream.h"
+#include "GravitySolver.h"
+#include "Fixed.h"
+#include "FluidSystem.h"
+#include "Integrator.h"
+#include "ParticleSystem.h"
+#include "RenderSnapshot.h"
+#include "Scenario.h"
+#include "SceneFile.h"
+#include "SoftBodySystem.h"
+#include "SweepAndPrune.h"
+#include "ThreadPool.h"
+#include "World.h"
+#include "Circle.h"
+#include "ConvexPolygon.h"
+#include "globals.h"
+
+// Milliseconds elapsed since start.
+static double ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// printf-style formatting into a std::string for report lines.
+template<typename... Args>
+static std::string Format(const char* format, Args... args)
+{
+    char buffer[256];
+    std::snprintf(buffer, sizeof(buffer), format, args...);
+    return buffer;
+}
+
+// Exponential disc galaxy: dense core, sparse outskirts.
+static void BuildGalaxy(size_t n, std::vector<double>& x, std::vector<double>& y, std::vector<double>& m)
+{
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    x.resize(n); y.resize(n); m.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        double r = -100.0 * std::log(1.0 - 0.999 * unit(rng));
+        double a = 2.0 * PI * unit(rng);
+        x[i] = 400.0 + r * std::cos(a);
+        y[i] = 400.0 + r * std::sin(a);
+        m[i] = 0.5 + unit(rng);
+    }
+}
+
+// Barnes-Hut against direct summation on a disc galaxy: time and RMS relative force error per theta.
+static void BenchmarkGravity(size_t n, std::vector<std::string>& output)
+{
+    std::vector<double> gx, gy, gm;
+    BuildGalaxy(n, gx, gy, gm);
+    std::vector<Real> x(gx.begin(), gx.end()), y(gy.begin(), gy.end()), m(gm.begin(), gm.end());
+
+    GravitySolver solver;
+    ThreadPool* pool = &ThreadPool::Shared();
+    std::vector<Real> refX(n), refY(n), ax(n), ay(n);
+    auto start = std::chrono::steady_clock::now();
+    solver.ComputeAccelerationsDirect(x.data(), y.data(), m.data(), n, refX.data(), refY.data(), pool);
+    double directMs = ElapsedMs(start);
+    output.push_back(Format("gravity: %zu bodies, %zu threads", n, pool->GetThreadCount()));
+    output.push_back(Format("direct      %9.2f ms", directMs));
+
+    const double thetas[] = { 0.3, 0.5, 0.7, 1.0 };
+    for (double theta : thetas)
+    {
+        solver.theta = theta;
+        solver.ComputeAccelerations(x.data(), y.data(), m.data(), n, ax.data(), ay.data(), pool); // warm-up
+        start = std::chrono::steady_clock::now();
+        solver.ComputeAccelerations(x.data(), y.data(), m.data(), n, ax.data(), ay.data(), pool);
+        double treeMs = ElapsedMs(start);
+        double errorSum = 0.0, refSum = 0.0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            double ex = double(ax[i] - refX[i]), ey = double(ay[i] - refY[i]);
+            errorSum += ex * ex + ey * ey;
+            refSum += double(refX[i] * refX[i] + refY[i] * refY[i]);
+        }
+        double rmsError = refSum > 0.0 ? std::sqrt(errorSum / refSum) : 0.0;
+        output.push_back(Format("theta %.1f   %9.2f ms  speedup %6.1fx  rms error %.4f%%",
+            theta, treeMs, directMs / std::max(treeMs, 1e-6), 100.0 * rmsError));
+    }
+}
+
+// Particle integration throughput: average step time over a burst with gravity and drag.
+static void BenchmarkParticles(size_t n, std::vector<std::string>& output)
+{
+    ParticleSystem particles;
+    particles.Reserve(n);
+    particles.Emit(400.0f, 400.0f, n, 100.0f, 0.0f);
+    particles.gravityY = 98.0f;
+    particles.drag = 0.1f;
+    ThreadPool* pool = &ThreadPool::Shared();
+    const int steps = 100;
+    particles.Update(1.0f / 120.0f, pool); // warm-up
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i)
+        particles.Update(1.0f / 120.0f, pool);
+    double stepMs = ElapsedMs(start) / steps;
+    output.push_back(Format("particles: %zu particles, %zu threads", n, pool->GetThreadCount()));
+    output.push_back(Format("step %.3f ms (%.1f M particles/s)", stepMs, n / (stepMs * 1000.0)));
+}
+
+// Hanging chain of revolute links pinned to the world at its left end.
+static void BuildChain(World& world, size_t links)
+{
+    const double spacing = 4.0;
+    Body* previous = nullptr;
+    for (size_t i = 0; i < links; ++i)
+    {
+        double x = 10.0 + spacing * (i + 0.5);
+        world.AddBody(x, 100.0, 0, 0, 0, 0, new Circle(1.5f));
+        Body* link = world.bodies.back().get();
+        link->gravity.set(0, 200);
+        world.joints.AddRevolute(link, previous, x - spacing * 0.5, 100.0);
+        previous = link;
+    }
+}
+
+// Square cloth of distance joints to the right and below each node, top row pinned.
+static void BuildMesh(World& world, size_t jointCount)
+{
+    size_t side = std::max<size_t>(2, (size_t)std::sqrt(jointCount / 2.0));
+    const double spacing = 4.0;
+    std::vector<Body*> nodes;
+    for (size_t row = 0; row < side; ++row)
+        for (size_t col = 0; col < side; ++col)
+        {
+            double x = 10.0 + spacing * col, y = 10.0 + spacing * row;
+            world.AddBody(x, y, 0, 0, 0, 0, new Circle(1.0f));
+            Body* node = world.bodies.back().get();
+            node->gravity.set(0, 200);
+            nodes.push_back(node);
+            if (row == 0) world.joints.AddRevolute(node, nullptr, x, y);
+            if (col > 0) world.joints.AddDistance(nodes[nodes.size() - 2], node, x - spacing, y, x, y);
+            if (row > 0) world.joints.AddDistance(nodes[nodes.size() - 1 - side], node, x, y - spacing, x, y);
+        }
+}
+
+// Largest separation of rigid joint anchors from their target (pin gap or rod length error).
+static double MaxJointError(const World& world)
+{
+    double worst = 0.0;
+    for (const Joint& joint : world.joints.GetJoints())
+    {
+        Real anchors[4];
+        JointSolver::WorldAnchors(joint, anchors);
+        double gap = double(hypot(anchors[2] - anchors[0], anchors[3] - anchors[1]));
+        if (joint.type == JointType::Distance) gap = std::fabs(gap - double(joint.length));
+        if (joint.type != JointType::Spring) worst = std::max(worst, gap);
+    }
+    return worst;
+}
+
+// Joint solver on a long chain and a pinned cloth: step time serial vs pooled against the fixed-step budget.
+static void BenchmarkJoints(size_t n, std::vector<std::string>& output)
+{
+    const double dt = 1.0 / 120.0;
+    const int steps = 120;
+    ThreadPool* shared = &ThreadPool::Shared();
+    output.push_back(Format("joints: %zu per scene, %zu threads, budget %.2f ms/step", n, shared->GetThreadCount(), dt * 1000.0));
+    const char* names[] = { "chain", "cloth" };
+    for (int scene = 0; scene < 2; ++scene)
+    {
+        double stepMs[2] = {};
+        double error = 0.0;
+        size_t joints = 0, rows = 0, colors = 0;
+        for (int parallel = 0; parallel < 2; ++parallel)
+        {
+            World world;
+            world.threadPool = parallel ? shared : nullptr;
+            if (scene == 0) BuildChain(world, n);
+            else BuildMesh(world, n);
+            world.Update(dt); // colors the rows
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < steps; ++i)
+                world.Update(dt);
+            stepMs[parallel] = ElapsedMs(start) / steps;
+            error = MaxJointError(world);
+            joints = world.joints.GetJoints().size();
+            rows = world.joints.GetRowCount();
+            colors = world.joints.GetColorCount();
+        }
+        output.push_back(Format("%-6s %zu joints, %zu rows, %zu colors: serial %.3f ms, pooled %.3f ms, max error %.4f",
+            names[scene], joints, rows, colors, stepMs[0], stepMs[1], error));
+    }
+}
+
+// Kick-drift-kick leapfrog with direct-sum gravity in precision T, starting from rest.
+template<typename T>
+static void IntegrateGalaxy(const GravitySolver& solver, std::vector<T>& x, std::vector<T>& y,
+    std::vector<T>& vx, std::vector<T>& vy, const std::vector<T>& m, int steps, T dt, ThreadPool* pool)
+{
+    size_t n = x.size();
+    std::vector<T> ax(n), ay(n);
+    vx.assign(n, T(0));
+    vy.assign(n, T(0));
+    solver.ComputeAccelerationsDirect(x.data(), y.data(), m.data(), n, ax.data(), ay.data(), pool);
+    for (int step = 0; step < steps; ++step)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            vx[i] += T(0.5) * dt * ax[i]; vy[i] += T(0.5) * dt * ay[i];
+            x[i] += dt * vx[i]; y[i] += dt * vy[i];
+        }
+        solver.ComputeAccelerationsDirect(x.data(), y.data(), m.data(), n, ax.data(), ay.data(), pool);
+        for (size_t i = 0; i < n; ++i)
+        {
+            vx[i] += T(0.5) * dt * ax[i]; vy[i] += T(0.5) * dt * ay[i];
+        }
+    }
+}
+
+// Total kinetic plus softened potential energy, always summed in double.
+template<typename T>
+static double GalaxyEnergy(const GravitySolver& solver, const std::vector<T>& x, const std::vector<T>& y,
+    const std::vector<T>& vx, const std::vector<T>& vy, const std::vector<T>& m)
+{
+    double eps2 = solver.softening * solver.softening, energy = 0.0;
+    for (size_t i = 0; i < x.size(); ++i)
+    {
+        energy += 0.5 * m[i] * ((double)vx[i] * vx[i] + (double)vy[i] * vy[i]);
+        for (size_t j = i + 1; j < x.size(); ++j)
+        {
+            double dx = (double)x[j] - x[i], dy = (double)y[j] - y[i];
+            energy -= solver.gravitationalConstant * m[i] * m[j] / std::sqrt(dx * dx + dy * dy + eps2);
+        }
+    }
+    return energy;
+}
+
+// Float against double on the standard scenes: kernel throughput, force error and trajectory drift.
+static void BenchmarkPrecision(size_t n, std::vector<std::string>& output)
+{
+    ThreadPool* pool = &ThreadPool::Shared();
+    GravitySolver solver;
+    std::vector<double> xd, yd, md;
+    BuildGalaxy(n, xd, yd, md);
+    std::vector<float> xf(xd.begin(), xd.end()), yf(yd.begin(), yd.end()), mf(md.begin(), md.end());
+    output.push_back(Format("precision: engine built with Real = %s, %zu bodies, %zu threads",
+        RealName, n, pool->GetThreadCount()));
+
+    // Direct-sum kernel: 4 double lanes against 8 float lanes
+    std::vector<double> axd(n), ayd(n);
+    std::vector<float> axf(n), ayf(n);
+    solver.ComputeAccelerationsDirect(xd.data(), yd.data(), md.data(), n, axd.data(), ayd.data(), pool); // warm-up
+    auto start = std::chrono::steady_clock::now();
+    solver.ComputeAccelerationsDirect(xd.data(), yd.data(), md.data(), n, axd.data(), ayd.data(), pool);
+    double doubleMs = ElapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    solver.ComputeAccelerationsDirect(xf.data(), yf.data(), mf.data(), n, axf.data(), ayf.data(), pool);
+    double floatMs = ElapsedMs(start);
+    double errorSum = 0.0, refSum = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        double ex = axf[i] - axd[i], ey = ayf[i] - ayd[i];
+        errorSum += ex * ex + ey * ey;
+        refSum += axd[i] * axd[i] + ayd[i] * ayd[i];
+    }
+    output.push_back(Format("gravity kernel  double %8.2f ms  float %8.2f ms  speedup %.2fx  rms force error %.2e",
+        doubleMs, floatMs, doubleMs / std::max(floatMs, 1e-6), refSum > 0.0 ? std::sqrt(errorSum / refSum) : 0.0));
+
+    // One simulated second of the collapsing galaxy in each precision
+    const int steps = 120;
+    std::vector<double> vxd, vyd;
+    std::vector<float> vxf, vyf;
+    double initialEnergy = GalaxyEnergy(solver, xd, yd, std::vector<double>(n, 0.0), std::vector<double>(n, 0.0), md);
+    IntegrateGalaxy(solver, xd, yd, vxd, vyd, md, steps, 1.0 / 120.0, pool);
+    IntegrateGalaxy(solver, xf, yf, vxf, vyf, mf, steps, 1.0f / 120.0f, pool);
+    double divergence = 0.0;
+    for (size_t i = 0; i < n; ++i)
+        divergence = std::max(divergence, std::hypot(xf[i] - xd[i], yf[i] - yd[i]));
+    double driftDouble = GalaxyEnergy(solver, xd, yd, vxd, vyd, md) / initialEnergy - 1.0;
+    double driftFloat = GalaxyEnergy(solver, xf, yf, vxf, vyf, mf) / initialEnergy - 1.0;
+    output.push_back(Format("galaxy %d steps  energy drift double %.2e  float %.2e  max position divergence %.2e",
+        steps, driftDouble, driftFloat, divergence));
+
+    // Engine scene in whatever precision this build uses
+    World world;
+    BuildChain(world, 1000);
+    for (int i = 0; i < steps; ++i)
+        world.Update(1.0 / 120.0);
+    output.push_back(Format("chain 1000 links %d steps  max joint error %.4f (Real = %s)",
+        steps, MaxJointError(world), RealName));
+}
+
+// Kinetic plus softened potential energy of a world's bodies under its mutual gravity.
+static double WorldEnergy(const World& world)
+{
+    std::vector<double> x, y, vx, vy, m;
+    for (const auto& body : world.bodies)
+    {
+        x.push_back(double(body->position.x)); y.push_back(double(body->position.y));
+        vx.push_back(double(body->velocity.x)); vy.push_back(double(body->velocity.y));
+        m.push_back(double(body->mass));
+    }
+    return GalaxyEnergy(world.mutualGravity, x, y, vx, vy, m);
+}
+
+// Heavy star with three planets on eccentric orbits, under mutual gravity only.
+static void BuildOrbits(World& world)
+{
+    world.threadPool = nullptr; // Four bodies: pool overhead would dominate
+    world.mutualGravity.enabled = true;
+    world.mutualGravity.softening = 0.1;
+    world.CreateBody(BodyType::Dynamic, 0, 0, 0, 0)->SetMass(1000);
+    const double radius[3] = { 60, 100, 150 }, eccentricity[3] = { 0.7, 0.8, 0.9 };
+    for (int i = 0; i < 3; ++i)
+    {
+        double speed = eccentricity[i] * std::sqrt(1000 / radius[i]); // below circular speed
+        world.CreateBody(BodyType::Dynamic, radius[i], 0, 0, speed)->SetMass(1);
+    }
+}
+
+// Energy drift per integrator on an orbit problem, and the largest timestep each allows at equal error.
+static void BenchmarkIntegrators(size_t n, std::vector<std::string>& output)
+{
+    const double duration = 1000.0;  // About five orbits of the outer planet
+    const double tolerance = 1e-4;   // Allowed max relative energy error over the run
+    const IntegratorType types[3] = { IntegratorType::SymplecticEuler, IntegratorType::VelocityVerlet, IntegratorType::RK4 };
+    output.push_back(Format("integrators: star and 3 eccentric planets, %.0f time units, max |dE/E| <= %.0e", duration, tolerance));
+    double euler = 0.0;
+    for (IntegratorType type : types)
+    {
+        // Halve the step from a coarse one until the energy error over the run is within tolerance
+        double dt = 0.0, error = 0.0, ms = 0.0;
+        size_t steps = 0;
+        for (steps = 64; ; steps *= 2)
+        {
+            World world;
+            BuildOrbits(world);
+            world.SetIntegrator(type);
+            double initial = WorldEnergy(world);
+            dt = duration / steps;
+            error = 0.0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t step = 0; step < steps; ++step)
+            {
+                world.Update(dt);
+                if (step % 64 == 63)
+                    error = std::max(error, std::fabs(WorldEnergy(world) / initial - 1.0));
+            }
+            ms = ElapsedMs(start);
+            if (error <= tolerance || steps >= (1u << 21)) break;
+        }
+        int evaluations = Integrator::Create(type)->EvaluationsPerStep();
+        if (type == IntegratorType::SymplecticEuler) euler = dt;
+        output.push_back(Format("%-7s largest dt %9.5f (%5.1fx)  %8zu steps  %8zu evaluations  |dE/E| %.1e  %8.1f ms",
+            Integrator::Name(type), dt, dt / euler, steps, steps * evaluations, error, ms));
+    }
+
+    // Cost of one step over a large batch: uniform gravity and drag, no field
+    BodyBatch batch;
+    batch.Resize(n);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> unit(0, 1);
+    for (size_t i = 0; i < n; ++i)
+    {
+        batch.x[i] = Real(800 * unit(rng)); batch.y[i] = Real(800 * unit(rng));
+        batch.vx[i] = Real(20 * unit(rng) - 10); batch.vy[i] = Real(20 * unit(rng) - 10);
+        batch.baseAy[i] = 98; batch.dragX[i] = batch.dragY[i] = Real(0.1); batch.fieldScale[i] = 1;
+    }
+    std::string line = Format("batch of %zu bodies, ms/step:", n);
+    for (IntegratorType type : types)
+    {
+        std::unique_ptr<Integrator> integrator = Integrator::Create(type);
+        integrator->Step(batch, Real(1.0 / 120.0)); // warm-up, sizes the stage arrays
+        const int steps = 50;
+        auto start = std::chrono::steady_clock::now();
+        for (int step = 0; step < steps; ++step)
+            integrator->Step(batch, Real(1.0 / 120.0));
+        line += Format("  %s %.3f", Integrator::Name(type), ElapsedMs(start) / steps);
+    }
+    output.push_back(line);
+}
+
+// Many slow drifting bodies plus a few fast two-link pendulums whirling around world pins.
+static void BuildWhirl(World& world, size_t slow, size_t pendulums)
+{
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> position(0.0, 800.0), velocity(-10.0, 10.0);
+    for (size_t i = 0; i < slow; ++i)
+        world.AddBody(position(rng), position(rng), velocity(rng), velocity(rng), 0, 0, new Circle(2.0f));
+    for (size_t i = 0; i < pendulums; ++i)
+    {
+        double px = 100.0 + 150.0 * (i % 5), py = 100.0 + 150.0 * (i / 5);
+        const double omega = 15.0; // rad/s: the outer bob moves at 1200 units/s
+        world.AddBody(px + 40.0, py, 0, omega * 40.0, 0, 0, new Circle(2.0f));
+        Body* inner = world.bodies.back().get();
+        world.AddBody(px + 80.0, py, 0, omega * 80.0, 0, 0, new Circle(2.0f));
+        Body* outer = world.bodies.back().get();
+        world.joints.AddDistance(inner, nullptr, px + 40.0, py, px, py);
+        world.joints.AddDistance(outer, inner, px + 80.0, py, px + 40.0, py);
+    }
+}
+
+// Adaptive per-island substeps against one coarse step and against a globally fine step.
+static void BenchmarkSubsteps(size_t n, std::vector<std::string>& output)
+{
+    const size_t pendulums = 20;
+    const int steps = 120, fine = 16;
+    const double dt = 1.0 / 120.0;
+    const char* names[3] = { "coarse step", "global x16", "adaptive" };
+    output.push_back(Format("substeps: %zu slow bodies, %zu fast two-link pendulums, %d steps of %.4f s", n, pendulums, steps, dt));
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        World world;
+        BuildWhirl(world, n, pendulums);
+        world.substepper.enabled = mode == 2;
+        world.substepper.maxSubsteps = fine;
+        world.Update(dt); // warm-up: joint coloring, island index
+        auto start = std::chrono::steady_clock::now();
+        for (int step = 1; step < steps; ++step)
+        {
+            if (mode == 1)
+                for (int s = 0; s < fine; ++s) world.Update(dt / fine);
+            else
+                world.Update(dt);
+        }
+        double ms = ElapsedMs(start) / (steps - 1);
+        std::string detail = mode == 2 ? Format("  %zu islands, %zu bodies substepped",
+            world.substepper.GetIslandCount(), world.substepper.GetSubsteppedCount()) : std::string();
+        output.push_back(Format("%-12s %8.3f ms/step  max rod error %8.4f", names[mode], ms, MaxJointError(world)) + detail);
+    }
+}
+
+// Distinct cache lines of a body that World::Update reads or writes (the hot record, wherever it lands).
+static size_t TouchedCacheLines(const Body& body)
+{
+    const uintptr_t first = reinterpret_cast<uintptr_t>(static_cast<const BodyMotion*>(&body));
+    const uintptr_t last = first + sizeof(BodyMotion) - 1;
+    return last / 64 - first / 64 + 1;
+}
+
+// Body footprint and per-body step cost on a large world of drifting circles.
+static void BenchmarkLayout(size_t n, std::vector<std::string>& output)
+{
+    World world;
+    world.threadPool = nullptr;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> position(0.0, 800.0), velocity(-10.0, 10.0);
+    for (size_t i = 0; i < n; ++i)
+        world.AddBody(position(rng), position(rng), velocity(rng), velocity(rng), 0, 0, new Circle(2.0f));
+    size_t lines = 0;
+    for (const auto& body : world.bodies)
+        lines += TouchedCacheLines(*body);
+    for (int step = 0; step < 3; ++step)
+        world.Update(1.0 / 120.0); // warm-up
+    const int steps = 20;
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 0; step < steps; ++step)
+        world.Update(1.0 / 120.0);
+    double ms = ElapsedMs(start) / steps;
+    output.push_back(Format("layout: %zu bodies, sizeof(Body) %zu bytes, hot record %zu bytes",
+        n, sizeof(Body), sizeof(BodyMotion)));
+    output.push_back(Format("touched per body per step: %.2f cache lines = %.0f bytes", (double)lines / n, 64.0 * lines / n));
+    output.push_back(Format("step %8.3f ms  %.1f ns/body", ms, ms * 1e6 / n));
+}
+
+// Sweep and prune on a settled pile: incremental insertion sort against a full re-sort every step.
+static void BenchmarkPile(size_t n, std::vector<std::string>& output)
+{
+    // Rows of circles with mixed radii, nested into the gaps of the row below, 800 units wide
+    World world;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> radius(1.5, 2.5), sink(0.0, 1.0);
+    std::vector<double> restX, restY;
+    double x = 0.0, y = 800.0, rowHeight = 0.0;
+    while (restX.size() < n)
+    {
+        double r = radius(rng);
+        if (x + 2.0 * r > 800.0) { // next row rests on this one
+            x = 0.0;
+            y -= 0.85 * rowHeight;
+            rowHeight = 0.0;
+        }
+        restX.push_back(x + r);
+        restY.push_back(y - r - sink(rng));
+        world.AddBody(restX.back(), restY.back(), 0, 0, 0, 0, new Circle((float)r));
+        x += 2.0 * r;
+        rowHeight = std::max(rowHeight, 2.0 * r + 1.0);
+    }
+
+    // Resting contacts only creep: a slowly wandering offset around the rest position
+    std::normal_distribution<double> creep(0.0, 0.002);
+    std::vector<double> offsetX(n, 0.0), offsetY(n, 0.0);
+    auto settle = [&]() {
+        size_t i = 0;
+        for (auto& bodyPtr : world.bodies) {
+            offsetX[i] = 0.95 * offsetX[i] + creep(rng);
+            offsetY[i] = 0.95 * offsetY[i] + creep(rng);
+            bodyPtr->position.set(restX[i] + offsetX[i], restY[i] + offsetY[i]);
+            ++i;
+        }
+    };
+
+    SweepAndPrune incremental, full;
+    settle();
+    incremental.Update(world.bodies, world.version); // initial full sort
+    const int steps = 200;
+    double incrementalMs = 0.0, fullMs = 0.0;
+    size_t swaps = 0, mismatches = 0;
+    for (int step = 0; step < steps; ++step)
+    {
+        settle();
+        auto start = std::chrono::steady_clock::now();
+        incremental.Update(world.bodies, world.version);
+        incrementalMs += ElapsedMs(start);
+        swaps += incremental.GetSwapCount();
+
+        start = std::chrono::steady_clock::now();
+        full.Reset();
+        full.Update(world.bodies, world.version);
+        fullMs += ElapsedMs(start);
+        if (incremental.GetPairCount() != full.GetPairCount()) ++mismatches;
+    }
+    output.push_back(Format("pile: %zu bodies, %zu pairs, %d steps", world.bodies.size(), full.GetPairCount(), steps));
+    output.push_back(Format("incremental %8.3f ms/step  %8.1f swaps/step", incrementalMs / steps, (double)swaps / steps));
+    output.push_back(Format("full sort   %8.3f ms/step  speedup %.1fx  pair count mismatches %zu",
+        fullMs / steps, fullMs / std::max(incrementalMs, 1e-6), mismatches));
+}
+
+// Cost of level geometry per step: the same boxes added as static bodies versus ordinary bodies.
+static void BenchmarkStatic(size_t n, std::vector<std::string>& output)
+{
+    const size_t movers = 500;
+    const int steps = 100;
+    double stepMs[2] = {};
+    for (int asStatic = 0; asStatic < 2; ++asStatic)
+    {
+        World world;
+        world.broadPhase.enabled = true;
+        std::vector<Vector<Real>> corners(4, Vector<Real>(2));
+        corners[0].set(-2, -2); corners[1].set(2, -2); corners[2].set(2, 2); corners[3].set(-2, 2);
+        for (size_t i = 0; i < n; ++i)
+        {
+            double x = 4.0 * (i % 200), y = 800.0 - 4.0 * (i / 200);
+            if (asStatic) world.AddStaticBody(x, y, new ConvexPolygon(corners));
+            else world.AddBody(x, y, 0, 0, 0, 0, new ConvexPolygon(corners));
+        }
+        for (size_t i = 0; i < movers; ++i)
+            world.AddBody(10.0 + (i % 50) * 15.0, 10.0 + (i / 50) * 15.0, 5.0, 20.0, 0, 0, new Circle(3.0f));
+        world.Update(1.0 / 120.0); // warm-up, includes the one-time sort
+        auto start = std::chrono::steady_clock::now();
+        for (int step = 0; step < steps; ++step)
+            world.Update(1.0 / 120.0);
+        stepMs[asStatic] = ElapsedMs(start) / steps;
+    }
+    output.push_back(Format("static: %zu level boxes, %zu moving bodies, broad phase on", n, movers));
+    output.push_back(Format("as bodies        %8.3f ms/step", stepMs[0]));
+    output.push_back(Format("as static bodies %8.3f ms/step  speedup %.1fx", stepMs[1], stepMs[0] / std::max(stepMs[1], 1e-6)));
+}
+
+// Scene export and parallel load throughput, with a round-trip check.
+static void BenchmarkScene(size_t n, std::vector<std::string>& output)
+{
+    World source;
+    source.threadPool = nullptr;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> position(0.0, 800.0), velocity(-20.0, 20.0), size(1.0, 4.0);
+    std::vector<Vector<Real>> corners(4, Vector<Real>(2));
+    for (size_t i = 0; i < n; ++i)
+    {
+        double s = size(rng);
+        if (i % 4 == 3) {
+            corners[0].set(-s, -s); corners[1].set(s, -s); corners[2].set(s, s); corners[3].set(-s, s);
+            source.AddBody(position(rng), position(rng), velocity(rng), velocity(rng), 0, 0, new ConvexPolygon(corners));
+        } else {
+            source.AddBody(position(rng), position(rng), velocity(rng), velocity(rng), 0, 0, new Circle((float)s), 0.002);
+        }
+    }
+
+    std::string text;
+    auto start = std::chrono::steady_clock::now();
+    SceneFile::Write(source, text);
+    double writeMs = ElapsedMs(start);
+
+    ThreadPool* pool = &ThreadPool::Shared();
+    World loaded;
+    std::string error;
+    start = std::chrono::steady_clock::now();
+    bool ok = SceneFile::Parse(loaded, text, error, pool);
+    double loadMs = ElapsedMs(start);
+
+    std::string again;
+    SceneFile::Write(loaded, again);
+    double mb = text.size() / 1e6;
+    output.push_back(Format("scene: %zu bodies, %.1f MB, %zu threads", n, mb, pool->GetThreadCount()));
+    output.push_back(Format("export %8.1f ms  %7.1f MB/s", writeMs, mb * 1000.0 / std::max(writeMs, 1e-6)));
+    output.push_back(Format("load   %8.1f ms  %7.1f MB/s  %.2f M bodies/s  %s", loadMs, mb * 1000.0 / std::max(loadMs, 1e-6),
+        n / (loadMs * 1000.0), !ok ? error.c_str() : again == text ? "round trip identical" : "ROUND TRIP DIFFERS"));
+}
+
+// Nanoseconds per element of multiply-add, divide, sqrt and sin over the inputs in type T.
+template<typename T>
+static void ScalarThroughput(const std::vector<double>& inputA, const std::vector<double>& inputB, double ns[4], double& checksum)
+{
+    size_t n = inputA.size();
+    std::vector<T> a(n), b(n), out(n);
+    for (size_t i = 0; i < n; ++i) { a[i] = T(inputA[i]); b[i] = T(inputB[i]); }
+    auto time = [&](auto kernel) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i)
+            out[i] = kernel(a[i], b[i]);
+        double ms = ElapsedMs(start);
+        for (size_t i = 0; i < n; i += 97) checksum += double(out[i]); // keep the results alive
+        return ms * 1e6 / n;
+    };
+    ns[0] = time([](T x, T y) { return x * y + y; });
+    ns[1] = time([](T x, T y) { return x / y; });
+    ns[2] = time([](T x, T) { return sqrt(x); });
+    ns[3] = time([](T x, T) { return sin(x); });
+}
+
+// FNV-1a over the bits of every body's position, velocity, rotation and spin.
+static uint64_t StateHash(const World& world)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (const auto& body : world.bodies)
+        for (Real value : { body->position.x, body->position.y, body->velocity.x, body->velocity.y, body->rotation, body->angular_vel })
+        {
+            unsigned char bytes[sizeof(Real)];
+            std::memcpy(bytes, &value, sizeof(Real));
+            for (unsigned char byte : bytes) { hash ^= byte; hash *= 1099511628211ull; }
+        }
+    return hash;
+}
+
+// A chain with circles raining through it: joints, contacts and drag, stepped for two seconds.
+// Inputs come from raw mt19937 output, which the standard fixes, so every build starts alike.
+static uint64_t DeterminismRun(ThreadPool* pool, int steps, double& msPerStep)
+{
+    World world;
+    world.threadPool = pool;
+    world.broadPhase.enabled = true;
+    BuildChain(world, 200);
+    std::mt19937 rng(11);
+    for (int i = 0; i < 400; ++i)
+    {
+        double x = 10.0 + (rng() % 8000) / 10.0, y = (rng() % 800) / 10.0;
+        double vx = (int)(rng() % 200) - 100.0, vy = (int)(rng() % 200) - 100.0;
+        world.AddBody(x, y, vx, vy, 0, 0, new Circle(1.0f + (rng() % 3)));
+        world.bodies.back()->gravity.set(0, 200);
+        world.bodies.back()->liniar_drag.set(0.05, 0.05);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 0; step < steps; ++step)
+        world.Update(1.0 / 120.0);
+    msPerStep = ElapsedMs(start) / steps;
+    return StateHash(world);
+}
+
+// State hash of DeterminismRun that every fixed-point build must reproduce, whatever the CPU and compiler.
+static constexpr uint64_t ExpectedFixedHash = 0x0ab8f9ccbd702649ull;
+
+// Fixed-point scalar throughput against double, and the state hash that fixed-point builds share.
+// Returns false in a fixed-point build whose serial or pooled hash differs from the expected one.
+static bool BenchmarkFixed(size_t n, std::vector<std::string>& output)
+{
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> magnitude(0.5, 100.0), divisor(0.5, 2.0);
+    std::vector<double> a(n), b(n);
+    for (size_t i = 0; i < n; ++i) { a[i] = magnitude(rng); b[i] = divisor(rng); }
+    double doubleNs[4], fixedNs[4], checksum = 0.0;
+    ScalarThroughput<double>(a, b, doubleNs, checksum);
+    ScalarThroughput<Fixed>(a, b, fixedNs, checksum);
+    output.push_back(Format("fixed: %zu values, ns/op double vs Q32.32 (checksum %.3g)", n, checksum));
+    const char* names[4] = { "mul-add", "divide", "sqrt", "sin" };
+    for (int k = 0; k < 4; ++k)
+        output.push_back(Format("%-8s double %6.2f  fixed %6.2f  ratio %5.1f", names[k], doubleNs[k], fixedNs[k],
+            fixedNs[k] / std::max(doubleNs[k], 1e-6)));
+
+    // Same scene serial and pooled; a fixed-point build prints the same hash on every machine and compiler
+    const int steps = 240;
+    double serialMs, pooledMs;
+    uint64_t serial = DeterminismRun(nullptr, steps, serialMs);
+    uint64_t pooled = DeterminismRun(&ThreadPool::Shared(), steps, pooledMs);
+    output.push_back(Format("world %d steps (Real = %s): %.3f ms/step serial, %.3f ms/step pooled",
+        steps, RealName, serialMs, pooledMs));
+    output.push_back(Format("state hash %016llx  %s", (unsigned long long)serial,
+        serial == pooled ? "serial and pooled identical" : "POOLED DIFFERS"));
+#if defined(PHYSICS_FIXED_POINT)
+    bool reproduced = serial == ExpectedFixedHash && pooled == ExpectedFixedHash;
+    output.push_back(Format("expected %016llx  %s", (unsigned long long)ExpectedFixedHash,
+        reproduced ? "reproduced" : "MISMATCH: this build does not step like other fixed-point builds"));
+    return reproduced;
+#else
+    return true;
+#endif
+}
+
+// Scripted behavior for the scenario benchmark: count a tick every period steps.
+static ScenarioTask TickScenario(uint64_t period, uint64_t& ticks)
+{
+    for (;;)
+    {
+        co_await WaitSteps{ period };
+        ++ticks;
+    }
+}
+
+// Waiting behaviors: coroutines in the timing wheel against checking every behavior every step.
+static void BenchmarkScenarios(size_t n, std::vector<std::string>& output)
+{
+    const int steps = 2000;
+    std::mt19937 rng(4);
+    std::uniform_int_distribution<uint64_t> period(1, 600); // up to 5 s at 120 Hz
+    std::vector<uint64_t> periods(n);
+    for (uint64_t& p : periods) p = period(rng);
+
+    // Polling: every behavior is asked each step whether it is due
+    World polled;
+    std::vector<std::function<void(uint64_t)>> behaviors;
+    uint64_t polledTicks = 0;
+    for (uint64_t p : periods)
+        behaviors.push_back([p, next = p, &polledTicks](uint64_t step) mutable {
+            if (step < next) return;
+            ++polledTicks;
+            next += p;
+        });
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 0; step < steps; ++step)
+    {
+        polled.Update(1.0 / 120.0);
+        for (auto& behavior : behaviors) behavior(polled.stepCount);
+    }
+    double polledMs = ElapsedMs(start) / steps;
+
+    // Coroutines: only the due ones are touched
+    World scripted;
+    uint64_t scriptedTicks = 0;
+    for (uint64_t p : periods)
+        scripted.scenarios.Start(TickScenario(p, scriptedTicks));
+    size_t resumed = 0;
+    start = std::chrono::steady_clock::now();
+    for (int step = 0; step < steps; ++step)
+    {
+        scripted.Update(1.0 / 120.0);
+        resumed += scripted.scenarios.GetResumedCount();
+    }
+    double scriptedMs = ElapsedMs(start) / steps;
+    scripted.scenarios.StopAll();
+
+    output.push_back(Format("scenarios: %zu waiting behaviors, %d steps, %.1f resumed per step", n, steps, (double)resumed / steps));
+    output.push_back(Format("polling    %8.4f ms/step  %llu ticks", polledMs, (unsigned long long)polledTicks));
+    output.push_back(Format("coroutines %8.4f ms/step  %llu ticks  speedup %.1fx", scriptedMs,
+        (unsigned long long)scriptedTicks, polledMs / std::max(scriptedMs, 1e-6)));
+}
+
+// Grid of circles just touching their neighbors, drifting so contacts begin and end; odd rows are category 2.
+static void BuildContactGrid(World& world, size_t n)
+{
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> drift(-0.2, 0.2);
+    size_t columns = (size_t)std::sqrt((double)n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        world.AddBody(1.95 * (i % columns), 1.95 * (i / columns), drift(rng), drift(rng), 0, 0, new Circle(1.0f));
+        world.bodies.back()->category = (i / columns) % 2 ? 2u : 1u;
+    }
+}
+
+// Static circles in the gaps between four grid circles, touching them as they drift; returns how many.
+static size_t BuildContactLevel(World& world, size_t n)
+{
+    size_t columns = (size_t)std::sqrt((double)n), rows = (n + columns - 1) / columns;
+    for (size_t r = 0; r + 1 < rows; ++r)
+        for (size_t c = 0; c + 1 < columns; ++c)
+            world.CreateBody(BodyType::Static, 1.95 * (c + 0.5), 1.95 * (r + 0.5), 0, 0)->AttachShape(Circle(0.4f), 1);
+    return world.staticBodies.size();
+}
+
+// FNV-1a over the body indices of every event, in array order.
+static uint64_t EventHash(const ContactStream& contacts)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (ContactPhase phase : { ContactPhase::Begin, ContactPhase::Persist, ContactPhase::End })
+        for (const ContactEvent& event : contacts.Events(phase))
+            for (uint32_t value : { event.indexA, event.indexB, (uint32_t)phase })
+            {
+                hash ^= value;
+                hash *= 1099511628211ull;
+            }
+    return hash;
+}
+
+// Cost of contact events per step on top of the broad phase, and of consuming them.
+static void BenchmarkContacts(size_t n, std::vector<std::string>& output)
+{
+    const int steps = 100;
+    double stepMs[3] = {}, consumeMs = 0.0, selectMs = 0.0;
+    size_t events[3] = {}, selected = 0;
+    uint64_t hashes[2] = { 14695981039346656037ull, 14695981039346656037ull };
+    Real depthSum = 0;
+    for (int mode = 0; mode < 3; ++mode) // broad phase only, contacts serial, contacts pooled
+    {
+        World world;
+        world.broadPhase.enabled = true;
+        world.contacts.enabled = mode > 0;
+        world.threadPool = mode == 1 ? nullptr : &ThreadPool::Shared();
+        BuildContactGrid(world, n);
+        world.Update(1.0 / 60.0); // warm-up, includes the one-time sort and the first begin batch
+        std::vector<const ContactEvent*> filtered;
+        for (int step = 0; step < steps; ++step)
+        {
+            auto start = std::chrono::steady_clock::now();
+            world.Update(1.0 / 60.0);
+            stepMs[mode] += ElapsedMs(start);
+            if (mode == 0) continue;
+            hashes[mode - 1] = hashes[mode - 1] * 31 + EventHash(world.contacts);
+            if (mode != 2) continue;
+
+            // Consumers: a pass over every event, then the category-2 begins of the grid
+            start = std::chrono::steady_clock::now();
+            for (int phase = 0; phase < 3; ++phase)
+            {
+                const std::vector<ContactEvent>& list = world.contacts.Events((ContactPhase)phase);
+                events[phase] += list.size();
+                for (const ContactEvent& event : list)
+                    depthSum += event.depth;
+            }
+            consumeMs += ElapsedMs(start);
+            start = std::chrono::steady_clock::now();
+            filtered.clear();
+            world.contacts.Select(ContactPhase::Begin, nullptr, 2u, filtered);
+            selectMs += ElapsedMs(start);
+            selected += filtered.size();
+        }
+    }
+    double perStep = (double)(events[0] + events[1] + events[2]) / steps;
+    output.push_back(Format("contacts: %zu circles, %d steps, %.0f events/step (begin %.0f, persist %.0f, end %.0f)",
+        n, steps, perStep, (double)events[0] / steps, (double)events[1] / steps, (double)events[2] / steps));
+    output.push_back(Format("broad phase only   %8.3f ms/step", stepMs[0] / steps));
+    output.push_back(Format("contacts serial    %8.3f ms/step", stepMs[1] / steps));
+    output.push_back(Format("contacts pooled    %8.3f ms/step  (%zu threads)", stepMs[2] / steps, ThreadPool::Shared().GetThreadCount()));
+    output.push_back(Format("consume all events %8.3f ms/step  (%.1f ns/event, depth sum %.3g)",
+        consumeMs / steps, consumeMs * 1e6 / std::max(perStep * steps, 1.0), double(depthSum)));
+    output.push_back(Format("select begin mask 2 %7.3f ms/step  %.0f selected/step", selectMs / steps, (double)selected / steps));
+    output.push_back(std::string("event order ") + (hashes[0] == hashes[1] ? "serial and pooled identical" : "serial and pooled DIFFER"));
+
+    // The same grid over level geometry, which reaches the stream through the static index
+    double levelMs[2] = {};
+    size_t staticCount = 0, staticEvents = 0;
+    uint64_t levelHashes[2] = { 14695981039346656037ull, 14695981039346656037ull };
+    for (int mode = 0; mode < 2; ++mode) // serial, pooled
+    {
+        World world;
+        world.broadPhase.enabled = true;
+        world.contacts.enabled = true;
+        world.threadPool = mode == 0 ? nullptr : &ThreadPool::Shared();
+        BuildContactGrid(world, n);
+        staticCount = BuildContactLevel(world, n);
+        world.Update(1.0 / 60.0);
+        for (int step = 0; step < steps; ++step)
+        {
+            auto start = std::chrono::steady_clock::now();
+            world.Update(1.0 / 60.0);
+            levelMs[mode] += ElapsedMs(start);
+            levelHashes[mode] = levelHashes[mode] * 31 + EventHash(world.contacts);
+            if (mode == 1)
+                for (int phase = 0; phase < 3; ++phase)
+                    for (const ContactEvent& event : world.contacts.Events((ContactPhase)phase))
+                        staticEvents += (event.indexB & ContactEvent::StaticBit) != 0;
+        }
+    }
+    output.push_back(Format("with %zu static   %8.3f ms/step serial, %.3f pooled, %.0f static events/step, %s", staticCount,
+        levelMs[0] / steps, levelMs[1] / steps, (double)staticEvents / steps,
+        levelHashes[0] == levelHashes[1] ? "serial and pooled identical" : "serial and pooled DIFFER"));
+}
+
+// Drawing every body shape by shape against the snapshot's per-kind batches, into a software renderer.
+static void BenchmarkShapes(size_t n, std::vector<std::string>& output)
+{
+    World world;
+    std::vector<Vector<Real>> corners(4, Vector<Real>(2));
+    corners[0].set(-3, -2); corners[1].set(3, -2); corners[2].set(3, 2); corners[3].set(-3, 2);
+    for (size_t i = 0; i < n; ++i)
+    {
+        double x = 8.0 * (i % 100), y = 8.0 * (i / 100 % 100);
+        if (i % 2) world.AddBody(x, y, 0, 0, 0, 0, new Circle(3.0f));
+        else world.AddBody(x, y, 0, 0, 0, 0, new ConvexPolygon(corners));
+    }
+
+    SDL_Surface* surface = SDL_CreateSurface(800, 800, SDL_PIXELFORMAT_RGBA32);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!renderer) {
+        output.push_back("shapes: cannot create a software renderer");
+        SDL_DestroySurface(surface);
+        return;
+    }
+    const int frames = 5;
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame)
+        world.Render(renderer);
+    double perShapeMs = ElapsedMs(start) / frames;
+
+    // Snapshot path: the table is built once, records every publish
+    start = std::chrono::steady_clock::now();
+    auto table = std::make_shared<ShapeTable>();
+    BodyRecords ids;
+    for (const auto& bodyPtr : world.bodies)
+        table->Append(bodyPtr->compound, 0, 0, 0, ids);
+    double tableMs = ElapsedMs(start);
+    RenderSnapshot snapshot;
+    snapshot.shapes = table;
+    double recordMs = 0.0, batchMs = 0.0;
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        start = std::chrono::steady_clock::now();
+        for (std::vector<BodySnapshot>& records : snapshot.bodies)
+            records.clear();
+        for (const auto& bodyPtr : world.bodies)
+            for (size_t i = 0; i < bodyPtr->compound.Count(); ++i)
+            {
+                std::vector<BodySnapshot>& records = snapshot.bodies[(size_t)bodyPtr->compound.kinds[i]];
+                records.push_back({ (float)bodyPtr->position.x, (float)bodyPtr->position.y, 0.0f, (uint32_t)records.size() });
+            }
+        recordMs += ElapsedMs(start);
+        start = std::chrono::steady_clock::now();
+        snapshot.Render(renderer);
+        batchMs += ElapsedMs(start);
+    }
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroySurface(surface);
+
+    output.push_back(Format("shapes: %zu bodies (%zu circles, %zu boxes), %d frames", n,
+        snapshot.bodies[(size_t)ShapeKind::Circle].size(), snapshot.bodies[(size_t)ShapeKind::Polygon].size(), frames));
+    output.push_back(Format("shape by shape    %8.3f ms/frame", perShapeMs));
+    output.push_back(Format("per-kind batches  %8.3f ms/frame  speedup %.1fx", batchMs / frames, perShapeMs / std::max(batchMs / frames, 1e-6)));
+    output.push_back(Format("records %.3f ms/publish, table %.3f ms once", recordMs / frames, tableMs));
+}
+
+// Stiff 32 x 32 lattices falling onto a floor, enough of them for the requested number of springs.
+static void BuildSoftLattices(SoftBodySystem& soft, size_t springs)
+{
+    soft.gravityY = 200.0f;
+    soft.floorY = 1000.0f;
+    for (int i = 0; soft.SpringCount() < springs; ++i)
+        soft.AddLattice(140.0f * (i % 8), 860.0f - 140.0f * (i / 8), 32, 32, 4.0f, 1.0f, 20000.0f, 5.0f, false);
+}
+
+// Largest relative stretch or compression of any spring.
+static double MaxStrain(const SoftBodySystem& soft)
+{
+    double strain = 0.0;
+    for (size_t s = 0; s < soft.SpringCount(); ++s)
+    {
+        uint32_t a = soft.springA[s], b = soft.springB[s];
+        double length = std::hypot(soft.posX[b] - soft.posX[a], soft.posY[b] - soft.posY[a]);
+        double relative = std::abs(length / soft.restLength[s] - 1.0);
+        strain = std::isfinite(relative) ? std::max(strain, relative) : INFINITY;
+    }
+    return strain;
+}
+
+// Spring throughput of the soft body system: scalar against SIMD, serial against pooled, and the
+// single-step integration the substeps are there to avoid.
+static void BenchmarkSoft(size_t n, std::vector<std::string>& output)
+{
+    const int steps = 60;
+    const char* names[3] = { "scalar serial", "SIMD serial", "SIMD pooled" };
+    double stepMs[3] = {}, strain = 0.0, difference = 0.0;
+    std::vector<float> positions[3];
+    int substeps = 0;
+    size_t springs = 0, points = 0;
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        SoftBodySystem soft;
+        BuildSoftLattices(soft, n);
+        soft.vectorized = mode > 0;
+        ThreadPool* pool = mode == 2 ? &ThreadPool::Shared() : nullptr;
+        soft.Update(1.0f / 120.0f, pool); // warm-up, builds the incidence lists
+        auto start = std::chrono::steady_clock::now();
+        for (int step = 0; step < steps; ++step)
+            soft.Update(1.0f / 120.0f, pool);
+        stepMs[mode] = ElapsedMs(start) / steps;
+        substeps = soft.GetSubsteps();
+        springs = soft.SpringCount();
+        points = soft.PointCount();
+        positions[mode] = soft.posX;
+        positions[mode].insert(positions[mode].end(), soft.posY.begin(), soft.posY.end());
+        if (mode == 2) strain = MaxStrain(soft);
+    }
+    for (size_t i = 0; i < positions[0].size(); ++i)
+        difference = std::max(difference, (double)std::abs(positions[0][i] - positions[1][i]));
+
+    SoftBodySystem single;
+    BuildSoftLattices(single, n);
+    single.maxSubsteps = 1;
+    for (int step = 0; step <= steps; ++step)
+        single.Update(1.0f / 120.0f, &ThreadPool::Shared());
+
+    output.push_back(Format("soft: %zu springs, %zu points, %d substeps/step, %d steps, %zu threads", springs, points,
+        substeps, steps, ThreadPool::Shared().GetThreadCount()));
+    for (int mode = 0; mode < 3; ++mode)
+        output.push_back(Format("%-14s %8.3f ms/step  %7.1f M springs/s", names[mode], stepMs[mode],
+            springs * substeps / (stepMs[mode] * 1000.0)));
+    output.push_back(Format("max strain %.4f with substeps, %.4g in a single step per frame", strain, MaxStrain(single)));
+    output.push_back(Format("scalar vs SIMD max position difference %.3g, pooled %s", difference,
+        positions[1] == positions[2] ? "identical to serial" : "DIFFERS from serial"));
+}
+
+// Dam break of n fluid particles with a row of floating circles, in grid order or read through the index.
+static void BenchmarkFluid(size_t n, std::vector<std::string>& output)
+{
+    const int steps = 20;
+    const char* names[3] = { "grid order, serial", "grid order, pooled", "index, pooled" };
+    double stepMs[3] = {}, height = 0.0, speed = 0.0, restDepth = 0.0, compression = 0.0, maxCompression = 0.0;
+    int substeps = 0;
+    size_t bodyCount = 0;
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        World world;
+        world.threadPool = mode == 0 ? nullptr : &ThreadPool::Shared();
+        FluidSystem& fluid = world.fluid;
+        int columns = (int)std::sqrt((double)n), rows = (int)((n + columns - 1) / columns);
+        float spacing = fluid.smoothingRadius * 0.5f;
+        fluid.maxX = 2.0f * columns * spacing;
+        fluid.maxY = 1.5f * rows * spacing;
+        fluid.gravityY = 200.0f;
+        fluid.reorder = mode < 2;
+        fluid.AddBlock(spacing, fluid.maxY - rows * spacing, columns, rows);
+
+        // Spawn order no longer says anything about position once the fluid has mixed
+        std::mt19937 rng(6);
+        std::vector<size_t> shuffled(fluid.Count());
+        for (size_t i = 0; i < shuffled.size(); ++i) shuffled[i] = i;
+        std::shuffle(shuffled.begin(), shuffled.end(), rng);
+        for (std::vector<float>* values : { &fluid.posX, &fluid.posY })
+        {
+            std::vector<float> copy = *values;
+            for (size_t i = 0; i < shuffled.size(); ++i) (*values)[i] = copy[shuffled[i]];
+        }
+
+        for (float x = 40.0f; x + 40.0f < columns * spacing; x += 120.0f)
+        {
+            world.AddBody(x, fluid.maxY - rows * spacing - 20.0f, 0, 0, 0, 0, new Circle(20.0f), fluid.density * 0.5f);
+            world.bodies.back()->gravity.set(0, 200);
+        }
+        world.Update(1.0 / 120.0); // warm-up, sizes the grid and the per-slot arrays
+        auto start = std::chrono::steady_clock::now();
+        for (int step = 0; step < steps; ++step)
+            world.Update(1.0 / 120.0);
+        stepMs[mode] = ElapsedMs(start) / steps;
+        substeps = fluid.GetSubsteps();
+        if (mode != 1) continue;
+
+        bodyCount = world.bodies.size();
+        restDepth = (double)fluid.Count() * spacing * spacing / (fluid.maxX - fluid.minX);
+        for (const auto& bodyPtr : world.bodies)
+        {
+            height += (fluid.maxY - (double)bodyPtr->position.y) / bodyCount;
+            speed += std::hypot((double)bodyPtr->velocity.x, (double)bodyPtr->velocity.y) / bodyCount;
+        }
+        for (float density : fluid.GetDensities())
+        {
+            double relative = density / fluid.GetRestDensity() - 1.0;
+            compression += relative;
+            maxCompression = std::max(maxCompression, relative);
+        }
+        compression /= std::max<size_t>(fluid.Count(), 1);
+    }
+    output.push_back(Format("fluid: %zu particles, %d substeps/step, %d steps, %zu threads", n, substeps, steps,
+        ThreadPool::Shared().GetThreadCount()));
+    for (int mode = 0; mode < 3; ++mode)
+        output.push_back(Format("%-20s %8.3f ms/step  %6.2f M particle-substeps/s", names[mode], stepMs[mode],
+            n * substeps / (stepMs[mode] * 1000.0)));
+    output.push_back(Format("reordering speedup %.2fx; density above rest: mean %.1f%%, max %.1f%%",
+        stepMs[2] / std::max(stepMs[1], 1e-6), 100.0 * compression, 100.0 * maxCompression));
+    output.push_back(Format("%zu circles at half the fluid density: center %.0f above the floor (fluid %.0f deep at rest), %.0f/s",
+        bodyCount, height, restDepth, speed));
+}
+
+// Steady-state heap allocations of World::Update, one world per feature and one with everything.
+// In strict mode any allocation after the warm-up fails the benchmark.
+static bool BenchmarkAllocations(size_t n, std::vector<std::string>& output)
+{
+    if (!AllocationTracker::Enabled) {
+        output.push_back("allocations: tracking is off in this build (define PHYSICS_TRACK_ALLOCATIONS)");
+        return !AllocationTracker::IsStrict();
+    }
+    const int warmup = 600, steps = 600;
+    const char* names[] = { "bodies", "contacts", "joints", "gravity", "particles", "substeps", "scenarios", "soft", "fluid", "everything" };
+    const int featureCount = sizeof(names) / sizeof(names[0]);
+    bool clean = true;
+    output.push_back(Format("allocations: %zu bodies, %d warm-up steps, %d measured steps", n, warmup, steps));
+    for (int feature = 0; feature < featureCount; ++feature)
+    {
+        bool all = feature == featureCount - 1;
+        World world;
+        BuildContactGrid(world, n);
+        std::vector<Vector<Real>> corners(4, Vector<Real>(2));
+        corners[0].set(-1, -1); corners[1].set(1, -1); corners[2].set(1, 1); corners[3].set(-1, 1);
+        for (size_t i = 0; i < n / 10; ++i)
+            world.AddBody(5.0 * i, -20.0, 0, 0, 0, 0, new ConvexPolygon(corners));
+        if (all || feature == 1) { world.broadPhase.enabled = true; world.contacts.enabled = true; }
+        if (all || feature == 2) BuildChain(world, 200);
+        if (all || feature == 3) world.mutualGravity.enabled = true;
+        if (all || feature == 4) {
+            ParticleEmitter emitter;
+            emitter.x = 0; emitter.y = 0; emitter.rate = 20000;
+            emitter.speed = 50; emitter.lifetime = 1;
+            world.particles.emitters.push_back(emitter);
+        }
+        if (all || feature == 5) world.substepper.enabled = true;
+        if (all || feature == 7)
+            world.softBodies.AddLattice(0.0f, 0.0f, 32, 32, 4.0f, 1.0f, 2000.0f, 2.0f, true);
+        if (all || feature == 8) {
+            world.fluid.gravityY = 200.0f;
+            world.fluid.AddBlock(100.0f, 500.0f, 60, 40);
+        }
+        uint64_t ticks = 0;
+        if (all || feature == 6)
+            for (uint64_t period = 1; period <= 64; ++period)
+                world.scenarios.Start(TickScenario(period, ticks));
+
+        for (int step = 0; step < warmup; ++step)
+            world.Update(1.0 / 120.0);
+        AllocationCounters before = AllocationTracker::Read();
+        auto start = std::chrono::steady_clock::now();
+        for (int step = 0; step < steps; ++step)
+            world.Update(1.0 / 120.0);
+        double ms = ElapsedMs(start) / steps;
+        AllocationCounters during = AllocationTracker::Read().Since(before);
+        world.scenarios.StopAll();
+
+        uint64_t count = during.count[(size_t)AllocationSubsystem::World];
+        uint64_t bytes = during.bytes[(size_t)AllocationSubsystem::World];
+        clean = clean && count == 0;
+        output.push_back(Format("%-10s %8.3f ms/step  %10.2f allocations/step  %12.1f bytes/step", names[feature], ms,
+            (double)count / steps, (double)bytes / steps));
+    }
+    if (AllocationTracker::IsStrict())
+        output.push_back(clean ? "strict: World::Update did not allocate in steady state" : "strict: FAILED, World::Update allocated in steady state");
+    return clean || !AllocationTracker::IsStrict();
+}
+
+bool RunBenchmark(const std::string& name, size_t count, std::vector<std::string>& output)
+{
+    if (name == "gravity") {
+        BenchmarkGravity(count ? count : 5000, output);
+    } else if (name == "particles") {
+        BenchmarkParticles(count ? count : 1000000, output);
+    } else if (name == "joints") {
+        BenchmarkJoints(count ? count : 4000, output);
+    } else if (name == "precision") {
+        BenchmarkPrecision(count ? count : 2000, output);
+    } else if (name == "pile") {
+        BenchmarkPile(count ? count : 20000, output);
+    } else if (name == "static") {
+        BenchmarkStatic(count ? count : 50000, output);
+    } else if (name == "scene") {
+        BenchmarkScene(count ? count : 200000, output);
+    } else if (name == "integrators") {
+        BenchmarkIntegrators(count ? count : 100000, output);
+    } else if (name == "substeps") {
+        BenchmarkSubsteps(count ? count : 20000, output);
+    } else if (name == "layout") {
+        BenchmarkLayout(count ? count : 200000, output);
+    } else if (name == "fixed") {
+        return BenchmarkFixed(count ? count : 1000000, output);
+    } else if (name == "scenarios") {
+        BenchmarkScenarios(count ? count : 10000, output);
+    } else if (name == "contacts") {
+        BenchmarkContacts(count ? count : 50000, output);
+    } else if (name == "shapes") {
+        BenchmarkShapes(count ? count : 20000, output);
+    } else if (name == "soft") {
+        BenchmarkSoft(count ? count : 100000, output);
+    } else if (name == "fluid") {
+        BenchmarkFluid(count ? count : 100000, output);
+    } else if (name == "allocations") {
+        return BenchmarkAllocations(count ? count : 1000, output);
+    } else if (name == "list") {
+        output.push_back("Benchmarks: gravity, particles, joints, precision, pile, static, scene, integrators, substeps, layout, fixed, scenarios, contacts, shapes, soft, fluid, allocations");
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/**
+ * Headless benchmarks. They can be run from the command line
+ * (ProjectCamera --bench <name> [count]) or from the Debugger (bench <name> [count]).
+ *
+ * @param name Benchmark name ("list" prints the available ones)
+ * @param count Problem size, 0 for the benchmark's default
+ * @param output Receives the report lines
+ * @return False if the name is unknown, or if a check failed (strict allocations, the fixed-point
+ *         state hash); the report says so
+ */
+bool RunBenchmark(const std::string& name, size_t count, std::vector<std::string>& output);
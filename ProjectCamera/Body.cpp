@@ -1,70 +1,132 @@
 #include "Body.h"
 #include <SDL3/SDL.h>
+#include "Circle.h"
+#include "ConvexPolygon.h"
 #include <iostream> //debugging
 
 /**
  * @brief Construct a new Body object with initial state.
- * @param pos Initial position vector
- * @param vel Initial velocity vector
+ * @param x,y Initial position
+ * @param vx,vy Initial velocity
  * @param m Mass of the body
- * @param force Initial force vector
  */
-Body::Body(const Vector<double>& pos,
-    const Vector<double>& vel,
-    double m, const Vector<double>& force)
-    : position(pos)
-    , velocity(vel)
-    , acceleration(0)   // 0-dim vector
-    , gravity(2)        // 2-dim vector
-    , angular_acc(2)    // 2-dim vector`
-    , angular_vel(2)    // 2-dim vector
-    , rotation(2)       // 2-dim vector
-    , mass(m)
-    , inertia(1.0)
-    , coeff_friction(0.5)
-    , coeff_restitution(0.5)
-    , force(force)
-    , torque(0.0)
+Body::Body(Real x, Real y, Real vx, Real vy, Real m)
 {
-    // All physical properties initialized
+    position.set(x, y);
+    velocity.set(vx, vy);
+    mass = m;
+}
+
+// Room in front of every body for the resource it came from, keeping the body max-aligned.
+static constexpr std::size_t AllocationHeader = alignof(std::max_align_t);
+
+void* Body::operator new(std::size_t size, std::pmr::memory_resource* resource)
+{
+    void* block = resource->allocate(AllocationHeader + size, alignof(std::max_align_t));
+    *static_cast<std::pmr::memory_resource**>(block) = resource;
+    return static_cast<char*>(block) + AllocationHeader;
+}
+
+void* Body::operator new(std::size_t size)
+{
+    return operator new(size, std::pmr::new_delete_resource());
+}
+
+void Body::operator delete(void* memory, std::size_t size)
+{
+    if (!memory) return;
+    void* block = static_cast<char*>(memory) - AllocationHeader;
+    std::pmr::memory_resource* resource = *static_cast<std::pmr::memory_resource**>(block);
+    resource->deallocate(block, AllocationHeader + size, alignof(std::max_align_t));
+}
+
+void Body::operator delete(void* memory, std::pmr::memory_resource* resource)
+{
+    // Nothing derives from Body, so the new-expression that threw asked for sizeof(Body)
+    resource->deallocate(static_cast<char*>(memory) - AllocationHeader, AllocationHeader + sizeof(Body),
+        alignof(std::max_align_t));
+}
+
+/**
+ * @brief Attach a shape and recompute mass, inertia and center of mass from all shapes.
+ * @param shape Shape to attach
+ * @param density Mass per unit area of the shape
+ */
+void Body::AttachShape(const Shape& shape, Real density)
+{
+    compound.Add(shape, density);
+    if (compound.mass > 0)
+    {
+        mass = compound.mass;
+        inertia = compound.originInertia > 0 ? compound.originInertia : inertia; // Bodies turn about position, not the centroid
+    }
+}
+
+/**
+ * @brief Override the mass, scaling inertia so the mass distribution stays the same.
+ * @param newMass New mass
+ */
+void Body::SetMass(Real newMass)
+{
+    if (mass > 0)
+        inertia *= newMass / mass;
+    mass = newMass;
 }
 
 /**
  * @brief Update the body's physics state for the given time step.
  *
- * Updates acceleration, velocity, position, angular acceleration,
- * angular velocity, and rotation based on current forces and torque.
+ * Updates velocity, position, angular velocity and rotation based on
+ * current forces and torque.
+ * @param deltaTime Time step for the update
+ */
+void Body::Update(Real deltaTime)
+{
+    IntegrateVelocity(deltaTime);
+    IntegratePosition(deltaTime);
+}
+
+/**
+ * @brief Apply accumulated force and torque to the linear and angular velocity.
+ *
+ * Split from IntegratePosition so that constraint impulses can be applied in between.
  * @param deltaTime Time step for the update
  */
-void Body::Update(double deltaTime)
+void Body::IntegrateVelocity(Real deltaTime)
 {
-    // Linear motion update
-    // drag_force = -liniar_drag * velocity
-    Vector<double> drag_force = liniar_drag * (-1.0);
-    drag_force = drag_force * velocity.x; // Only x component, or use dotProduct if needed
-    acceleration = (force + drag_force) / mass + gravity;
-    velocity = velocity + acceleration * deltaTime;
-    position = position + velocity * deltaTime;
-    //velocity = velocity + impulse / mass;
-    impulse = Vector<double>(0); // clear after application
+    // Linear motion: drag_force = -liniar_drag * velocity, per component
+    velocity.x += ((force.x - liniar_drag.x * velocity.x) / mass + gravity.x) * deltaTime;
+    velocity.y += ((force.y - liniar_drag.y * velocity.y) / mass + gravity.y) * deltaTime;
+
+    // Angular motion: drag_torque = -angular_drag * angular_vel
+    angular_vel += (torque - angular_drag * angular_vel) / inertia * deltaTime;
+}
 
-    // Angular motion update
-    // drag_torque = -angular_drag * angular_vel
-    Vector<double> drag_torque = angular_drag * (-1.0);
-    drag_torque = drag_torque * angular_vel.x; // Only x component, or use dotProduct if needed
-    angular_acc = (torque + drag_torque.x) / inertia; // Use x component for scalar torque
-    angular_vel = angular_vel + angular_acc * deltaTime;
-    rotation = rotation + angular_vel * deltaTime;
+/**
+ * @brief Move and rotate the body with its current velocities.
+ * @param deltaTime Time step for the update
+ */
+void Body::IntegratePosition(Real deltaTime)
+{
+    position.x += velocity.x * deltaTime;
+    position.y += velocity.y * deltaTime;
+    rotation += angular_vel * deltaTime;
 }
 
 /**
  * @brief Render the body using the given SDL renderer.
  *
- * Calls Render on all attached shapes, passing the current position.
+ * Walks the flattened compound shape, drawing each shape at the current position.
  * @param renderer SDL renderer to use
  */
 void Body::Render(SDL_Renderer* renderer)
 {
-    for (auto& shapePtr : shapes)
-        shapePtr->Render(position, renderer);
+    for (size_t i = 0; i < compound.Count(); ++i)
+    {
+        if (compound.kinds[i] == ShapeKind::Circle)
+            Circle::Draw(renderer, position.x, position.y, compound.radius[i]);
+        else
+            ConvexPolygon::Draw(renderer, position.x, position.y, compound.vertexX.data() + compound.firstVertex[i],
+                compound.vertexY.data() + compound.firstVertex[i], compound.vertexCount[i]);
+    }
 }
@@ -1,60 +1,151 @@
 #pragma once
-#include <list>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <SDL3/SDL.h>
 #include "Vector.h"
 #include "Shape.h"
+#include "CompoundShape.h"
+#include "globals.h"
 #pragma warning(disable : 4244)
 
+/**
+ * @enum BodyType
+ * @brief How a body takes part in the simulation step.
+ */
+enum class BodyType : uint8_t
+{
+    Dynamic,   ///< Moved by forces, joints and integration
+    Kinematic, ///< Moved only by its scripted velocity; infinite mass to everything else
+    Static     ///< Never moves; kept out of World::bodies and all per-step passes
+};
+
+/**
+ * @struct BodyMotion
+ * @brief Hot part of a body: everything World::Update reads or writes for it every step.
+ *
+ * Kept small and at the front of Body so that a step touches a few cache lines per body.
+ * Angles are scalars in 2D.
+ */
+struct BodyMotion
+{
+    Vec2 position;          ///< Position
+    Vec2 velocity;          ///< Velocity
+    Vec2 force;             ///< Force accumulated for the next step, then cleared
+    Vec2 gravity;           ///< Gravity acceleration
+    Vec2 liniar_drag;       ///< Linear drag coefficient per axis
+    Real rotation = 0;      ///< Rotation angle (radians)
+    Real angular_vel = 0;   ///< Angular velocity (radians per second)
+    Real torque = 0;        ///< Torque accumulated for the next step, then cleared
+    Real angular_drag = 0;  ///< Angular drag coefficient
+    Real mass = 0;          ///< Mass of the body
+    Real inertia = 1;       ///< Moment of inertia
+    BodyType type = BodyType::Dynamic; ///< Fixed when the body is added to a world
+};
+
 /**
  * @class Body
  * @brief Represents a physical object in the simulation.
  *
- * Stores position, velocity, acceleration, mass, force, and shape(s).
- * Handles physics updates and rendering for the object.
+ * The hot BodyMotion record comes first; material, shapes and the flattened compound shape
+ * follow and are only touched when shapes change, for queries and for rendering.
  */
-class Body
+class Body : public BodyMotion
 {
 public:
-    std::list<std::unique_ptr<Shape>> shapes; ///< List of shapes attached to this body
-
     /**
      * @brief Construct a new Body object.
-     * @param pos Initial position vector
-     * @param vel Initial velocity vector
+     * @param x,y Initial position
+     * @param vx,vy Initial velocity
      * @param m Mass of the body
-     * @param force Initial force vector
      */
-    Body(const Vector<double>& pos,
-        const Vector<double>& vel,
-        double m, const Vector<double>& force );
+    Body(Real x, Real y, Real vx, Real vy, Real m);
 
-    Vector<double> position;      ///< Position vector
-    Vector<double> velocity;      ///< Velocity vector
-    Vector<double> acceleration;  ///< Acceleration vector
-    Vector<double> gravity;       ///< Gravity vector
-    Vector<double> angular_acc;   ///< Angular acceleration vector
-    Vector<double> angular_vel;   ///< Angular velocity vector
-    Vector<double> rotation;      ///< Rotation vector
+    /**
+     * @brief Allocate a body from a memory resource, typically its world's arena.
+     *
+     * The resource is remembered in a small header in front of the body, so a plain
+     * delete (as done by std::unique_ptr<Body>) returns the memory to the same place.
+     * @param size Size requested by the new-expression
+     * @param resource Resource to allocate from
+     */
+    static void* operator new(std::size_t size, std::pmr::memory_resource* resource);
+    /**
+     * @brief Allocate a body from the default (global heap) resource.
+     * @param size Size requested by the new-expression
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * @brief Return a body's memory to the resource it was allocated from.
+     * @param memory Pointer returned by one of the operator new overloads
+     * @param size Size of the body
+     */
+    static void operator delete(void* memory, std::size_t size);
+    /**
+     * @brief Placement form used only if the constructor throws; returns the memory to resource.
+     * @param memory Pointer returned by the matching operator new
+     * @param resource Resource the memory came from
+     */
+    static void operator delete(void* memory, std::pmr::memory_resource* resource);
 
-    double mass;                  ///< Mass of the body
-    double inertia;               ///< Moment of inertia
-    double coeff_friction;        ///< Coefficient of friction
-    double coeff_restitution;     ///< Coefficient of restitution
+    // Cold: material and shapes
+    Real coeff_friction = 0.5;     ///< Coefficient of friction
+    Real coeff_restitution = 0.5;  ///< Coefficient of restitution
+    uint32_t category = 1;         ///< Category bits, matched against contact event masks
+    CompoundShape compound; ///< Attached shapes as flat per-kind values, with combined mass properties and center of mass
 
-    Vector<double> force;         ///< Force vector
-    double torque;                ///< Torque value
-	Vector<double> normal;       ///< Normal vector for collision response
-	Vector<double> impulse;       ///< Impulse vector for collision response
-	Vector<double> liniar_drag; ///< Linear drag vector
-	Vector<double> angular_drag; ///< Angular drag vector
-	Vector<double> center_of_mass; ///< Center of mass vector
+    /**
+     * @brief Attach a shape and recompute mass, inertia and center of mass from all shapes.
+     *
+     * Bodies whose shapes have no area keep their current mass and inertia.
+     * The shape is copied into the compound; the caller keeps ownership of the object.
+     * @param shape Shape to attach
+     * @param density Mass per unit area of the shape
+     */
+    void AttachShape(const Shape& shape, Real density);
+
+    /**
+     * @brief Override the mass, scaling inertia so the mass distribution stays the same.
+     * @param newMass New mass (must be positive)
+     */
+    void SetMass(Real newMass);
+
+    /**
+     * @brief True if forces and constraint impulses move this body.
+     */
+    bool IsDynamic() const { return type == BodyType::Dynamic; }
+
+    /**
+     * @brief Inverse mass as seen by constraints: zero for kinematic and static bodies.
+     */
+    Real InverseMass() const { return IsDynamic() && mass > 0 ? 1 / mass : 0; }
 
+    /**
+     * @brief Inverse moment of inertia as seen by constraints: zero for kinematic and static bodies.
+     */
+    Real InverseInertia() const { return IsDynamic() && inertia > 0 ? 1 / inertia : 0; }
 
     /**
      * @brief Update the body's physics state for the given time step.
+     *
+     * Same as IntegrateVelocity followed by IntegratePosition. World::Update advances its
+     * bodies in batches with its own integrator instead.
+     * @param deltaTime Time step for the update
+     */
+    void Update(Real deltaTime);
+
+    /**
+     * @brief Apply accumulated force and torque to the linear and angular velocity.
+     * @param deltaTime Time step for the update
+     */
+    void IntegrateVelocity(Real deltaTime);
+
+    /**
+     * @brief Move and rotate the body with its current velocities.
      * @param deltaTime Time step for the update
      */
-    void Update(double deltaTime);
+    void IntegratePosition(Real deltaTime);
 
     /**
      * @brief Render the body using the given SDL renderer.
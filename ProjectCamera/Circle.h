@@ -6,41 +6,50 @@
 #include "MemMaster.h"
 /**
  * @class Circle
- * @brief Represents a drawable circle shape for the physics renderer.
+ * @brief Describes a circle around the body origin for Body::AttachShape.
  *
- * Inherits from Shape and implements the Render method to draw a circle
- * at a given position using the SDL renderer.
+ * Bodies keep only the radius (in CompoundShape); Draw renders a circle from it.
  */
 class Circle : public Shape, virtual MemMaster
 {
 public:
-    float radius; ///< The radius of the circle
+    float radius; ///< The radius of the circle (fixed after construction)
 
     /**
      * @brief Construct a new Circle object with the given radius.
+     *
+     * Area, inertia and bounds are computed here once.
      * @param r The radius of the circle
      */
-    Circle(float r) : radius(r) {}
+    Circle(float r) : Shape(ShapeKind::Circle), radius(r)
+    {
+        area = (Real)PI * r * r;
+        inertia = area * r * r / 2; // m r^2 / 2 at unit density
+        boundingRadius = r;
+        minX = minY = -r;
+        maxX = maxY = r;
+    }
 
     /**
-     * @brief Render the circle at the given position using the SDL renderer.
-     * @param position The center position of the circle
+     * @brief Draw a circle outline; shared with the flattened compound-shape render path.
      * @param renderer The SDL renderer to use for drawing
+     * @param x Center X
+     * @param y Center Y
+     * @param radius Radius of the circle
      */
-    void Render(const Vector<double>& position, SDL_Renderer* renderer) override
+    static void Draw(SDL_Renderer* renderer, Real x, Real y, Real radius)
     {
         SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // Set color to white
-        int cx = static_cast<int>(position.x); // Center x
-        int cy = static_cast<int>(position.y); // Center y
-        int r = static_cast<int>(radius);      // Radius as int
-        const int segments = 360;              // Number of segments for the circle
+        int cx = static_cast<int>(x);           // Center x
+        int cy = static_cast<int>(y);           // Center y
+        int r = static_cast<int>(radius);       // Radius as int
+        const int segments = 360;               // Number of segments for the circle
         for (int i = 0; i < segments; i++)
         {
             double theta = 2.0 * PI * i / segments; // Angle for this segment
-            int x = static_cast<int>(cx + r * cos(theta)); // X coordinate
-            int y = static_cast<int>(cy + r * sin(theta)); // Y coordinate
-            SDL_RenderPoint(renderer, x, y); // Draw the point
+            int px = static_cast<int>(cx + r * cos(theta)); // X coordinate
+            int py = static_cast<int>(cy + r * sin(theta)); // Y coordinate
+            SDL_RenderPoint(renderer, px, py); // Draw the point
         }
     }
 };
-
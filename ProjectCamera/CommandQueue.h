@@ -0,0 +1,52 @@
+#pragma once
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+class World;
+
+/**
+ * @class CommandQueue
+ * @brief Multi-producer queue of world mutations applied by the simulation thread.
+ *
+ * UI code never touches the World directly while the simulation is running. Instead it
+ * pushes commands here and the simulation thread applies all of them at the next step
+ * boundary. The lock is only held long enough to swap two vectors.
+ */
+class CommandQueue
+{
+public:
+    using Command = std::function<void(World&)>;
+
+    /**
+     * @brief Queue a command to run on the simulation thread.
+     * @param command Callable receiving the world to mutate
+     */
+    void Push(Command command)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::move(command));
+    }
+
+    /**
+     * @brief Run every queued command against the world (simulation thread only).
+     * @param world World to apply the commands to
+     */
+    void Apply(World& world)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (pending.empty()) return;
+            std::swap(pending, applying);
+        }
+        for (auto& command : applying)
+            command(world);
+        applying.clear(); // keeps capacity for the next batch
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<Command> pending;  ///< Commands pushed since the last step
+    std::vector<Command> applying; ///< Batch currently being applied
+};
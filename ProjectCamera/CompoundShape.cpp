@@ -0,0 +1,69 @@
+#include "CompoundShape.h"
+#include <algorithm>
+#include "Circle.h"
+#include "ConvexPolygon.h"
+
+/**
+ * @brief Append a shape and fold it into the combined mass properties and bounds.
+ *
+ * Inertia is accumulated about the body origin (parallel axis theorem per shape), which is
+ * the axis bodies rotate about, and also shifted to the combined center of mass; adding
+ * shapes one at a time is exact.
+ * @param shape Shape to flatten
+ * @param shapeDensity Mass per unit area of the shape
+ */
+void CompoundShape::Add(const Shape& shape, Real shapeDensity)
+{
+    kinds.push_back(shape.Kind());
+    density.push_back(shapeDensity);
+    firstVertex.push_back((uint32_t)vertexX.size());
+    if (shape.Kind() == ShapeKind::Circle)
+    {
+        radius.push_back(static_cast<const Circle&>(shape).radius);
+        vertexCount.push_back(0);
+    }
+    else
+    {
+        const auto& polygon = static_cast<const ConvexPolygon&>(shape);
+        radius.push_back(0);
+        vertexCount.push_back((uint32_t)polygon.vertices.size());
+        for (const auto& vertex : polygon.vertices)
+        {
+            vertexX.push_back(vertex.x);
+            vertexY.push_back(vertex.y);
+        }
+    }
+
+    // Bounds
+    if (Count() == 1)
+    {
+        minX = shape.MinX(); minY = shape.MinY();
+        maxX = shape.MaxX(); maxY = shape.MaxY();
+    }
+    else
+    {
+        minX = std::min(minX, shape.MinX()); minY = std::min(minY, shape.MinY());
+        maxX = std::max(maxX, shape.MaxX()); maxY = std::max(maxY, shape.MaxY());
+    }
+    boundingRadius = std::max(boundingRadius, shape.BoundingRadius());
+
+    // Mass properties
+    Real shapeMass = shape.Area() * shapeDensity;
+    if (shapeMass <= 0) return;
+    Real cx = shape.CentroidX(), cy = shape.CentroidY();
+    Real momentX = centerX * mass + cx * shapeMass;
+    Real momentY = centerY * mass + cy * shapeMass;
+    originInertia += shape.Inertia() * shapeDensity + shapeMass * (cx * cx + cy * cy);
+    mass += shapeMass;
+    centerX = momentX / mass;
+    centerY = momentY / mass;
+    inertia = originInertia - mass * (centerX * centerX + centerY * centerY);
+}
+
+/**
+ * @brief Remove all shapes and reset the combined properties.
+ */
+void CompoundShape::Clear()
+{
+    *this = CompoundShape();
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Shape.h"
+#include "globals.h"
+
+/**
+ * @class CompoundShape
+ * @brief All shapes of one body flattened into contiguous arrays.
+ *
+ * Shapes are appended once when attached; their precomputed area, centroid and inertia
+ * are folded into the combined mass properties at that point, so nothing is recomputed
+ * per step. Collision and render loops switch on the kind array and read radii and
+ * polygon vertices from flat storage instead of calling through Shape pointers.
+ */
+class CompoundShape
+{
+public:
+    // Per shape
+    std::vector<ShapeKind> kinds;       ///< Kind of each shape
+    std::vector<Real> radius;           ///< Circle radius (0 for polygons)
+    std::vector<Real> density;          ///< Mass per unit area
+    std::vector<uint32_t> firstVertex;  ///< First vertex of a polygon in vertexX/vertexY
+    std::vector<uint32_t> vertexCount;  ///< Number of polygon vertices (0 for circles)
+
+    // Polygon vertices of all shapes, in body-local coordinates
+    std::vector<Real> vertexX, vertexY;
+
+    // Combined mass properties
+    Real mass = 0;                      ///< Total mass
+    Real centerX = 0, centerY = 0;      ///< Center of mass in body-local coordinates
+    Real inertia = 0;                   ///< Moment of inertia about the center of mass
+    Real originInertia = 0;             ///< Moment of inertia about the body origin, which bodies rotate about
+
+    // Combined bounds in body-local coordinates
+    Real boundingRadius = 0;            ///< Radius around the body origin containing every shape
+    Real minX = 0, minY = 0, maxX = 0, maxY = 0;
+
+    /**
+     * @brief Append a shape and fold it into the combined mass properties and bounds.
+     * @param shape Shape to flatten (must be a Circle or ConvexPolygon)
+     * @param shapeDensity Mass per unit area of the shape
+     */
+    void Add(const Shape& shape, Real shapeDensity);
+
+    /**
+     * @brief Number of shapes.
+     * @return Shape count
+     */
+    size_t Count() const { return kinds.size(); }
+
+    /**
+     * @brief Remove all shapes and reset the combined properties.
+     */
+    void Clear();
+};
@@ -0,0 +1,428 @@
+// ContactStream.cpp
+// Narrow phase over the broad-phase pairs, buffered per chunk and diffed into begin/persist/end events.
+#include "ContactStream.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+#include "SpatialIndex.h"
+#include "SweepAndPrune.h"
+#include "ThreadPool.h"
+
+/// One shape of a compound placed in the world: a polygon's vertices or a circle's radius, plus the body position
+struct PlacedShape
+{
+    const Real* x;    ///< Body-local vertex X (polygons)
+    const Real* y;    ///< Body-local vertex Y (polygons)
+    uint32_t count;   ///< Vertex count, 0 for a circle around the body origin
+    Real radius;      ///< Circle radius
+    Real offsetX, offsetY; ///< Body position
+};
+
+// Shape i of a body as placed in the world.
+static PlacedShape Place(const Body& body, size_t i)
+{
+    const CompoundShape& compound = body.compound;
+    uint32_t first = compound.firstVertex[i];
+    return { compound.vertexX.data() + first, compound.vertexY.data() + first, compound.vertexCount[i],
+        compound.radius[i], body.position.x, body.position.y };
+}
+
+// Interval covered by a shape along an axis.
+static void Project(const PlacedShape& shape, Real axisX, Real axisY, Real& low, Real& high)
+{
+    Real base = shape.offsetX * axisX + shape.offsetY * axisY;
+    if (shape.count == 0) {
+        low = base - shape.radius;
+        high = base + shape.radius;
+        return;
+    }
+    low = high = shape.x[0] * axisX + shape.y[0] * axisY;
+    for (uint32_t i = 1; i < shape.count; ++i)
+    {
+        Real d = shape.x[i] * axisX + shape.y[i] * axisY;
+        low = std::min(low, d);
+        high = std::max(high, d);
+    }
+    low += base;
+    high += base;
+}
+
+// Overlap of two shapes along an axis (made unit length here); keeps the smallest one. False if they are apart on it.
+static bool TestAxis(const PlacedShape& a, const PlacedShape& b, Real axisX, Real axisY,
+    Real& bestDepth, Real& bestX, Real& bestY)
+{
+    Real length = sqrt(axisX * axisX + axisY * axisY);
+    if (length <= 0) return true; // Degenerate edge: no information
+    axisX /= length;
+    axisY /= length;
+    Real lowA, highA, lowB, highB;
+    Project(a, axisX, axisY, lowA, highA);
+    Project(b, axisX, axisY, lowB, highB);
+    Real overlap = std::min(highA - lowB, highB - lowA);
+    if (overlap < 0) return false;
+    if (overlap < bestDepth) {
+        bestDepth = overlap;
+        bestX = axisX;
+        bestY = axisY;
+    }
+    return true;
+}
+
+// Test every edge normal of a polygon as a separating axis.
+static bool TestEdges(const PlacedShape& polygon, const PlacedShape& a, const PlacedShape& b,
+    Real& bestDepth, Real& bestX, Real& bestY)
+{
+    for (uint32_t i = 0; i < polygon.count; ++i)
+    {
+        uint32_t j = i + 1 == polygon.count ? 0 : i + 1;
+        if (!TestAxis(a, b, polygon.y[j] - polygon.y[i], polygon.x[i] - polygon.x[j], bestDepth, bestX, bestY))
+            return false;
+    }
+    return true;
+}
+
+// Center of a shape in world coordinates (vertex average for polygons).
+static void Center(const PlacedShape& shape, Real& x, Real& y)
+{
+    x = shape.offsetX;
+    y = shape.offsetY;
+    if (shape.count == 0) return;
+    Real sumX = 0, sumY = 0;
+    for (uint32_t i = 0; i < shape.count; ++i) {
+        sumX += shape.x[i];
+        sumY += shape.y[i];
+    }
+    x += sumX / (Real)(int)shape.count;
+    y += sumY / (Real)(int)shape.count;
+}
+
+/**
+ * @brief Separating-axis test between two placed shapes.
+ *
+ * Circles are tested directly; otherwise the axes are the polygon edge normals and, for a
+ * circle against a polygon, the direction from the nearest vertex to the circle center.
+ * Touching shapes count as a contact of depth 0, like touching boxes do in the broad phase.
+ * @return True if the shapes touch; the normal (A to B), point and depth are written to event
+ */
+static bool Collide(const PlacedShape& a, const PlacedShape& b, ContactEvent& event)
+{
+    if (a.count == 0 && b.count == 0) {
+        Real dx = b.offsetX - a.offsetX, dy = b.offsetY - a.offsetY, reach = a.radius + b.radius;
+        Real distanceSquared = dx * dx + dy * dy;
+        if (distanceSquared > reach * reach) return false;
+        Real distance = sqrt(distanceSquared);
+        event.normalX = distance > 0 ? dx / distance : Real(1);
+        event.normalY = distance > 0 ? dy / distance : Real(0);
+        event.depth = reach - distance;
+        event.pointX = b.offsetX - event.normalX * b.radius;
+        event.pointY = b.offsetY - event.normalY * b.radius;
+        return true;
+    }
+
+    Real depth = Real(1e9), axisX = 1, axisY = 0;
+    if (a.count > 0 && !TestEdges(a, a, b, depth, axisX, axisY)) return false;
+    if (b.count > 0 && !TestEdges(b, a, b, depth, axisX, axisY)) return false;
+    const PlacedShape* circle = a.count == 0 ? &a : b.count == 0 ? &b : nullptr;
+    if (circle) {
+        const PlacedShape& polygon = circle == &a ? b : a;
+        Real nearestX = 0, nearestY = 0, nearest = -1;
+        for (uint32_t i = 0; i < polygon.count; ++i)
+        {
+            Real dx = circle->offsetX - polygon.offsetX - polygon.x[i];
+            Real dy = circle->offsetY - polygon.offsetY - polygon.y[i];
+            Real d = dx * dx + dy * dy;
+            if (nearest < 0 || d < nearest) { nearest = d; nearestX = dx; nearestY = dy; }
+        }
+        if (!TestAxis(a, b, nearestX, nearestY, depth, axisX, axisY)) return false;
+    }
+
+    // Point the normal from A to B
+    Real centerAX, centerAY, centerBX, centerBY;
+    Center(a, centerAX, centerAY);
+    Center(b, centerBX, centerBY);
+    if ((centerBX - centerAX) * axisX + (centerBY - centerAY) * axisY < 0) {
+        axisX = -axisX;
+        axisY = -axisY;
+    }
+    event.normalX = axisX;
+    event.normalY = axisY;
+    event.depth = depth;
+
+    // Deepest point of B along the normal
+    if (b.count == 0) {
+        event.pointX = b.offsetX - axisX * b.radius;
+        event.pointY = b.offsetY - axisY * b.radius;
+    } else {
+        uint32_t deepest = 0;
+        Real lowest = b.x[0] * axisX + b.y[0] * axisY;
+        for (uint32_t i = 1; i < b.count; ++i)
+        {
+            Real d = b.x[i] * axisX + b.y[i] * axisY;
+            if (d < lowest) { lowest = d; deepest = i; }
+        }
+        event.pointX = b.offsetX + b.x[deepest];
+        event.pointY = b.offsetY + b.y[deepest];
+    }
+    return true;
+}
+
+void ContactStream::Update(const std::list<std::unique_ptr<Body>>& bodies, unsigned long long version,
+    const std::list<std::unique_ptr<Body>>& staticBodies, unsigned long long staticVersion,
+    const SpatialIndex& staticIndex, const SweepAndPrune& broadPhase, ThreadPool* pool)
+{
+    if (version != indexVersion || staticVersion != staticIndexVersion)
+        Reindex(bodies, version, staticBodies, staticVersion);
+
+    // What the pair tests read of each body, gathered once so a pair of circles never touches the bodies
+    size_t n = bodyByIndex.size();
+    bodyX.resize(n); bodyY.resize(n); circleRadius.resize(n); category.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const Body& body = *bodyByIndex[i];
+        const CompoundShape& compound = body.compound;
+        bodyX[i] = body.position.x;
+        bodyY[i] = body.position.y;
+        circleRadius[i] = compound.Count() == 1 && compound.kinds[0] == ShapeKind::Circle ? compound.radius[0] : Real(-1);
+        category[i] = body.category;
+    }
+
+    // Narrow phase: every chunk of pairs, then every chunk of moving bodies against the static index, into its own buffer
+    broadPhase.GetPairs(pairs);
+    pairChunks = (pairs.size() + ChunkPairs - 1) / ChunkPairs;
+    size_t staticChunks = staticByIndex.empty() ? 0 : (n + ChunkBodies - 1) / ChunkBodies;
+    size_t chunkCount = pairChunks + staticChunks;
+    if (chunks.size() < chunkCount)
+        chunks.resize(chunkCount);
+    if (staticHits.size() < staticChunks)
+        staticHits.resize(staticChunks);
+    auto job = [this, &staticIndex](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk)
+        {
+            if (chunk < pairChunks) TestChunk(chunk);
+            else TestStaticChunk(chunk, staticIndex);
+        }
+    };
+    if (pool && chunkCount > 1) pool->ParallelFor(chunkCount, 1, job);
+    else job(0, chunkCount);
+    testedCount = pairs.size();
+    for (size_t c = 0; c < staticChunks; ++c)
+        testedCount += staticHits[c].size();
+
+    // Merge the buffers in pair order
+    current.clear();
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        const std::vector<ContactEvent>& buffer = chunks[chunk];
+        for (size_t i = 0; i < buffer.size(); ++i)
+            current.push_back({ (uint64_t)buffer[i].indexA << 32 | buffer[i].indexB, (uint32_t)chunk, (uint32_t)i });
+    }
+    SortCurrent();
+
+    // Diff against the previous step's contacts: both sorted by key, so one walk
+    std::vector<ContactEvent>& begin = events[(int)ContactPhase::Begin];
+    std::vector<ContactEvent>& persist = events[(int)ContactPhase::Persist];
+    std::vector<ContactEvent>& end = events[(int)ContactPhase::End];
+    previousBegin.swap(begin);
+    previousPersist.swap(persist);
+    begin.clear();
+    persist.clear();
+    end.clear();
+    nextActive.clear();
+    size_t p = 0;
+    for (const ActiveContact& contact : current)
+    {
+        for (; p < active.size() && active[p].key < contact.key; ++p)
+            end.push_back(EventAt(active[p].location, previousBegin, previousPersist));
+        bool persists = p < active.size() && active[p].key == contact.key;
+        if (persists) ++p;
+        std::vector<ContactEvent>& target = persists ? persist : begin;
+        nextActive.push_back({ contact.key, (persists ? PersistBit : 0) | (uint32_t)target.size(), 0 });
+        target.push_back(chunks[contact.location][contact.item]);
+    }
+    for (; p < active.size(); ++p)
+        end.push_back(EventAt(active[p].location, previousBegin, previousPersist));
+    active.swap(nextActive);
+}
+
+void ContactStream::ForgetBody(const Body* body)
+{
+    if (!body) {
+        active.clear();
+        for (std::vector<ContactEvent>& list : events)
+            list.clear();
+        return;
+    }
+    std::vector<ContactEvent>& begin = events[(int)ContactPhase::Begin];
+    std::vector<ContactEvent>& persist = events[(int)ContactPhase::Persist];
+    active.erase(std::remove_if(active.begin(), active.end(), [&](const ActiveContact& contact) {
+        const ContactEvent& event = EventAt(contact.location, begin, persist);
+        return event.bodyA == body || event.bodyB == body;
+    }), active.end());
+}
+
+void ContactStream::Select(ContactPhase phase, const Body* body, uint32_t mask, std::vector<const ContactEvent*>& output) const
+{
+    for (const ContactEvent& event : events[(int)phase])
+    {
+        if (body && event.bodyA != body && event.bodyB != body) continue;
+        if (((event.categoryA | event.categoryB) & mask) == 0) continue;
+        output.push_back(&event);
+    }
+}
+
+void ContactStream::Reindex(const std::list<std::unique_ptr<Body>>& bodies, unsigned long long version,
+    const std::list<std::unique_ptr<Body>>& staticBodies, unsigned long long staticVersion)
+{
+    bodyByIndex.clear();
+    staticByIndex.clear();
+    std::unordered_map<const Body*, uint32_t> indexOf;
+    indexOf.reserve(bodies.size() + staticBodies.size());
+    for (const auto& bodyPtr : bodies)
+    {
+        indexOf.emplace(bodyPtr.get(), (uint32_t)bodyByIndex.size());
+        bodyByIndex.push_back(bodyPtr.get());
+    }
+    for (const auto& bodyPtr : staticBodies)
+    {
+        indexOf.emplace(bodyPtr.get(), (uint32_t)staticByIndex.size() | ContactEvent::StaticBit);
+        staticByIndex.push_back(bodyPtr.get());
+    }
+    indexVersion = version;
+    staticIndexVersion = staticVersion;
+
+    // Adding and removing bodies keeps the list order of the rest, so re-keyed contacts stay sorted
+    std::vector<ContactEvent>& begin = events[(int)ContactPhase::Begin];
+    std::vector<ContactEvent>& persist = events[(int)ContactPhase::Persist];
+    size_t kept = 0;
+    for (const ActiveContact& contact : active)
+    {
+        ContactEvent& event = EventAt(contact.location, begin, persist);
+        auto a = indexOf.find(event.bodyA), b = indexOf.find(event.bodyB);
+        if (a == indexOf.end() || b == indexOf.end()) continue; // Removed without ForgetBody
+        event.indexA = a->second;
+        event.indexB = b->second;
+        active[kept++] = { (uint64_t)event.indexA << 32 | event.indexB, contact.location, 0 };
+    }
+    active.resize(kept);
+}
+
+void ContactStream::TestChunk(size_t chunk)
+{
+    std::vector<ContactEvent>& buffer = chunks[chunk];
+    buffer.clear();
+    size_t first = chunk * ChunkPairs, last = std::min(first + ChunkPairs, pairs.size());
+    for (size_t k = first; k < last; ++k)
+    {
+        auto [indexA, indexB] = pairs[k];
+        if (indexA >= bodyX.size() || indexB >= bodyX.size()) continue;
+        if (((category[indexA] | category[indexB]) & categoryMask) == 0) continue;
+
+        ContactEvent event;
+        bool touching = false;
+        if (circleRadius[indexA] >= 0 && circleRadius[indexB] >= 0) {
+            PlacedShape a = { nullptr, nullptr, 0, circleRadius[indexA], bodyX[indexA], bodyY[indexA] };
+            PlacedShape b = { nullptr, nullptr, 0, circleRadius[indexB], bodyX[indexB], bodyY[indexB] };
+            touching = Collide(a, b, event);
+        } else {
+            // Deepest contact over all shape pairs of the two bodies
+            const Body& a = *bodyByIndex[indexA];
+            const Body& b = *bodyByIndex[indexB];
+            ContactEvent candidate;
+            for (size_t i = 0; i < a.compound.Count(); ++i)
+            {
+                PlacedShape shapeA = Place(a, i);
+                for (size_t j = 0; j < b.compound.Count(); ++j)
+                {
+                    if (Collide(shapeA, Place(b, j), candidate) && (!touching || candidate.depth > event.depth)) {
+                        event = candidate;
+                        touching = true;
+                    }
+                }
+            }
+        }
+        if (!touching) continue;
+        event.bodyA = bodyByIndex[indexA];
+        event.bodyB = bodyByIndex[indexB];
+        event.indexA = indexA;
+        event.indexB = indexB;
+        event.categoryA = category[indexA];
+        event.categoryB = category[indexB];
+        buffer.push_back(event);
+    }
+}
+
+void ContactStream::TestStaticChunk(size_t chunk, const SpatialIndex& staticIndex)
+{
+    std::vector<ContactEvent>& buffer = chunks[chunk];
+    std::vector<size_t>& hits = staticHits[chunk - pairChunks];
+    buffer.clear();
+    hits.clear();
+    size_t first = (chunk - pairChunks) * ChunkBodies, last = std::min(first + ChunkBodies, bodyByIndex.size());
+    for (size_t indexA = first; indexA < last; ++indexA)
+    {
+        const Body& a = *bodyByIndex[indexA];
+        const CompoundShape& compound = a.compound;
+        if (compound.Count() == 0) continue;
+        size_t firstHit = hits.size();
+        staticIndex.QueryRegion(double(bodyX[indexA] + compound.minX), double(bodyY[indexA] + compound.minY),
+            double(bodyX[indexA] + compound.maxX), double(bodyY[indexA] + compound.maxY), hits);
+        for (size_t h = firstHit; h < hits.size(); ++h)
+        {
+            size_t indexB = hits[h];
+            if (indexB >= staticByIndex.size()) continue;
+            const Body& b = *staticByIndex[indexB];
+            if (((category[indexA] | b.category) & categoryMask) == 0) continue;
+
+            // Deepest contact over all shape pairs, as for moving pairs
+            ContactEvent event, candidate;
+            bool touching = false;
+            for (size_t i = 0; i < compound.Count(); ++i)
+            {
+                PlacedShape shapeA = Place(a, i);
+                for (size_t j = 0; j < b.compound.Count(); ++j)
+                {
+                    if (Collide(shapeA, Place(b, j), candidate) && (!touching || candidate.depth > event.depth)) {
+                        event = candidate;
+                        touching = true;
+                    }
+                }
+            }
+            if (!touching) continue;
+            event.bodyA = bodyByIndex[indexA];
+            event.bodyB = staticByIndex[indexB];
+            event.indexA = (uint32_t)indexA;
+            event.indexB = (uint32_t)indexB | ContactEvent::StaticBit;
+            event.categoryA = category[indexA];
+            event.categoryB = b.category;
+            buffer.push_back(event);
+        }
+    }
+}
+
+void ContactStream::SortCurrent()
+{
+    // Keys only use as many bits per index as the body counts need, plus the static bit: sort those, 11 bits per pass
+    const unsigned DigitBits = 11;
+    const size_t Buckets = size_t(1) << DigitBits;
+    unsigned indexBits = 1;
+    while ((size_t(1) << indexBits) < std::max(bodyByIndex.size(), staticByIndex.size())) ++indexBits;
+    auto compact = [indexBits](uint64_t key) {
+        uint64_t b = key & 0xffffffffu;
+        return (key >> 32) << (indexBits + 1) | (b & ContactEvent::StaticBit ? uint64_t(1) << indexBits : 0) | (b & ~ContactEvent::StaticBit);
+    };
+    sorted.resize(current.size());
+    size_t counts[Buckets];
+    for (unsigned shift = 0; shift < 2 * indexBits + 1; shift += DigitBits)
+    {
+        std::fill(counts, counts + Buckets, 0);
+        for (const ActiveContact& contact : current)
+            ++counts[compact(contact.key) >> shift & (Buckets - 1)];
+        size_t offset = 0;
+        for (size_t& count : counts)
+            offset += std::exchange(count, offset);
+        for (const ActiveContact& contact : current)
+            sorted[counts[compact(contact.key) >> shift & (Buckets - 1)]++] = contact;
+        current.swap(sorted);
+    }
+}
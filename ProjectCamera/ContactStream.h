@@ -0,0 +1,154 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Body.h"
+#include "globals.h"
+
+class SpatialIndex;
+class SweepAndPrune;
+class ThreadPool;
+
+/**
+ * @struct ContactEvent
+ * @brief One pair of touching bodies as reported by ContactStream.
+ *
+ * Shapes are placed at their body's position without rotation, as the broad phase and the
+ * renderer place them. For an end event the contact data is that of the last step the pair touched.
+ * A contact with level geometry has the moving body as A and the static body as B.
+ */
+struct ContactEvent
+{
+    static constexpr uint32_t StaticBit = 1u << 31; ///< Set in indexB when bodyB is in World::staticBodies
+
+    Body* bodyA;               ///< Body with the lower index in World::bodies
+    Body* bodyB;               ///< Body with the higher index, or a static body
+    uint32_t indexA, indexB;   ///< Indices of the bodies in World::bodies (World::staticBodies plus StaticBit for a static B) at the time of the event
+    uint32_t categoryA, categoryB; ///< Body::category of both bodies
+    Real normalX, normalY;     ///< Unit normal pointing from A to B
+    Real pointX, pointY;       ///< Contact point in world coordinates (deepest point of B)
+    Real depth;                ///< Penetration depth along the normal (0 when just touching)
+};
+
+/**
+ * @enum ContactPhase
+ * @brief Which batch of a step a contact event belongs to.
+ */
+enum class ContactPhase : uint8_t
+{
+    Begin,   ///< Touching now, not in the step before
+    Persist, ///< Touching now and in the step before
+    End      ///< Touching in the step before, not now
+};
+
+/**
+ * @class ContactStream
+ * @brief Buffered contact events of a step, delivered as contiguous begin, persist and end arrays.
+ *
+ * After each step the broad-phase pairs are split into fixed chunks that the pool tests in
+ * parallel, each chunk writing its contacts into its own buffer, so no locks or atomics are
+ * involved. Static bodies are not in the broad phase: further chunks of moving bodies query
+ * the static index with their boxes and test what it returns, into buffers of their own. The buffers are then merged by pair key and diffed against the previous step's
+ * contacts with a single linear walk. Events therefore come out in pair order, independent
+ * of the thread count, and consumers read plain arrays instead of receiving callbacks.
+ */
+class ContactStream
+{
+public:
+    bool enabled = false;          ///< Updated by World::Update only when enabled
+    uint32_t categoryMask = ~0u;   ///< Only pairs where either body's category intersects this are tested
+
+    /**
+     * @brief Test this step's broad-phase pairs and every moving body against the static bodies, and build the event arrays.
+     * @param bodies Bodies of the world; the broad phase must be up to date with them
+     * @param version World::version, to detect added or removed bodies
+     * @param staticBodies Static bodies of the world
+     * @param staticVersion World::staticVersion, to detect added or removed static bodies
+     * @param staticIndex Spatial index over staticBodies
+     * @param broadPhase Broad phase updated this step
+     * @param pool Pool for the pair tests; nullptr tests them on the calling thread
+     */
+    void Update(const std::list<std::unique_ptr<Body>>& bodies, unsigned long long version,
+        const std::list<std::unique_ptr<Body>>& staticBodies, unsigned long long staticVersion,
+        const SpatialIndex& staticIndex, const SweepAndPrune& broadPhase, ThreadPool* pool);
+
+    /**
+     * @brief Drop the contacts of a body about to be removed, so they end without an event.
+     *
+     * The arrays of the last step still hold events with the body until the next Update.
+     * @param body Body about to be removed, or nullptr for all bodies (also clears the arrays)
+     */
+    void ForgetBody(const Body* body);
+
+    /**
+     * @brief Events of one phase from the last Update.
+     * @param phase Batch to return
+     * @return Events in pair order; valid until the next Update or ForgetBody(nullptr)
+     */
+    const std::vector<ContactEvent>& Events(ContactPhase phase) const { return events[(int)phase]; }
+
+    /**
+     * @brief Append the events of a phase that involve a body and a category.
+     * @param phase Batch to filter
+     * @param body Only events with this body, or all events if null
+     * @param mask Only events where either body's category intersects this
+     * @param output Receives pointers into the event array (appended)
+     */
+    void Select(ContactPhase phase, const Body* body, uint32_t mask, std::vector<const ContactEvent*>& output) const;
+
+    size_t GetTestedCount() const { return testedCount; }     ///< Broad-phase and static pairs tested in the last Update
+    size_t GetContactCount() const { return active.size(); }  ///< Pairs touching after the last Update
+
+private:
+    static constexpr size_t ChunkPairs = 1024;   ///< Pairs tested per chunk (per buffer)
+    static constexpr size_t ChunkBodies = 256;   ///< Moving bodies queried against the static index per chunk
+    static constexpr uint32_t PersistBit = 1u << 31; ///< Location of an active contact is in the persist array
+
+    /// A touching pair, ordered by key, with the location of its event in the begin or persist array
+    struct ActiveContact
+    {
+        uint64_t key;       ///< indexA << 32 | indexB
+        uint32_t location;  ///< Index into begin, or into persist with PersistBit set; the chunk for current
+        uint32_t item;      ///< Index in the chunk's buffer (current only)
+    };
+
+    // Refresh the body tables and re-key the active contacts after bodies or static bodies were added or removed.
+    void Reindex(const std::list<std::unique_ptr<Body>>& bodies, unsigned long long version,
+        const std::list<std::unique_ptr<Body>>& staticBodies, unsigned long long staticVersion);
+
+    // Radix-sort this step's contacts by pair key.
+    void SortCurrent();
+
+    // Test the pairs of one chunk and write its contacts into the chunk's buffer.
+    void TestChunk(size_t chunk);
+
+    // Test one chunk of moving bodies against the static bodies their boxes overlap.
+    void TestStaticChunk(size_t chunk, const SpatialIndex& staticIndex);
+
+    // Event an active contact refers to, in the given begin and persist arrays.
+    static ContactEvent& EventAt(uint32_t location, std::vector<ContactEvent>& begin, std::vector<ContactEvent>& persist)
+    {
+        return location & PersistBit ? persist[location & ~PersistBit] : begin[location];
+    }
+
+    std::vector<ContactEvent> events[3];          ///< Begin, persist and end arrays of the last Update
+    std::vector<ContactEvent> previousBegin, previousPersist; ///< Arrays of the Update before, for end events
+    std::vector<ActiveContact> active;            ///< Touching pairs by key, into events
+    std::vector<ActiveContact> nextActive;        ///< Active list being built
+    std::vector<ActiveContact> current;           ///< This step's contacts by key, into chunks
+    std::vector<ActiveContact> sorted;            ///< Radix sort scratch
+    std::vector<std::vector<ContactEvent>> chunks; ///< One contact buffer per chunk of pairs, then per chunk of static queries
+    std::vector<std::vector<size_t>> staticHits;  ///< Static index results, one scratch list per static chunk
+    std::vector<std::pair<uint32_t, uint32_t>> pairs; ///< Broad-phase pairs of the current step
+    size_t pairChunks = 0;                        ///< Chunks of pairs this step; static chunks follow them
+    size_t testedCount = 0;                       ///< Pairs and static candidates tested this step
+    std::vector<Body*> bodyByIndex;               ///< World::bodies in list order
+    std::vector<Body*> staticByIndex;             ///< World::staticBodies in list order
+    std::vector<Real> bodyX, bodyY;               ///< Body positions of this step, by index
+    std::vector<Real> circleRadius;               ///< Radius of bodies that are one circle, else negative
+    std::vector<uint32_t> category;               ///< Body::category of this step, by index
+    unsigned long long indexVersion = ~0ull;      ///< World::version bodyByIndex was built for
+    unsigned long long staticIndexVersion = ~0ull; ///< World::staticVersion staticByIndex was built for
+};
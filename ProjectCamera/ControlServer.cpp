@@ -0,0 +1,247 @@
+// ControlServer.cpp
+// Non-blocking Unix-domain-socket command server (AF_UNIX is available on Windows 10 1803+).
+#include "ControlServer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include "Debugger.h"
+#include "Simulation.h"
+#include "World.h"
+
+#ifdef _WIN32
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+typedef WSAPOLLFD ControlPollFd;
+static int PollSockets(ControlPollFd* fds, size_t count, int timeoutMs) { return WSAPoll(fds, (ULONG)count, timeoutMs); }
+static void CloseSocket(ControlSocket s) { closesocket(s); }
+static bool WouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+static void SetNonBlocking(ControlSocket s) { u_long on = 1; ioctlsocket(s, FIONBIO, &on); }
+static const ControlSocket InvalidSocket = INVALID_SOCKET;
+static const int SendFlags = 0; // Winsock never raises signals
+// AF_UNIX socket files are reparse points; 1 if path is one, 0 if it is another file, -1 if nothing is there.
+static int IsSocketFile(const char* path)
+{
+    DWORD attributes = GetFileAttributesA(path);
+    if (attributes == INVALID_FILE_ATTRIBUTES) return -1;
+    return (attributes & FILE_ATTRIBUTE_REPARSE_POINT) ? 1 : 0;
+}
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+typedef pollfd ControlPollFd;
+static int PollSockets(ControlPollFd* fds, size_t count, int timeoutMs) { return poll(fds, (nfds_t)count, timeoutMs); }
+static void CloseSocket(ControlSocket s) { close(s); }
+static bool WouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+static void SetNonBlocking(ControlSocket s) { fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK); }
+static const ControlSocket InvalidSocket = -1;
+#ifdef MSG_NOSIGNAL
+static const int SendFlags = MSG_NOSIGNAL; // A client gone before its reply must not kill the app with SIGPIPE
+#else
+static const int SendFlags = 0; // SO_NOSIGPIPE is set on each connection instead
+#endif
+// 1 if path is a socket, 0 if it is another kind of file, -1 if nothing is there.
+static int IsSocketFile(const char* path)
+{
+    struct stat info;
+    if (lstat(path, &info) != 0) return -1;
+    return S_ISSOCK(info.st_mode) ? 1 : 0;
+}
+#endif
+
+// Poll timeout while a batch is in flight; bounds how long finished replies wait before being sent
+static const int BusyPollTimeoutMs = 1;
+// Poll timeout while idle; new input wakes poll at once, so this only bounds how long Stop waits
+static const int IdlePollTimeoutMs = 100;
+// Most bytes read from one client per poll round before its lines are split off
+static const size_t MaxInputBytes = 16 * ControlServer::MaxLineBytes;
+
+ControlServer::~ControlServer()
+{
+    Stop();
+}
+
+bool ControlServer::Start(const std::string& socketPath, Simulation& sim, std::string& error)
+{
+    Stop();
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        error = "WSAStartup failed";
+        return false;
+    }
+#endif
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        error = "socket path is too long";
+        return false;
+    }
+    std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", socketPath.c_str());
+
+    int existing = IsSocketFile(socketPath.c_str());
+    if (existing == 0) {
+        error = socketPath + " exists and is not a socket";
+        return false;
+    }
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == InvalidSocket) {
+        error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    if (existing == 1)
+        std::remove(socketPath.c_str()); // stale socket file from a previous run
+    if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 16) != 0) {
+        error = std::string("bind: ") + std::strerror(errno);
+        CloseSocket(listener);
+        return false;
+    }
+    SetNonBlocking(listener);
+    listening = true;
+    path = socketPath;
+    simulation = &sim;
+    running = true;
+    thread = std::thread(&ControlServer::Run, this);
+    return true;
+}
+
+void ControlServer::Stop()
+{
+    running = false;
+    if (thread.joinable())
+        thread.join();
+    for (auto& client : clients)
+        CloseSocket(client.socket);
+    clients.clear();
+    if (listening) {
+        CloseSocket(listener);
+        std::remove(path.c_str());
+        listening = false;
+    }
+}
+
+void ControlServer::Run()
+{
+    std::vector<ControlPollFd> fds;
+    std::vector<PendingCommand> batch;
+    char buffer[16384];
+    while (running)
+    {
+        // Move finished replies into the send buffers
+        for (auto& client : clients) {
+            std::lock_guard<std::mutex> lock(client.replies->mutex);
+            if (!client.replies->text.empty()) {
+                client.output += client.replies->text;
+                client.replies->text.clear();
+            }
+        }
+
+        fds.clear();
+        fds.push_back({ listener, POLLIN, 0 });
+        for (auto& client : clients)
+            fds.push_back({ client.socket, (short)(POLLIN | (client.output.empty() ? 0 : POLLOUT)), 0 });
+        int timeoutMs = inFlight->load() > 0 ? BusyPollTimeoutMs : IdlePollTimeoutMs;
+        if (PollSockets(fds.data(), fds.size(), timeoutMs) < 0)
+            continue;
+
+        // Accept every pending connection
+        if (fds[0].revents & POLLIN) {
+            for (;;) {
+                ControlSocket s = accept(listener, nullptr, nullptr);
+                if (s == InvalidSocket) break;
+                SetNonBlocking(s);
+#ifdef SO_NOSIGPIPE
+                int on = 1;
+                setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+                clients.push_back({ s, std::string(), std::string(), std::make_shared<Replies>() });
+            }
+        }
+
+        // Read and write existing clients (fds[i + 1] belongs to clients[i] as polled)
+        size_t polled = fds.size() - 1;
+        for (size_t i = 0; i < polled; ++i)
+        {
+            Client& client = clients[i];
+            short events = fds[i + 1].revents;
+            bool closed = (events & (POLLERR | POLLHUP)) != 0 && !(events & POLLIN);
+            if (events & POLLIN) {
+                for (;;) {
+                    auto received = recv(client.socket, buffer, sizeof(buffer), 0);
+                    if (received > 0) {
+                        client.input.append(buffer, (size_t)received);
+                        if (client.input.size() < MaxInputBytes) continue;
+                        break; // Split what is here first; the rest is read next round
+                    }
+                    if (received == 0 || !WouldBlock()) closed = true;
+                    break;
+                }
+                // Split complete lines into the batch
+                size_t start = 0, end;
+                while ((end = client.input.find('\n', start)) != std::string::npos) {
+                    std::string line = client.input.substr(start, end - start);
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    if (!line.empty()) batch.push_back({ client.replies, std::move(line) });
+                    start = end + 1;
+                }
+                client.input.erase(0, start);
+                if (client.input.size() > MaxLineBytes)
+                    closed = true; // No newline in sight: drop the client rather than buffer without limit
+            }
+            if (!closed && !client.output.empty()) {
+                auto sent = send(client.socket, client.output.data(), (int)client.output.size(), SendFlags);
+                if (sent > 0) client.output.erase(0, (size_t)sent);
+                else if (sent < 0 && !WouldBlock()) closed = true;
+            }
+            if (closed) {
+                CloseSocket(client.socket);
+                client.socket = InvalidSocket;
+            }
+        }
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+            [](const Client& c) { return c.socket == InvalidSocket; }), clients.end());
+
+        // One simulation command per round, however many lines arrived
+        if (!batch.empty()) {
+            auto commands = std::make_shared<std::vector<PendingCommand>>(std::move(batch));
+            batch.clear();
+            ++*inFlight;
+            simulation->Post([commands, pending = inFlight](World& world) {
+                std::vector<std::string> scratch;
+                for (auto& command : *commands)
+                    Execute(world, command.line, scratch, *command.replies);
+                --*pending;
+            });
+        }
+    }
+}
+
+void ControlServer::Execute(World& world, const std::string& line, std::vector<std::string>& scratch, Replies& replies)
+{
+    std::string text;
+    if (line == "state") {
+        // Bulk state query: one line per body
+        size_t index = 0;
+        char row[160];
+        for (const auto& bodyPtr : world.bodies) {
+            const Body& body = *bodyPtr;
+            std::snprintf(row, sizeof(row), "%zu %.9g %.9g %.9g %.9g\n", index++,
+                double(body.position.x), double(body.position.y), double(body.velocity.x), double(body.velocity.y));
+            text += row;
+        }
+    } else {
+        scratch.clear();
+        Debugger::ExecuteCommand(world, line, scratch);
+        for (const auto& output : scratch) {
+            text += output;
+            text += '\n';
+        }
+    }
+    text += ".\n";
+    std::lock_guard<std::mutex> lock(replies.mutex);
+    replies.text += text;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+typedef SOCKET ControlSocket;
+#else
+typedef int ControlSocket;
+#endif
+
+class Simulation;
+class World;
+
+/**
+ * @class ControlServer
+ * @brief Local Unix-domain-socket server that drives the simulation with Debugger commands.
+ *
+ * Clients send newline-terminated commands: anything Debugger::ExecuteCommand understands,
+ * plus "state" which returns one line per body ("index x y vx vy"). Each command is
+ * answered with its output lines followed by a line containing a single ".".
+ *
+ * The server thread uses non-blocking sockets and poll(). All commands that arrive in
+ * one poll round, from all clients, are posted to the simulation as a single batch and
+ * applied together at the next step boundary, so clients that pipeline their commands
+ * can issue thousands per second without adding work to the frame loop. While no batch
+ * is in flight the thread sleeps in poll; a client whose line grows past MaxLineBytes
+ * without a newline is disconnected.
+ */
+class ControlServer
+{
+public:
+    static constexpr size_t MaxLineBytes = 64 * 1024; ///< Longest accepted command line
+
+    ~ControlServer();
+
+    /**
+     * @brief Bind the socket and start the server thread.
+     * @param path Filesystem path of the Unix domain socket (a stale socket there is replaced, any other file is kept)
+     * @param simulation Simulation to post command batches to
+     * @param error Receives the reason on failure
+     * @return False if the path is taken by another file or the socket could not be created or bound
+     */
+    bool Start(const std::string& path, Simulation& simulation, std::string& error);
+
+    /**
+     * @brief Stop the server thread, close all connections and remove the socket file.
+     */
+    void Stop();
+
+private:
+    /// Replies produced on the simulation thread for one client
+    struct Replies
+    {
+        std::mutex mutex;
+        std::string text;
+    };
+
+    /// Connection state owned by the server thread
+    struct Client
+    {
+        ControlSocket socket;
+        std::string input;                 ///< Bytes received but not yet a full line
+        std::string output;                ///< Bytes waiting to be sent
+        std::shared_ptr<Replies> replies;  ///< Shared with in-flight command batches
+    };
+
+    /// One command waiting to be posted
+    struct PendingCommand
+    {
+        std::shared_ptr<Replies> replies;
+        std::string line;
+    };
+
+    // Server thread body: accept, read, post batches, write replies.
+    void Run();
+
+    // Execute one command on the simulation thread and append its reply.
+    static void Execute(World& world, const std::string& line, std::vector<std::string>& scratch, Replies& replies);
+
+    std::string path;
+    Simulation* simulation = nullptr;
+    ControlSocket listener;
+    bool listening = false;
+    std::thread thread;
+    std::atomic<bool> running{ false };
+    std::shared_ptr<std::atomic<int>> inFlight = std::make_shared<std::atomic<int>>(0); ///< Posted batches not yet executed
+    std::vector<Client> clients;
+};
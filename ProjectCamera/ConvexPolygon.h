@@ -2,6 +2,8 @@
 #include "Shape.h"
 #include "Vector.h"
 #include <SDL3/SDL.h>
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 /**
@@ -13,42 +15,112 @@
 class ConvexPolygon : public Shape
 {
 public:
-    std::vector<Vector<double>> vertices; ///< Vertices of the polygon
-    std::vector<Vector<double>> normals;  ///< Normals for each edge
-    
+    std::vector<Vector<Real>> vertices; ///< Vertices of the polygon (fixed after construction)
+    std::vector<Vector<Real>> normals;  ///< Outward normal of the edge starting at each vertex
+
     // Default constructor
-    ConvexPolygon() = default;
+    ConvexPolygon() : Shape(ShapeKind::Polygon) {}
 
     /**
      * @brief Construct a new ConvexPolygon object with given node positions.
-     * @param points The positions of the polygon's vertices (in local space)
+     *
+     * Edge normals, area, centroid, inertia and bounds are computed here once.
+     * @param points The positions of the polygon's vertices (in local space, either winding)
      */
-    ConvexPolygon(const std::vector<Vector<double>>& points);
+    ConvexPolygon(const std::vector<Vector<Real>>& points);
 
     /**
      * @brief Render the convex polygon at the given position using the SDL renderer.
      * @param position The position to render at (offset for all vertices)
      * @param renderer The SDL renderer to use
      */
-    void Render(const Vector<double>& position, SDL_Renderer* renderer) override;
+    void Render(const Vector<Real>& position, SDL_Renderer* renderer);
+
+    /**
+     * @brief Draw a polygon outline from flat vertex arrays (compound-shape render path).
+     * @param renderer The SDL renderer to use
+     * @param x Offset X added to all vertices
+     * @param y Offset Y added to all vertices
+     * @param vertexX Vertex X coordinates
+     * @param vertexY Vertex Y coordinates
+     * @param count Number of vertices
+     */
+    static void Draw(SDL_Renderer* renderer, Real x, Real y, const Real* vertexX, const Real* vertexY, size_t count);
 };
 
 // Implementation of constructor
-inline ConvexPolygon::ConvexPolygon(const std::vector<Vector<double>>& points)
-    : vertices(points), normals(points.size()) {}
+inline ConvexPolygon::ConvexPolygon(const std::vector<Vector<Real>>& points)
+    : Shape(ShapeKind::Polygon), vertices(points), normals(points.size())
+{
+    size_t n = vertices.size();
+    if (n == 0) return;
+    Real r2 = 0;
+    minX = maxX = vertices[0].x;
+    minY = maxY = vertices[0].y;
+    for (const auto& v : vertices)
+    {
+        r2 = std::max(r2, v.x * v.x + v.y * v.y);
+        minX = std::min(minX, v.x); maxX = std::max(maxX, v.x);
+        minY = std::min(minY, v.y); maxY = std::max(maxY, v.y);
+    }
+    boundingRadius = sqrt(r2);
+    if (n < 3) return;
+
+    // Signed sums over the edge triangles fanned from the origin
+    Real twiceArea = 0, cx = 0, cy = 0, second = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const Vector<Real>& a = vertices[i];
+        const Vector<Real>& b = vertices[(i + 1) % n];
+        Real cross = a.x * b.y - a.y * b.x;
+        twiceArea += cross;
+        cx += (a.x + b.x) * cross;
+        cy += (a.y + b.y) * cross;
+        second += cross * (a.x * a.x + a.x * b.x + b.x * b.x + a.y * a.y + a.y * b.y + b.y * b.y);
+    }
+    if (twiceArea == 0) return;
+    Real sign = twiceArea > 0 ? Real(1) : Real(-1);
+    area = sign * twiceArea / 2;
+    centroidX = cx / (3 * twiceArea);
+    centroidY = cy / (3 * twiceArea);
+    inertia = sign * second / 12 - area * (centroidX * centroidX + centroidY * centroidY); // parallel axis to centroid
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const Vector<Real>& a = vertices[i];
+        const Vector<Real>& b = vertices[(i + 1) % n];
+        Real ex = b.x - a.x, ey = b.y - a.y;
+        Real length = sqrt(ex * ex + ey * ey);
+        normals[i] = Vector<Real>(2);
+        if (length > 0)
+            normals[i].set(sign * ey / length, -sign * ex / length);
+    }
+}
 
 // Implementation of Render function
-inline void ConvexPolygon::Render(const Vector<double>& position, SDL_Renderer* renderer)
-{   
+inline void ConvexPolygon::Render(const Vector<Real>& position, SDL_Renderer* renderer)
+{
     if (vertices.size() < 2) return; // Need at least 2 points to draw
     SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // Red color
     for (size_t i = 0; i < vertices.size(); ++i) {
-        const Vector<double>& v1 = vertices[i];
-        const Vector<double>& v2 = vertices[(i + 1) % vertices.size()]; // wrap around
+        const Vector<Real>& v1 = vertices[i];
+        const Vector<Real>& v2 = vertices[(i + 1) % vertices.size()]; // wrap around
         int x1 = static_cast<int>(position.x + v1.x);
         int y1 = static_cast<int>(position.y + v1.y);
         int x2 = static_cast<int>(position.x + v2.x);
         int y2 = static_cast<int>(position.y + v2.y);
         SDL_RenderLine(renderer, x1, y1, x2, y2);
     }
-}
\ No newline at end of file
+}
+
+// Implementation of Draw function
+inline void ConvexPolygon::Draw(SDL_Renderer* renderer, Real x, Real y, const Real* vertexX, const Real* vertexY, size_t count)
+{
+    if (count < 2) return; // Need at least 2 points to draw
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // Red color
+    for (size_t i = 0; i < count; ++i) {
+        size_t j = (i + 1) % count; // wrap around
+        SDL_RenderLine(renderer, static_cast<int>(x + vertexX[i]), static_cast<int>(y + vertexY[i]),
+            static_cast<int>(x + vertexX[j]), static_cast<int>(y + vertexY[j]));
+    }
+}
@@ -3,6 +3,8 @@
  *
  * Implements a simple in-game chat/debugger window for interacting with the physics world.
  * Allows listing, adding, and modifying bodies, and provides a help command.
+ * Commands are executed on the simulation thread at the next step boundary;
+ * their output is handed back and shown on the following frame.
  *
  * Controls:
  *   - Press ` (backtick) to toggle chat input
@@ -14,22 +16,35 @@
  *   - list: List all bodies
  *   - add [x y vx vy fx fy]: Add a new body (all arguments optional)
  *   - set <index> <property> <value>: Set a property of a body by index
+ *   - find <x> <y> <r>: List bodies overlapping a circle
+ *   - ray <x> <y> <dx> <dy> [max]: Report the first body hit by a ray
+ *   - gravity on|off|theta <v>|g <v>|soft <v>: Configure Barnes-Hut mutual gravity
+ *   - particles [emit x y count [speed life] | emitter x y rate [speed life] | gravity gx gy | clear]
+ *   - soft [lattice x y cols rows [spacing k c] [pin] | gravity gx gy | floor y | clear]: Mass-spring soft bodies
+ *   - fluid [block x y cols rows | box x0 y0 x1 y1 | gravity gx gy | clear]: SPH liquid
+ *   - joint distance|spring|revolute|weld <a> <b|world> [x y] [k c]: Connect two bodies
+ *   - joint chain <n> <x> <y> [spacing] | joint clear: Hang a chain of links / remove all joints
+ *   - telemetry [start <file> [pve] [compress] | stop]: Stream per-step body state to a file
+ *   - bench <name> [count]: Run a headless benchmark (blocks the simulation while it runs)
+ *   - scenario rain|impulse|bounce ... | stop [id]: Start or stop scripted scenarios
+ *   - alloc [strict on|off]: Show allocation totals per subsystem / toggle strict mode
  */
 #include "Debugger.h"
 #include "globals.h"
 #include "Circle.h"
+#include "ConvexPolygon.h"
+#include "Benchmarks.h"
+#include "SceneFile.h"
+#include "Scenario.h"
 #include <SDL3/SDL.h>
 #include <SDL3_ttf/SDL_ttf.h>
 #include <algorithm>
+#include <cstdlib>
 #include <string>
 #include <iostream>
 #include <sstream>
 #include <map>
-
-// External SDL objects and font
-extern SDL_Renderer* renderer;
-extern TTF_Font* gFont;
-extern SDL_Window* gWindow;
+#include <random>
 
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 800
@@ -38,11 +53,6 @@ extern SDL_Window* gWindow;
 #define CHAT_WINDOW_WIDTH WINDOW_WIDTH
 #define CHAT_WINDOW_HEIGHT WINDOW_HEIGHT
 
-// Scroll offset for chat window (how many lines up from the bottom)
-static int chatScrollOffset = 0;
-// Flag to control chat window visibility
-static bool chatVisible = true;
-
 /**
  * @brief Handles all SDL events related to the chat/debugger window.
  *        Includes toggling, scrolling, and closing the chat window.
@@ -57,9 +67,9 @@ void Debugger::HandleEvent(const SDL_Event& e)
         }
         inputActive = !inputActive; // Toggle input mode
         if (inputActive) {
-            SDL_StartTextInput(gWindow); // Start text input
+            SDL_StartTextInput(window); // Start text input
         } else {
-            SDL_StopTextInput(gWindow); // Stop text input
+            SDL_StopTextInput(window); // Stop text input
         }
         return;
     }
@@ -86,14 +96,14 @@ void Debugger::HandleEvent(const SDL_Event& e)
         return;
     }
     // Pass mouse events to properties window for arrow navigation
-    if (propertiesWindow && world) {
-        propertiesWindow->HandleEvent(e, *world);
+    if (propertiesWindow && simulation) {
+        propertiesWindow->HandleEvent(e, *simulation);
     }
     // Close chat with Escape (even if not typing)
     if (e.type == SDL_EVENT_KEY_DOWN && e.key.scancode == SDL_SCANCODE_ESCAPE) {
         if (inputActive) {
             inputActive = false;
-            SDL_StopTextInput(gWindow); // Stop text input if active
+            SDL_StopTextInput(window); // Stop text input if active
         }
         chatVisible = false; // Hide chat window from view
         return;
@@ -124,35 +134,125 @@ static std::string trim(const std::string& s) {
     return (start == std::string::npos) ? "" : s.substr(start, end - start + 1);
 }
 
+// Most bodies, particles or fluid cells one command may create; anything larger is taken for a typo.
+static constexpr double MaxCreateCount = 1e6;
+
+/**
+ * Helper function to check a count of things a command creates.
+ * @param count The parsed count
+ * @return True for a whole number from 1 to MaxCreateCount
+ */
+static bool IsCreateCount(double count) {
+    return count >= 1 && count <= MaxCreateCount && count == floor(count);
+}
+
+/**
+ * Scenario: drop count circles at random points along the top every interval seconds.
+ * @param bursts Number of drops, 0 for no end
+ */
+static ScenarioTask RainScenario(World& world, int count, double interval, int bursts)
+{
+    std::mt19937 rng((unsigned)world.stepCount);
+    std::uniform_real_distribution<double> x(20.0, WINDOW_WIDTH - 20.0);
+    for (int burst = 0; bursts == 0 || burst < bursts; ++burst)
+    {
+        for (int i = 0; i < count; ++i) {
+            world.AddBody(x(rng), 20.0, 0, 0, 0, 0, new Circle(5));
+            world.bodies.back()->gravity.set(0, 200); // Let it fall
+        }
+        co_await WaitSeconds{ interval };
+    }
+}
+
+/**
+ * Scenario: after delay seconds, add an impulse to whatever body then has the given index.
+ */
+static ScenarioTask ImpulseScenario(World& world, size_t index, double delay, double impulseX, double impulseY)
+{
+    co_await WaitSeconds{ delay };
+    Body* body = world.GetBody(index);
+    if (body && body->IsDynamic() && body->mass > 0) {
+        body->velocity.x += impulseX / body->mass;
+        body->velocity.y += impulseY / body->mass;
+    }
+}
+
+/**
+ * Scenario: every time the body touches another, launch it upward at the given speed.
+ */
+static ScenarioTask BounceScenario(Body* body, double speed)
+{
+    while (co_await WaitContact{ body })
+        body->velocity.y = -speed;
+}
+
 /**
  * Helper to set a component (x or y) of a Vector2D.
  * @param v The vector to modify
  * @param idx 0 for x, 1 for y
  * @param value The value to set
  */
-static void setVec2Component(Vector<double>& v, int idx, double value) {
+static void setVec2Component(Vec2& v, int idx, double value) {
     if (idx == 0) v.x = value;
     else if (idx == 1) v.y = value;
-    v.syncComponents();
 }
 
 /**
  * Debugger constructor.
- * @param world Pointer to the physics world
+ * @param simulation Pointer to the simulation running the physics world
  */
-Debugger::Debugger(World* world)
-    : world(world)
+Debugger::Debugger(Simulation* simulation, SDL_Renderer* renderer, SDL_Window* window, TTF_Font* font)
+    : simulation(simulation), renderer(renderer), window(window), font(font)
 {
     inputActive = true; // Start with chat input active
     chatLines.push_back("Debugger ready. Type 'list' to see all bodies.");
 }
 
 /**
- * Call every frame to render the chat window.
+ * Call every frame to collect command output and render the chat window.
+ * @param snapshot Latest state published by the simulation
  */
-void Debugger::Update()
+void Debugger::Update(const RenderSnapshot& snapshot)
 {
-    RenderChatWindow();
+    std::vector<std::string> lines;
+    {
+        std::lock_guard<std::mutex> lock(replyMutex);
+        lines.swap(replyLines);
+    }
+    if (!lines.empty()) {
+        for (auto& line : lines)
+            chatLines.push_back(std::move(line));
+        // Keep more history for scrolling
+        while (chatLines.size() > 50) chatLines.pop_front();
+        chatScrollOffset = 0; // Reset scroll to bottom on new output
+    }
+    RenderChatWindow(snapshot);
+    if (AllocationTracker::Enabled)
+        RenderAllocations();
+}
+
+/**
+ * Renders the allocations made since the previous frame, per subsystem, in the top left corner.
+ * In strict mode a frame in which World::Update allocated is counted and shown in red, unless
+ * commands allocated within the last second of frames (adding bodies legitimately grows buffers).
+ */
+void Debugger::RenderAllocations()
+{
+    AllocationCounters now = AllocationTracker::Read();
+    AllocationCounters frame = now.Since(lastAllocations);
+    lastAllocations = now;
+    settledFrames = frame.count[(size_t)AllocationSubsystem::Commands] ? 0 : settledFrames + 1;
+    bool violation = AllocationTracker::IsStrict() && settledFrames > 60 && frame.count[(size_t)AllocationSubsystem::World] > 0;
+    if (violation) ++strictViolations;
+
+    std::string text = "alloc/frame";
+    for (size_t i = 0; i < AllocationSubsystemCount; ++i)
+        text += std::string("  ") + AllocationTracker::Name((AllocationSubsystem)i) + " " +
+            std::to_string(frame.count[i]) + "/" + std::to_string(frame.bytes[i]) + "B";
+    RenderText(text, 10, 10, SDL_Color{ 200, 200, 200, 255 });
+    if (strictViolations)
+        RenderText("strict: World::Update allocated in " + std::to_string(strictViolations) + " settled frames",
+            10, 35, violation ? SDL_Color{ 255, 60, 60, 255 } : SDL_Color{ 255, 160, 60, 255 });
 }
 
 /**
@@ -164,8 +264,8 @@ void Debugger::Update()
  */
 void Debugger::RenderText(const std::string& text, int x, int y, SDL_Color color)
 {
-    if (!gFont) return;
-    SDL_Surface* surface = TTF_RenderText_Solid(gFont, text.c_str(), 0, color); // Render text to surface
+    if (!font) return;
+    SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), 0, color); // Render text to surface
     if (!surface) return;
     SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface); // Create texture from surface
     if (!texture) { SDL_DestroySurface(surface); return; }
@@ -178,11 +278,12 @@ void Debugger::RenderText(const std::string& text, int x, int y, SDL_Color color
 /**
  * Renders the chat window and recent chat lines at the bottom of the screen.
  * Only renders if chatVisible is true.
+ * @param snapshot Latest state published by the simulation
  */
-void Debugger::RenderChatWindow()
+void Debugger::RenderChatWindow(const RenderSnapshot& snapshot)
 {
-    if (propertiesWindow && world) {
-        propertiesWindow->Render(renderer, gFont, *world); // Pass world by reference
+    if (propertiesWindow) {
+        propertiesWindow->Render(renderer, font, snapshot); // Pass snapshot by reference
     }
     if (!chatVisible) return; // Do not render chat if hidden
     int chatHeight = 120;
@@ -203,33 +304,72 @@ void Debugger::RenderChatWindow()
 }
 
 /**
- * Processes a command entered in the chat window.
+ * Queues a command entered in the chat window for the next simulation step.
  * @param cmd The command string
  */
 void Debugger::ProcessCommand(const std::string& cmd)
 {
     std::cout << "Command entered: " << cmd << std::endl;
+    simulation->Post([this, cmd](World& world) {
+        std::vector<std::string> output;
+        ExecuteCommand(world, cmd, output);
+        std::lock_guard<std::mutex> lock(replyMutex);
+        for (auto& line : output)
+            replyLines.push_back(std::move(line));
+    });
+}
+
+/**
+ * Executes a command against the world. Runs on the simulation thread.
+ * @param world The physics world
+ * @param cmd The command string
+ * @param output Receives the lines to show in the chat window
+ */
+void Debugger::ExecuteCommand(World& world, const std::string& cmd, std::vector<std::string>& output)
+{
     std::istringstream iss(cmd);
     std::string command;
     iss >> command;
     // Handle 'help' command
     if (command == "help") {
-        chatLines.push_back("Commands:");
-        chatLines.push_back("list - List all bodies");
-        chatLines.push_back("add [x y vx vy fx fy] - Add a body");
-        chatLines.push_back("set <index> <property> <value> - Set property of body");
-        chatLines.push_back("help - Show this help");
-        chatLines.push_back("Press ESC to close chat");
+        output.push_back("Commands:");
+        output.push_back("list - List all bodies");
+        output.push_back("add [x y vx vy fx fy] - Add a body");
+        output.push_back("kinematic <x> <y> <vx> <vy> [r] - Add a body moving at a fixed velocity");
+        output.push_back("static <x> <y> <w> <h> - Add a fixed box (level geometry)");
+        output.push_back("set <index> <property> <value> - Set property of body");
+        output.push_back("find <x> <y> <r> - List bodies within r of (x, y)");
+        output.push_back("ray <x> <y> <dx> <dy> [max] - First body hit by a ray");
+        output.push_back("Click a body to select it in the properties window");
+        output.push_back("gravity on|off|theta <v>|g <v>|soft <v> - Mutual gravity");
+        output.push_back("broadphase [on|off] - Sweep-and-prune overlap pairs");
+        output.push_back("contacts [on|off] [mask <bits>] [body <i>] - Contact events of the last step");
+        output.push_back("integrator [euler|verlet|rk4] - Show or choose the time integrator");
+        output.push_back("substeps [on|off] [max] - Adaptive per-island substepping");
+        output.push_back("particles [emit x y n [speed life]|emitter x y rate [speed life]|gravity gx gy|clear]");
+        output.push_back("soft [lattice x y cols rows [spacing k c] [pin]|gravity gx gy|floor y|clear] - Soft bodies");
+        output.push_back("fluid [block x y cols rows|box x0 y0 x1 y1|gravity gx gy|clear] - SPH liquid");
+        output.push_back("joint distance|spring|revolute|weld <a> <b|world> [x y] [k c] - Connect bodies");
+        output.push_back("joint chain <n> <x> <y> [spacing]|clear - Hang a chain / remove joints");
+        output.push_back("telemetry [start <file> [pve] [compress]|stop] - Record body state");
+        output.push_back("bench <name> [count] - Run a benchmark (bench list)");
+        output.push_back("load <file> | save <file> - Add bodies from / write bodies to a scene file");
+        output.push_back("scenario rain <n> <every s> [times]|impulse <i> <after s> <ix> <iy>|bounce <i> [speed]|stop [id]");
+        output.push_back("alloc [strict on|off] - Allocations per subsystem (PHYSICS_TRACK_ALLOCATIONS builds)");
+        output.push_back("help - Show this help");
+        output.push_back("Press ESC to close chat");
     } else if (command == "list") {
         // List all bodies in the world
         int idx = 0;
-        for (const auto& body : world->bodies) {
-            chatLines.push_back("Body " + std::to_string(idx++));
+        for (const auto& body : world.bodies) {
+            output.push_back("Body " + std::to_string(idx++) + (body->IsDynamic() ? "" : " (kinematic)"));
         }
-        if (idx == 0) chatLines.push_back("No bodies in world.");
+        if (idx == 0) output.push_back("No bodies in world.");
+        if (!world.staticBodies.empty())
+            output.push_back(std::to_string(world.staticBodies.size()) + " static bodies");
     } else if (command == "add") {
         // Parse arguments: add [x] [y] [vx] [vy] [fx] [fy] (all optional)
-        double x = 100 + 20 * (int)world->bodies.size();
+        double x = 100 + 20 * (int)world.bodies.size();
         double y = 200, vx = 0, vy = 0, fx = 0, fy = 0;
         if (iss >> x) {
             if (iss >> y) {
@@ -242,17 +382,44 @@ void Debugger::ProcessCommand(const std::string& cmd)
                 }
             }
         }
-        world->AddBody(x, y, vx, vy, fx, fy, new Circle(20));
-        chatLines.push_back("Added a new circle body at (" + std::to_string(x) + ", " + std::to_string(y) + ")");
+        world.AddBody(x, y, vx, vy, fx, fy, new Circle(20));
+        output.push_back("Added a new circle body at (" + std::to_string(x) + ", " + std::to_string(y) + ")");
+    } else if (command == "kinematic") {
+        // Scripted body: keeps its velocity, pushes but is never pushed
+        double x, y, vx, vy, r = 20;
+        if (iss >> x >> y >> vx >> vy) {
+            iss >> r;
+            world.AddKinematicBody(x, y, vx, vy, new Circle((float)r));
+            output.push_back("Added kinematic body " + std::to_string(world.bodies.size() - 1));
+        } else {
+            output.push_back("Usage: kinematic <x> <y> <vx> <vy> [r]");
+        }
+    } else if (command == "static") {
+        // Level geometry: an axis-aligned box centered on (x, y)
+        double x, y, w, h;
+        if (iss >> x >> y >> w >> h && w > 0 && h > 0) {
+            std::vector<Vector<Real>> corners(4, Vector<Real>(2));
+            corners[0].set(-w / 2, -h / 2);
+            corners[1].set(w / 2, -h / 2);
+            corners[2].set(w / 2, h / 2);
+            corners[3].set(-w / 2, h / 2);
+            world.AddStaticBody(x, y, new ConvexPolygon(corners));
+            output.push_back("Added static box " + std::to_string(world.staticBodies.size() - 1));
+        } else {
+            output.push_back("Usage: static <x> <y> <w> <h>");
+        }
     } else if (command == "set") {
         // Set a property of a body by index
         int idx;
         std::string prop;
         double value;
         if (iss >> idx >> prop >> value) {
-            auto it = world->bodies.begin();
-            std::advance(it, idx);
-            if (it != world->bodies.end()) {
+            auto it = world.bodies.end();
+            if (idx >= 0 && idx < (int)world.bodies.size()) {
+                it = world.bodies.begin();
+                std::advance(it, idx);
+            }
+            if (it != world.bodies.end()) {
                 Body* body = it->get();
                 if (prop == "x") setVec2Component(body->position, 0, value);
                 else if (prop == "y") setVec2Component(body->position, 1, value);
@@ -260,26 +427,408 @@ void Debugger::ProcessCommand(const std::string& cmd)
                 else if (prop == "vy") setVec2Component(body->velocity, 1, value);
                 else if (prop == "fx") setVec2Component(body->force, 0, value);
                 else if (prop == "fy") setVec2Component(body->force, 1, value);
-                else if (prop == "mass") body->mass = value;
+                else if (prop == "mass") body->SetMass(value);
                 else if (prop == "inertia") body->inertia = value;
                 else if (prop == "friction") body->coeff_friction = value;
                 else if (prop == "restitution") body->coeff_restitution = value;
+                else if (prop == "category") body->category = (uint32_t)value;
                 else {
-                    chatLines.push_back("Unknown property: " + prop);
+                    output.push_back("Unknown property: " + prop);
                     return;
                 }
-                chatLines.push_back("Set body " + std::to_string(idx) + " " + prop + " to " + std::to_string(value));
+                world.InvalidateSpatialIndex(); // The body may have moved
+                output.push_back("Set body " + std::to_string(idx) + " " + prop + " to " + std::to_string(value));
             } else {
-                chatLines.push_back("Body index out of range");
+                output.push_back("Body index out of range");
             }
         } else {
-            chatLines.push_back("Usage: set <index> <property> <value>");
+            output.push_back("Usage: set <index> <property> <value>");
+        }
+    } else if (command == "find") {
+        // Radius query through the spatial index
+        double x, y, r;
+        if (iss >> x >> y >> r) {
+            std::vector<size_t> found, foundStatic;
+            world.QueryRadius(x, y, r, found);
+            world.QueryStaticRadius(x, y, r, foundStatic);
+            std::sort(found.begin(), found.end());
+            std::sort(foundStatic.begin(), foundStatic.end());
+            std::string line = std::to_string(found.size()) + " bodies:";
+            for (size_t i = 0; i < found.size() && i < 20; ++i)
+                line += " " + std::to_string(found[i]);
+            if (found.size() > 20) line += " ...";
+            output.push_back(line);
+            if (!foundStatic.empty())
+                output.push_back(std::to_string(foundStatic.size()) + " static bodies, first " + std::to_string(foundStatic[0]));
+        } else {
+            output.push_back("Usage: find <x> <y> <r>");
+        }
+    } else if (command == "ray") {
+        // Single raycast through the spatial index
+        RayQuery ray = { 0, 0, 0, 0, 1e9 };
+        if (iss >> ray.originX >> ray.originY >> ray.directionX >> ray.directionY) {
+            iss >> ray.maxDistance;
+            RayHit hit;
+            world.Raycast(&ray, &hit, 1);
+            if (hit.hit) output.push_back(std::string(hit.staticBody ? "Hit static body " : "Hit body ") + std::to_string(hit.body) + " at distance " + std::to_string(hit.distance));
+            else output.push_back("No hit");
+        } else {
+            output.push_back("Usage: ray <x> <y> <dx> <dy> [max]");
+        }
+    } else if (command == "gravity") {
+        // Configure Barnes-Hut mutual gravity
+        GravitySolver& gravity = world.mutualGravity;
+        std::string option;
+        double value;
+        iss >> option;
+        if (option == "on") gravity.enabled = true;
+        else if (option == "off") gravity.enabled = false;
+        else if (option == "theta" && iss >> value) gravity.theta = value;
+        else if (option == "g" && iss >> value) gravity.gravitationalConstant = value;
+        else if (option == "soft" && iss >> value) gravity.softening = value;
+        else if (!option.empty()) {
+            output.push_back("Usage: gravity on|off|theta <v>|g <v>|soft <v>");
+            return;
+        }
+        output.push_back(std::string("Gravity ") + (gravity.enabled ? "on" : "off") +
+            ", theta " + std::to_string(gravity.theta) + ", G " + std::to_string(gravity.gravitationalConstant) +
+            ", softening " + std::to_string(gravity.softening));
+    } else if (command == "broadphase") {
+        // Toggle the sweep-and-prune broad phase and show its last step
+        SweepAndPrune& broadPhase = world.broadPhase;
+        std::string option;
+        iss >> option;
+        if (option == "on") broadPhase.enabled = true;
+        else if (option == "off") {
+            broadPhase.enabled = false;
+            broadPhase.Reset();
+        } else if (!option.empty()) {
+            output.push_back("Usage: broadphase [on|off]");
+            return;
+        }
+        output.push_back(std::string("Broad phase ") + (broadPhase.enabled ? "on" : "off") + ", " +
+            std::to_string(broadPhase.GetPairCount()) + " pairs, " +
+            std::to_string(broadPhase.GetSwapCount()) + " swaps last step");
+    } else if (command == "contacts") {
+        // Toggle contact events and show the last step's batches, optionally filtered
+        ContactStream& contacts = world.contacts;
+        std::string option;
+        uint32_t mask = ~0u;
+        const Body* filterBody = nullptr;
+        while (iss >> option)
+        {
+            std::string bits;
+            int index = -1;
+            if (option == "on") contacts.enabled = true;
+            else if (option == "off") contacts.enabled = false;
+            else if (option == "mask" && iss >> bits) mask = (uint32_t)std::strtoul(bits.c_str(), nullptr, 0); // 0x.. for hex
+            else if (option == "body" && iss >> index && (filterBody = world.GetBody(index))) {}
+            else {
+                output.push_back("Usage: contacts [on|off] [mask <bits>] [body <i>]");
+                return;
+            }
+        }
+        output.push_back(std::string("Contacts ") + (contacts.enabled ? "on" : "off") + ", " +
+            std::to_string(contacts.GetContactCount()) + " touching of " + std::to_string(contacts.GetTestedCount()) + " pairs tested");
+        const char* names[3] = { "begin", "persist", "end" };
+        std::vector<const ContactEvent*> selected;
+        for (int phase = 0; phase < 3; ++phase)
+        {
+            selected.clear();
+            contacts.Select((ContactPhase)phase, filterBody, mask, selected);
+            std::string line = std::string(names[phase]) + ": " + std::to_string(selected.size());
+            for (size_t i = 0; i < selected.size() && i < 5; ++i)
+            {
+                uint32_t indexB = selected[i]->indexB;
+                std::string other = indexB & ContactEvent::StaticBit
+                    ? "s" + std::to_string(indexB & ~ContactEvent::StaticBit) // Static body, as listed by 'static'
+                    : std::to_string(indexB);
+                line += " (" + std::to_string(selected[i]->indexA) + "," + other + ")";
+            }
+            if (selected.size() > 5) line += " ...";
+            output.push_back(line);
+        }
+    } else if (command == "integrator") {
+        // Show or switch the scheme that advances bodies
+        std::string option;
+        IntegratorType type;
+        if (iss >> option) {
+            if (!Integrator::Parse(option, type)) {
+                output.push_back("Usage: integrator [euler|verlet|rk4]");
+                return;
+            }
+            world.SetIntegrator(type);
+        }
+        output.push_back(std::string("Integrator ") + Integrator::Name(world.GetIntegratorType()));
+    } else if (command == "substeps") {
+        // Toggle adaptive substepping and show the last plan
+        IslandSubstepper& substepper = world.substepper;
+        std::string option;
+        int maxSubsteps = 0;
+        iss >> option;
+        if (option == "on") substepper.enabled = true;
+        else if (option == "off") substepper.enabled = false;
+        else if (!option.empty()) {
+            output.push_back("Usage: substeps [on|off] [max]");
+            return;
+        }
+        if (iss >> maxSubsteps && maxSubsteps > 0)
+            substepper.maxSubsteps = maxSubsteps;
+        output.push_back(std::string("Substepping ") + (substepper.enabled ? "on" : "off") + ", up to " +
+            std::to_string(substepper.maxSubsteps) + ", " + std::to_string(substepper.GetIslandCount()) + " islands, " +
+            std::to_string(substepper.GetSubsteppedCount()) + " bodies substepped last step");
+    } else if (command == "particles") {
+        // Manage the point particle system
+        ParticleSystem& particles = world.particles;
+        std::string option;
+        iss >> option;
+        float x = 0, y = 0, amount = 0, speed = 50, life = 0;
+        if (option == "emit" && iss >> x >> y >> amount && IsCreateCount(amount)) {
+            iss >> speed >> life;
+            particles.Emit(x, y, (size_t)amount, speed, life);
+        } else if (option == "emitter" && iss >> x >> y >> amount && amount >= 0 && amount <= MaxCreateCount) {
+            iss >> speed >> life;
+            ParticleEmitter emitter;
+            emitter.x = x; emitter.y = y; emitter.rate = amount;
+            emitter.speed = speed; emitter.lifetime = life;
+            particles.emitters.push_back(emitter);
+        } else if (option == "gravity" && iss >> x >> y) {
+            particles.gravityX = x;
+            particles.gravityY = y;
+        } else if (option == "clear") {
+            particles.Clear();
+        } else if (!option.empty()) {
+            output.push_back("Usage: particles [emit x y n [speed life]|emitter x y rate [speed life]|gravity gx gy|clear]");
+            return;
+        }
+        output.push_back(std::to_string(particles.Count()) + " particles, " +
+            std::to_string(particles.emitters.size()) + " emitters");
+    } else if (command == "soft") {
+        // Mass-spring soft bodies
+        SoftBodySystem& soft = world.softBodies;
+        std::string option, pin;
+        iss >> option;
+        float x = 0, y = 0, spacing = 10, k = 500, c = 2;
+        int columns = 0, rows = 0;
+        bool valid = true;
+        if (option == "lattice" && iss >> x >> y >> columns >> rows && IsCreateCount((double)columns * rows)) {
+            iss >> spacing >> k >> c >> pin;
+            valid = soft.AddLattice(x, y, columns, rows, spacing, 1.0f, k, c, pin == "pin") >= 0;
+        } else if (option == "gravity" && iss >> x >> y) {
+            soft.gravityX = x;
+            soft.gravityY = y;
+        } else if (option == "floor" && iss >> y) {
+            soft.floorY = y;
+        } else if (option == "clear") {
+            soft.Clear();
+        } else {
+            valid = option.empty();
+        }
+        if (!valid) {
+            output.push_back("Usage: soft [lattice x y cols rows [spacing k c] [pin]|gravity gx gy|floor y|clear]");
+            return;
+        }
+        output.push_back(std::to_string(soft.bodies.size()) + " soft bodies, " + std::to_string(soft.PointCount()) +
+            " points, " + std::to_string(soft.SpringCount()) + " springs, " + std::to_string(soft.GetSubsteps()) + " substeps last step");
+    } else if (command == "fluid") {
+        // SPH liquid
+        FluidSystem& fluid = world.fluid;
+        std::string option;
+        iss >> option;
+        float x = 0, y = 0, x1 = 0, y1 = 0;
+        int columns = 0, rows = 0;
+        bool valid = true;
+        if (option == "block" && iss >> x >> y >> columns >> rows && columns > 0 && IsCreateCount((double)columns * rows)) {
+            fluid.AddBlock(x, y, columns, rows);
+        } else if (option == "box" && iss >> x >> y >> x1 >> y1 && x < x1 && y < y1) {
+            fluid.minX = x; fluid.minY = y;
+            fluid.maxX = x1; fluid.maxY = y1;
+        } else if (option == "gravity" && iss >> x >> y) {
+            fluid.gravityX = x;
+            fluid.gravityY = y;
+        } else if (option == "clear") {
+            fluid.Clear();
+        } else {
+            valid = option.empty();
+        }
+        if (!valid) {
+            output.push_back("Usage: fluid [block x y cols rows|box x0 y0 x1 y1|gravity gx gy|clear]");
+            return;
+        }
+        output.push_back(std::to_string(fluid.Count()) + " fluid particles, " +
+            std::to_string(fluid.GetSubsteps()) + " substeps last step");
+    } else if (command == "joint") {
+        // Connect bodies with joints
+        JointSolver& joints = world.joints;
+        std::string type, second;
+        iss >> type;
+        if (type == "clear") {
+            joints.Clear();
+        } else if (type == "chain") {
+            double links = 0, x = 0, y = 0, spacing = 12;
+            if (!(iss >> links >> x >> y) || !IsCreateCount(links)) {
+                output.push_back("Usage: joint chain <n> <x> <y> [spacing]");
+                return;
+            }
+            iss >> spacing;
+            Body* previous = nullptr;
+            for (size_t i = 0; i < (size_t)links; ++i) {
+                double cx = x + spacing * (i + 0.5);
+                world.AddBody(cx, y, 0, 0, 0, 0, new Circle((float)(spacing * 0.4)));
+                Body* link = world.bodies.back().get();
+                link->gravity.set(0, 200); // Let the chain hang
+                joints.AddRevolute(link, previous, cx - spacing * 0.5, y);
+                previous = link;
+            }
+        } else if (type == "distance" || type == "spring" || type == "revolute" || type == "weld") {
+            size_t a = 0;
+            if (!(iss >> a >> second)) {
+                output.push_back("Usage: joint " + type + " <a> <b|world> [x y] [k c]");
+                return;
+            }
+            std::vector<double> args;
+            for (double value; iss >> value; ) args.push_back(value);
+            Body* bodyA = world.GetBody(a);
+            Body* bodyB = second == "world" ? nullptr : world.GetBody(std::strtoul(second.c_str(), nullptr, 10));
+            bool pinned = type == "revolute" || type == "weld";
+            size_t points = (bodyB && !pinned) ? 0 : 2; // x y is the pin or the world point
+            if (!bodyA || (second != "world" && !bodyB) || bodyA == bodyB ||
+                (args.size() < points && !(pinned && bodyB)) || (type == "spring" && args.size() < points + 2)) {
+                output.push_back("Usage: joint " + type + " <a> <b|world> [x y] [k c]");
+                return;
+            }
+            double ax = double(bodyA->position.x), ay = double(bodyA->position.y);
+            double bx = bodyB ? double(bodyB->position.x) : 0, by = bodyB ? double(bodyB->position.y) : 0;
+            if (pinned && args.size() < 2) { args.assign({ (ax + bx) / 2, (ay + by) / 2 }); points = 2; }
+            if (points == 2) { bx = args[0]; by = args[1]; }
+            if (type == "distance") joints.AddDistance(bodyA, bodyB, ax, ay, bx, by);
+            else if (type == "spring") joints.AddSpring(bodyA, bodyB, ax, ay, bx, by, args[points], args[points + 1]);
+            else if (type == "revolute") joints.AddRevolute(bodyA, bodyB, bx, by);
+            else joints.AddWeld(bodyA, bodyB, bx, by);
+        } else if (!type.empty()) {
+            output.push_back("Usage: joint distance|spring|revolute|weld <a> <b|world> [x y] [k c] | chain <n> <x> <y> [spacing] | clear");
+            return;
+        }
+        output.push_back(std::to_string(joints.GetJoints().size()) + " joints");
+    } else if (command == "telemetry") {
+        // Start/stop the background telemetry writer
+        std::string option, path, fieldNames, mode;
+        iss >> option;
+        if (option == "start" && iss >> path) {
+            iss >> fieldNames >> mode;
+            unsigned fields = 0;
+            if (fieldNames.empty()) fieldNames = "pve";
+            if (fieldNames.find('p') != std::string::npos) fields |= TelemetryRecorder::Position;
+            if (fieldNames.find('v') != std::string::npos) fields |= TelemetryRecorder::Velocity;
+            if (fieldNames.find('e') != std::string::npos) fields |= TelemetryRecorder::Energy;
+            if (!world.telemetry) world.telemetry = std::make_unique<TelemetryRecorder>();
+            if (world.telemetry->Start(path, fields, mode == "compress", world.bodies.size()))
+                output.push_back("Recording telemetry to " + path);
+            else
+                output.push_back("Could not open " + path);
+        } else if (option == "stop") {
+            if (world.telemetry) world.telemetry->Stop();
+            output.push_back("Telemetry stopped");
+        } else if (!option.empty()) {
+            output.push_back("Usage: telemetry [start <file> [pve] [compress]|stop]");
+            return;
+        }
+        if (world.telemetry)
+            output.push_back(std::to_string(world.telemetry->Recorded()) + " records, " +
+                std::to_string(world.telemetry->Dropped()) + " dropped, " +
+                std::to_string(world.telemetry->BytesWritten()) + " bytes" +
+                (world.telemetry->OversizedSteps() ? ", " + std::to_string(world.telemetry->OversizedSteps()) +
+                    " steps larger than the ring (restart telemetry)" : ""));
+    } else if (command == "load" || command == "save") {
+        // Scene files
+        std::string path;
+        if (!(iss >> path)) {
+            output.push_back("Usage: " + command + " <file>");
+            return;
+        }
+        std::string error;
+        size_t before = world.bodies.size() + world.staticBodies.size();
+        if (command == "save")
+            output.push_back(SceneFile::Save(world, path) ? "Saved " + std::to_string(before) + " bodies to " + path : "Cannot write " + path);
+        else if (SceneFile::Load(world, path, error, world.threadPool))
+            output.push_back("Loaded " + std::to_string(world.bodies.size() + world.staticBodies.size() - before) + " bodies");
+        else
+            output.push_back(error);
+    } else if (command == "scenario") {
+        // Start or stop scripted scenarios
+        ScenarioScheduler& scenarios = world.scenarios;
+        std::string option;
+        iss >> option;
+        uint64_t id = 0;
+        bool valid = true;
+        if (option == "rain") {
+            int count = 0, bursts = 0;
+            double interval = 0;
+            valid = iss >> count >> interval && count > 0 && interval > 0;
+            if (valid) {
+                iss >> bursts;
+                id = scenarios.Start(RainScenario(world, count, interval, bursts));
+            }
+        } else if (option == "impulse") {
+            size_t index = 0;
+            double delay = 0, impulseX = 0, impulseY = 0;
+            valid = (bool)(iss >> index >> delay >> impulseX >> impulseY);
+            if (valid) id = scenarios.Start(ImpulseScenario(world, index, delay, impulseX, impulseY));
+        } else if (option == "bounce") {
+            size_t index = 0;
+            double speed = 300;
+            Body* body = (iss >> index) ? world.GetBody(index) : nullptr;
+            valid = body != nullptr;
+            if (valid) {
+                iss >> speed;
+                world.broadPhase.enabled = true; // Contacts come from the broad phase
+                id = scenarios.Start(BounceScenario(body, speed));
+            }
+        } else if (option == "stop") {
+            uint64_t stopId = 0;
+            if (iss >> stopId)
+                output.push_back(scenarios.Stop(stopId) ? "Stopped scenario " + std::to_string(stopId) : "No scenario " + std::to_string(stopId));
+            else
+                scenarios.StopAll();
+        } else {
+            valid = option.empty();
+        }
+        if (!valid) {
+            output.push_back("Usage: scenario rain <n> <every s> [times]|impulse <i> <after s> <ix> <iy>|bounce <i> [speed]|stop [id]");
+            return;
+        }
+        if (id) output.push_back("Started scenario " + std::to_string(id));
+        output.push_back(std::to_string(scenarios.GetRunningCount()) + " scenarios running, " +
+            std::to_string(scenarios.GetContactWaitCount()) + " waiting for contact");
+    } else if (command == "bench") {
+        // Run a headless benchmark
+        std::string name;
+        size_t count = 0;
+        iss >> name >> count;
+        size_t reported = output.size();
+        if (!RunBenchmark(name, count, output) && output.size() == reported)
+            output.push_back("Unknown benchmark: " + name + " (try 'bench list')");
+    } else if (command == "alloc") {
+        // Allocation totals since start, and strict mode
+        std::string option, state;
+        iss >> option >> state;
+        if (option == "strict" && (state == "on" || state == "off"))
+            AllocationTracker::SetStrict(state == "on");
+        else if (!option.empty()) {
+            output.push_back("Usage: alloc [strict on|off]");
+            return;
         }
+        if (!AllocationTracker::Enabled)
+            output.push_back("Allocation tracking is off in this build (define PHYSICS_TRACK_ALLOCATIONS)");
+        AllocationCounters totals = AllocationTracker::Read();
+        std::string line;
+        for (size_t i = 0; i < AllocationSubsystemCount; ++i)
+            line += std::string(i ? ", " : "") + AllocationTracker::Name((AllocationSubsystem)i) + " " +
+                std::to_string(totals.count[i]) + " (" + std::to_string(totals.bytes[i] / 1024) + " KB)";
+        output.push_back(line);
+        output.push_back(std::string("Strict mode ") + (AllocationTracker::IsStrict() ? "on" : "off"));
     } else {
         // Unknown command
-        chatLines.push_back("Unknown command: " + cmd);
+        output.push_back("Unknown command: " + cmd);
     }
-    // Keep more history for scrolling
-    while (chatLines.size() > 50) chatLines.pop_front();
-    chatScrollOffset = 0; // Reset scroll to bottom on new command
 }
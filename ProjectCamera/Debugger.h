@@ -1,24 +1,25 @@
 #pragma once
 #include "Body.h"
 #include "World.h"
-#include "globals.h" // Use renderer and window from here
+#include "globals.h"
 #include"Properties.h"
+#include "Simulation.h"
+#include "AllocationTracker.h"
 #include <string>
 #include <vector>
 #include <deque>
+#include <mutex>
 #include <SDL3/SDL.h>
 #include <SDL3_ttf/SDL_ttf.h>
 
-extern SDL_Renderer* renderer;
-extern TTF_Font* gFont;
-
 class Debugger
 {
 public:
-    Debugger(World* world);
+    // Draws with the given renderer and font; text input is started and stopped on window
+    Debugger(Simulation* simulation, SDL_Renderer* renderer, SDL_Window* window, TTF_Font* font);
 
-    // Call this every frame to handle input and render the chat/debug window
-    void Update();
+    // Call this every frame to handle input and render the chat/debug window from the latest snapshot
+    void Update(const RenderSnapshot& snapshot);
 
     // Call this to process SDL events (for text input)
     void HandleEvent(const SDL_Event& e);
@@ -34,17 +35,35 @@ public:
     Properties* GetPropertiesWindow() const {
         return propertiesWindow;
     }
+
+    // Run a command against the world and collect its output lines (simulation thread only)
+    static void ExecuteCommand(World& world, const std::string& cmd, std::vector<std::string>& output);
 private:
-    World* world;
+    Simulation* simulation;
+    SDL_Renderer* renderer;            // Target for the chat and properties overlay
+    SDL_Window* window;                // Window receiving text input
+    TTF_Font* font;                    // Font for all overlay text (may be null)
+
+    std::mutex replyMutex;             // Guards replyLines
+    std::vector<std::string> replyLines; // Output produced on the simulation thread, not yet shown
 
     std::string inputBuffer;           // Current command being typed
     std::deque<std::string> chatLines; // Output lines to display
     bool inputActive = false;          // Is the input box active?
+    bool chatVisible = true;           // Is the chat window shown at all?
+    int chatScrollOffset = 0;          // How many lines up from the bottom the chat is scrolled
+
+    AllocationCounters lastAllocations; // Tracker totals at the previous frame
+    int settledFrames = 0;             // Frames since commands last allocated (world changes settle first)
+    uint64_t strictViolations = 0;     // Settled frames in which World::Update allocated (strict mode)
 
     // Helper to render the chat window at the bottom
-    void RenderChatWindow();
+    void RenderChatWindow(const RenderSnapshot& snapshot);
+
+    // Helper to render this frame's allocations per subsystem at the top of the screen (tracking builds)
+    void RenderAllocations();
 
-    // Helper to process a command
+    // Helper to queue a command for the next simulation step
     void ProcessCommand(const std::string& cmd);
 
     // Helper to get all body names from the world
@@ -0,0 +1,182 @@
+// Fixed.cpp
+// Q32.32 multiply, divide, square root and CORDIC trigonometry with bit-exact integer results.
+#include "Fixed.h"
+#include <algorithm>
+#include <cmath>
+#if defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Unsigned 64x64 -> 128 product as (high, low) halves.
+static void MultiplyWide(uint64_t a, uint64_t b, uint64_t& high, uint64_t& low)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)a * b;
+    high = (uint64_t)(product >> 64);
+    low = (uint64_t)product;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    low = _umul128(a, b, &high);
+#else
+    uint64_t aLow = a & 0xffffffffu, aHigh = a >> 32;
+    uint64_t bLow = b & 0xffffffffu, bHigh = b >> 32;
+    uint64_t ll = aLow * bLow, lh = aLow * bHigh, hl = aHigh * bLow, hh = aHigh * bHigh;
+    uint64_t middle = (ll >> 32) + (lh & 0xffffffffu) + (hl & 0xffffffffu);
+    low = (middle << 32) | (ll & 0xffffffffu);
+    high = hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+#endif
+}
+
+int64_t Fixed::Multiply(int64_t a, int64_t b)
+{
+    // Signed product from the unsigned one: subtract b << 64 if a < 0 and a << 64 if b < 0
+    uint64_t high, low;
+    MultiplyWide((uint64_t)a, (uint64_t)b, high, low);
+    if (a < 0) high -= (uint64_t)b;
+    if (b < 0) high -= (uint64_t)a;
+    // Bits 32..95 of the two's complement product = arithmetic shift right by 32
+    return (int64_t)((high << 32) | (low >> 32));
+}
+
+int64_t Fixed::Divide(int64_t a, int64_t b)
+{
+    if (b == 0)
+        return a < 0 ? INT64_MIN : INT64_MAX;
+    bool negative = (a < 0) != (b < 0);
+    uint64_t numerator = a < 0 ? 0 - (uint64_t)a : (uint64_t)a;
+    uint64_t denominator = b < 0 ? 0 - (uint64_t)b : (uint64_t)b;
+    uint64_t quotient = 0;
+    bool overflow = false;
+    if ((numerator >> 32) == 0) {
+        quotient = (numerator << 32) / denominator; // |a| < 1: the shifted numerator fits in 64 bits
+    } else {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 wide = ((unsigned __int128)numerator << 32) / denominator;
+        overflow = (wide >> 64) != 0;
+        quotient = (uint64_t)wide;
+#elif defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+        uint64_t high = numerator >> 32, low = numerator << 32, remainder;
+        overflow = high >= denominator; // the quotient would not fit in 64 bits
+        if (!overflow) quotient = _udiv128(high, low, denominator, &remainder);
+#else
+        // Long division of numerator << 32 (a 96-bit value) by the denominator, one bit at a time
+        uint64_t high = numerator >> 32, low = numerator << 32;
+        uint64_t remainder = 0;
+        for (int bit = 95; bit >= 0; --bit)
+        {
+            bool carry = (remainder >> 63) != 0;
+            uint64_t next = bit >= 64 ? (high >> (bit - 64)) & 1 : (low >> bit) & 1;
+            remainder = (remainder << 1) | next;
+            overflow |= (quotient >> 63) != 0;
+            quotient <<= 1;
+            if (carry || remainder >= denominator) {
+                remainder -= denominator;
+                quotient |= 1;
+            }
+        }
+#endif
+    }
+    if (overflow || quotient > (uint64_t)INT64_MAX)
+        return negative ? INT64_MIN : INT64_MAX; // Saturate results outside the format
+    return negative ? -(int64_t)quotient : (int64_t)quotient;
+}
+
+Fixed sqrt(Fixed x)
+{
+    if (x.Raw() <= 0) return Fixed();
+    // Result r (raw) is the largest integer with r * r <= raw << 32. A double estimate lands
+    // within a step or two of it and the integer correction below makes it exact, so the
+    // answer does not depend on the floating-point unit.
+    const uint64_t targetHigh = (uint64_t)x.Raw() >> 32, targetLow = (uint64_t)x.Raw() << 32;
+    auto squareAtMost = [&](uint64_t r) {
+        uint64_t high, low;
+        MultiplyWide(r, r, high, low);
+        return high < targetHigh || (high == targetHigh && low <= targetLow);
+    };
+    uint64_t result = (uint64_t)std::sqrt((double)x.Raw() * 4294967296.0);
+    if (result > 0xffffffffffffull) result = 0xffffffffffffull; // sqrt of the largest raw value is below 2^48
+    while (result > 0 && !squareAtMost(result)) --result;
+    while (squareAtMost(result + 1)) ++result;
+    return Fixed::FromRaw((int64_t)result);
+}
+
+// atan(2^-i) in Q32.32
+static const int64_t CordicAngles[32] = {
+    3373259426, 1991351318, 1052175346, 534100635, 268086748, 134174063, 67103403, 33553749,
+    16777131, 8388597, 4194303, 2097152, 1048576, 524288, 262144, 131072,
+    65536, 32768, 16384, 8192, 4096, 2048, 1024, 512, 256, 128, 64, 32, 16, 8, 4, 2 };
+static const int64_t CordicGain = 2608131496;  // Product of 1 / sqrt(1 + 2^-2i), Q32.32
+static const int64_t Pi = 13493037705;         // Q32.32
+static const int64_t HalfPi = 6746518852;
+static const int64_t TwoPi = 26986075409;
+
+void sincos(Fixed angle, Fixed& s, Fixed& c)
+{
+    // Reduce to (-pi, pi], then fold into [-pi/2, pi/2] where CORDIC converges
+    int64_t z = angle.Raw() % TwoPi;
+    if (z > Pi) z -= TwoPi;
+    else if (z <= -Pi) z += TwoPi;
+    bool flip = false;
+    if (z > HalfPi) { z = Pi - z; flip = true; }
+    else if (z < -HalfPi) { z = -Pi - z; flip = true; }
+
+    int64_t x = CordicGain, y = 0;
+    for (int i = 0; i < 32; ++i)
+    {
+        int64_t dx = y >> i, dy = x >> i;
+        if (z >= 0) { x -= dx; y += dy; z -= CordicAngles[i]; }
+        else { x += dx; y -= dy; z += CordicAngles[i]; }
+    }
+    s = Fixed::FromRaw(y);
+    c = Fixed::FromRaw(flip ? -x : x); // Folding mirrors the angle about pi/2, which negates the cosine
+}
+
+Fixed sin(Fixed angle)
+{
+    Fixed s, c;
+    sincos(angle, s, c);
+    return s;
+}
+
+Fixed cos(Fixed angle)
+{
+    Fixed s, c;
+    sincos(angle, s, c);
+    return c;
+}
+
+Fixed atan2(Fixed y, Fixed x)
+{
+    int64_t px = x.Raw(), py = y.Raw();
+    if (px == 0 && py == 0) return Fixed();
+    // Rotate into the right half plane first
+    int64_t z = 0;
+    if (px < 0) {
+        z = py >= 0 ? Pi : -Pi;
+        px = -px;
+        py = -py;
+    }
+    // Scale down so the CORDIC growth (about 1.65x) cannot overflow
+    while (px > (INT64_MAX >> 2) || py > (INT64_MAX >> 2) || py < -(INT64_MAX >> 2)) {
+        px >>= 1;
+        py >>= 1;
+    }
+    for (int i = 0; i < 32; ++i)
+    {
+        int64_t dx = py >> i, dy = px >> i;
+        if (py > 0) { px += dx; py -= dy; z += CordicAngles[i]; }
+        else { px -= dx; py += dy; z -= CordicAngles[i]; }
+    }
+    if (z > Pi) z -= TwoPi;
+    else if (z <= -Pi) z += TwoPi;
+    return Fixed::FromRaw(z);
+}
+
+Fixed hypot(Fixed x, Fixed y)
+{
+    // Scale the larger component to 1 so the squares stay in range
+    Fixed ax = fabs(x), ay = fabs(y);
+    Fixed large = std::max(ax, ay), small = std::min(ax, ay);
+    if (large.Raw() == 0) return Fixed();
+    Fixed ratio = small / large;
+    return large * sqrt(Fixed(1) + ratio * ratio);
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @class Fixed
+ * @brief Q32.32 fixed-point scalar with bit-exact arithmetic on every CPU and compiler.
+ *
+ * The value is a 64-bit integer counting 2^-32 units: range about +-2.1e9, resolution
+ * about 2.3e-10. Products and quotients go through a 128-bit intermediate; products round
+ * toward negative infinity and quotients toward zero, the same on every platform whether
+ * or not the compiler has a native 128-bit type. Sqrt is an exact integer square root and
+ * sin, cos and atan2 use CORDIC with a fixed table, so nothing depends on the platform's
+ * floating-point library. Conversions from double are exact for values the format can
+ * hold, so a world built from the same inputs steps identically everywhere.
+ */
+class Fixed
+{
+public:
+    static constexpr int FractionBits = 32;
+    static constexpr int64_t One = int64_t(1) << FractionBits;
+
+    constexpr Fixed() = default;
+    constexpr Fixed(int value) : raw(int64_t(value) * One) {}
+    /// Rounds to the nearest representable value (ties away from zero); saturates outside the range, NaN gives 0
+    constexpr Fixed(double value) : raw(RawFromDouble(value)) {}
+
+    /// Wrap a raw Q32.32 integer
+    static constexpr Fixed FromRaw(int64_t raw) { Fixed f; f.raw = raw; return f; }
+    constexpr int64_t Raw() const { return raw; }
+
+    explicit constexpr operator double() const { return double(raw) / double(One); }
+    explicit constexpr operator float() const { return float(double(*this)); }
+    explicit constexpr operator int() const { return int(raw >> FractionBits); }
+
+    // Binary operators are friends so an int or double on either side converts to Fixed
+    constexpr Fixed operator-() const { return FromRaw(-raw); }
+    friend constexpr Fixed operator+(Fixed a, Fixed b) { return FromRaw(a.raw + b.raw); }
+    friend constexpr Fixed operator-(Fixed a, Fixed b) { return FromRaw(a.raw - b.raw); }
+    friend Fixed operator*(Fixed a, Fixed b) { return FromRaw(Multiply(a.raw, b.raw)); }
+    friend Fixed operator/(Fixed a, Fixed b) { return FromRaw(Divide(a.raw, b.raw)); }
+    Fixed& operator+=(Fixed b) { raw += b.raw; return *this; }
+    Fixed& operator-=(Fixed b) { raw -= b.raw; return *this; }
+    Fixed& operator*=(Fixed b) { raw = Multiply(raw, b.raw); return *this; }
+    Fixed& operator/=(Fixed b) { raw = Divide(raw, b.raw); return *this; }
+
+    friend constexpr bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+    friend constexpr bool operator!=(Fixed a, Fixed b) { return a.raw != b.raw; }
+    friend constexpr bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+    friend constexpr bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+    friend constexpr bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+    friend constexpr bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+
+    /**
+     * @brief (a * b) >> 32 with a 128-bit intermediate, rounded toward negative infinity.
+     */
+    static int64_t Multiply(int64_t a, int64_t b);
+
+    /**
+     * @brief (a << 32) / b with a 128-bit intermediate, truncated toward zero; saturates on division by zero.
+     */
+    static int64_t Divide(int64_t a, int64_t b);
+
+private:
+    // Raw value of a double, clamped before the conversion so no input is undefined behavior.
+    static constexpr int64_t RawFromDouble(double value)
+    {
+        constexpr double Limit = 9223372036854775808.0; // 2^63, the first scaled value that does not fit
+        double scaled = value * double(One);
+        if (scaled != scaled) return 0;
+        if (scaled >= Limit) return INT64_MAX;
+        if (scaled <= -Limit) return INT64_MIN;
+        return int64_t(scaled + (scaled < 0 ? -0.5 : 0.5));
+    }
+
+    int64_t raw = 0;
+};
+
+// Math on Fixed lives next to the class, where argument-dependent lookup finds it. Engine code calls
+// these unqualified on Real; globals.h brings the float and double overloads from <cmath> into scope.
+
+/**
+ * @brief Exact square root (largest representable value whose square does not exceed x); 0 for x <= 0.
+ */
+Fixed sqrt(Fixed x);
+
+/**
+ * @brief Sine by CORDIC after reducing the angle to [-pi/2, pi/2].
+ */
+Fixed sin(Fixed angle);
+
+/**
+ * @brief Cosine by CORDIC after reducing the angle to [-pi/2, pi/2].
+ */
+Fixed cos(Fixed angle);
+
+/**
+ * @brief Angle of (x, y) in (-pi, pi] by CORDIC vectoring.
+ */
+Fixed atan2(Fixed y, Fixed x);
+
+/**
+ * @brief Absolute value.
+ */
+inline Fixed fabs(Fixed x) { return x.Raw() < 0 ? -x : x; }
+inline Fixed abs(Fixed x) { return fabs(x); }
+
+/**
+ * @brief Largest integer value not above x, and smallest not below it.
+ */
+inline Fixed floor(Fixed x) { return Fixed::FromRaw(x.Raw() & ~(Fixed::One - 1)); }
+inline Fixed ceil(Fixed x) { return -floor(-x); }
+
+/**
+ * @brief Length of (x, y) without intermediate overflow for in-range results.
+ */
+Fixed hypot(Fixed x, Fixed y);
+
+/**
+ * @brief Sine and cosine from one CORDIC pass.
+ */
+void sincos(Fixed angle, Fixed& s, Fixed& c);
@@ -0,0 +1,386 @@
+// FluidSystem.cpp
+// SPH liquid: counting-sorted neighbor grid, density, pressure and viscosity passes, and pushing against bodies.
+#include "FluidSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include "globals.h"
+
+// A substep moves no particle, and no pressure wave, further than this fraction of the smoothing radius.
+static constexpr float CourantFactor = 0.4f;
+
+// Shortest distance used for directions, so coincident particles get no pressure push instead of NaN.
+static constexpr float MinDistance = 1e-6f;
+
+// Arrays and constants read and written by the particle passes.
+struct FluidArrays
+{
+    float *px, *py, *vx, *vy;
+    const uint32_t* order;        ///< Particle in each grid slot (unused when the arrays are in grid order)
+    const uint32_t* cellStart;
+    float *density, *pressure, *ax, *ay; ///< Per grid slot
+    int columns, rows;
+    float minX, minY, inverseCell;
+    float h, h2, mass, restDensity, stiffness, viscosity;
+    float poly6, spiky, laplacian; ///< 2D kernel factors: density, pressure gradient and viscosity Laplacian
+};
+
+// Particle stored in a grid slot.
+template <bool Sorted>
+static inline uint32_t Particle(const FluidArrays& f, uint32_t slot)
+{
+    return Sorted ? slot : f.order[slot];
+}
+
+// Call visit(first, end) for the grid slots of the 3 x 3 cells around a position: one contiguous range per row.
+template <typename Visit>
+static inline void ForNeighborRanges(const FluidArrays& f, float x, float y, Visit&& visit)
+{
+    int cx = std::clamp((int)((x - f.minX) * f.inverseCell), 0, f.columns - 1);
+    int cy = std::clamp((int)((y - f.minY) * f.inverseCell), 0, f.rows - 1);
+    int c0 = std::max(cx - 1, 0), c1 = std::min(cx + 1, f.columns - 1);
+    for (int r = std::max(cy - 1, 0); r <= std::min(cy + 1, f.rows - 1); ++r)
+        visit(f.cellStart[r * f.columns + c0], f.cellStart[r * f.columns + c1 + 1]);
+}
+
+// Density (poly6 kernel) and pressure of a range of grid slots; pressure is never negative, so the fluid does not clump.
+template <bool Sorted>
+static void DensityRange(const FluidArrays& f, size_t begin, size_t end)
+{
+    for (size_t k = begin; k < end; ++k)
+    {
+        uint32_t i = Particle<Sorted>(f, (uint32_t)k);
+        float x = f.px[i], y = f.py[i], sum = 0.0f;
+        ForNeighborRanges(f, x, y, [&](uint32_t first, uint32_t last) {
+            for (uint32_t s = first; s < last; ++s)
+            {
+                uint32_t j = Particle<Sorted>(f, s);
+                float dx = f.px[j] - x, dy = f.py[j] - y;
+                float q = std::max(f.h2 - (dx * dx + dy * dy), 0.0f);
+                sum += q * q * q;
+            }
+        });
+        float density = f.mass * f.poly6 * sum;
+        f.density[k] = density;
+        f.pressure[k] = std::max(f.stiffness * (density - f.restDensity), 0.0f);
+    }
+}
+
+// Pressure (spiky gradient) and viscosity acceleration of a range of grid slots.
+template <bool Sorted>
+static void ForceRange(const FluidArrays& f, size_t begin, size_t end)
+{
+    for (size_t k = begin; k < end; ++k)
+    {
+        uint32_t i = Particle<Sorted>(f, (uint32_t)k);
+        float x = f.px[i], y = f.py[i], vx = f.vx[i], vy = f.vy[i], pressure = f.pressure[k];
+        float ax = 0.0f, ay = 0.0f, dragX = 0.0f, dragY = 0.0f;
+        ForNeighborRanges(f, x, y, [&](uint32_t first, uint32_t last) {
+            for (uint32_t s = first; s < last; ++s)
+            {
+                uint32_t j = Particle<Sorted>(f, s);
+                float dx = x - f.px[j], dy = y - f.py[j];
+                float r = std::sqrt(dx * dx + dy * dy);
+                float w = std::max(f.h - r, 0.0f);
+                float inverseDensity = 1.0f / f.density[s];
+                float push = (pressure + f.pressure[s]) * 0.5f * inverseDensity * f.spiky * w * w / std::max(r, MinDistance);
+                float drag = w * inverseDensity;
+                ax += push * dx;
+                ay += push * dy;
+                dragX += drag * (f.vx[j] - vx);
+                dragY += drag * (f.vy[j] - vy);
+            }
+        });
+        // Pressure divides by this particle's density; viscosity is kinematic and already per unit mass
+        float viscous = f.viscosity * f.laplacian * f.mass;
+        f.ax[k] = ax * f.mass / f.density[k] + dragX * viscous;
+        f.ay[k] = ay * f.mass / f.density[k] + dragY * viscous;
+    }
+}
+
+// Symplectic Euler for a range of grid slots, then the container walls (normal velocity into a wall is removed).
+// Returns the squared length of the longest move in the range.
+template <bool Sorted>
+static float IntegrateRange(const FluidArrays& f, size_t begin, size_t end, float gx, float gy, float step,
+    float left, float top, float right, float bottom)
+{
+    float longest = 0.0f;
+    for (size_t k = begin; k < end; ++k)
+    {
+        uint32_t i = Particle<Sorted>(f, (uint32_t)k);
+        const float x = f.px[i], y = f.py[i];
+        f.vx[i] += (gx + f.ax[k]) * step;
+        f.vy[i] += (gy + f.ay[k]) * step;
+        f.px[i] += f.vx[i] * step;
+        f.py[i] += f.vy[i] * step;
+        if (f.px[i] < left) { f.px[i] = left; f.vx[i] = std::max(f.vx[i], 0.0f); }
+        if (f.px[i] > right) { f.px[i] = right; f.vx[i] = std::min(f.vx[i], 0.0f); }
+        if (f.py[i] < top) { f.py[i] = top; f.vy[i] = std::max(f.vy[i], 0.0f); }
+        if (f.py[i] > bottom) { f.py[i] = bottom; f.vy[i] = std::min(f.vy[i], 0.0f); }
+        float dx = f.px[i] - x, dy = f.py[i] - y;
+        longest = std::max(longest, dx * dx + dy * dy);
+    }
+    return longest;
+}
+
+// The three particle passes of one substep, each over all grid slots in parallel chunks.
+// Returns how far the integration moved any particle from where the grid put it.
+template <bool Sorted>
+static float RunPasses(const FluidArrays& f, size_t n, ThreadPool* pool, float gx, float gy, float step,
+    float left, float top, float right, float bottom)
+{
+    auto density = [&](size_t begin, size_t end) { DensityRange<Sorted>(f, begin, end); };
+    auto force = [&](size_t begin, size_t end) { ForceRange<Sorted>(f, begin, end); };
+    std::atomic<float> moved{ 0.0f }; // Squared; one update per chunk
+    auto integrate = [&](size_t begin, size_t end) {
+        float longest = IntegrateRange<Sorted>(f, begin, end, gx, gy, step, left, top, right, bottom);
+        float seen = moved.load(std::memory_order_relaxed);
+        while (longest > seen && !moved.compare_exchange_weak(seen, longest, std::memory_order_relaxed)) {}
+    };
+    if (pool) pool->ParallelFor(n, 1024, density);
+    else density(0, n);
+    if (pool) pool->ParallelFor(n, 1024, force);
+    else force(0, n);
+    if (pool) pool->ParallelFor(n, 4096, integrate);
+    else integrate(0, n);
+    return std::sqrt(moved.load(std::memory_order_relaxed));
+}
+
+// Add a block of particles at rest on a square lattice half the smoothing radius apart.
+void FluidSystem::AddBlock(float x, float y, int columns, int rows)
+{
+    float spacing = smoothingRadius * 0.5f;
+    for (int r = 0; r < rows; ++r)
+        for (int c = 0; c < columns; ++c)
+        {
+            posX.push_back(x + spacing * c);
+            posY.push_back(y + spacing * r);
+            velX.push_back(0.0f);
+            velY.push_back(0.0f);
+        }
+}
+
+// Particle mass from the density, and the rest density as measured inside a block spawned by AddBlock.
+void FluidSystem::Calibrate()
+{
+    float h = smoothingRadius, spacing = h * 0.5f;
+    particleMass = density * spacing * spacing;
+    float sum = 0.0f;
+    for (int i = -2; i <= 2; ++i)
+        for (int j = -2; j <= 2; ++j)
+        {
+            float q = std::max(h * h - (i * i + j * j) * spacing * spacing, 0.0f);
+            sum += q * q * q;
+        }
+    restDensity = particleMass * 4.0f / ((float)PI * std::pow(h, 8.0f)) * sum;
+    calibratedRadius = smoothingRadius;
+    calibratedDensity = density;
+}
+
+int FluidSystem::CellColumn(float x) const
+{
+    return std::clamp((int)((x - minX) / smoothingRadius), 0, gridColumns - 1);
+}
+
+int FluidSystem::CellRow(float y) const
+{
+    return std::clamp((int)((y - minY) / smoothingRadius), 0, gridRows - 1);
+}
+
+// Counting sort by cell: cellStart gets each cell's first slot and order the particle in each slot.
+void FluidSystem::BuildGrid()
+{
+    size_t n = Count();
+    gridColumns = std::max(1, (int)std::ceil((maxX - minX) / smoothingRadius));
+    gridRows = std::max(1, (int)std::ceil((maxY - minY) / smoothingRadius));
+    size_t cells = (size_t)gridColumns * gridRows;
+    cellStart.assign(cells + 1, 0);
+    particleCell.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint32_t cell = (uint32_t)(CellRow(posY[i]) * gridColumns + CellColumn(posX[i]));
+        particleCell[i] = cell;
+        ++cellStart[cell + 1];
+    }
+    for (size_t c = 0; c < cells; ++c)
+        cellStart[c + 1] += cellStart[c];
+    cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+    order.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        order[cellFill[particleCell[i]]++] = (uint32_t)i;
+    if (!reorder) return;
+
+    // Neighbors become neighbors in memory; particles keep their cell order between steps, so this stays cheap
+    scratch.resize(n);
+    for (std::vector<float>* values : { &posX, &posY, &velX, &velY })
+    {
+        for (size_t k = 0; k < n; ++k)
+            scratch[k] = (*values)[order[k]];
+        values->swap(scratch);
+    }
+}
+
+// Move particles out of the shapes of a body and stop them moving into it with an inelastic impulse between the two.
+// moved bounds how far any particle got from its grid cell; the deepest push made here is added to it.
+void FluidSystem::PushOut(Body& body, float& moved)
+{
+    const CompoundShape& shape = body.compound;
+    if (shape.Count() == 0) return;
+    const float bx = (float)body.position.x, by = (float)body.position.y;
+    const float inverseMass = (float)body.InverseMass(), inverseInertia = (float)body.InverseInertia();
+    const float inverseParticleMass = 1.0f / particleMass;
+    float bodyVx = (float)body.velocity.x, bodyVy = (float)body.velocity.y, spin = (float)body.angular_vel;
+    const float radius = smoothingRadius * 0.25f;
+    const float reach = radius + moved; // Particles moved after the grid was built
+    float deepest = 0.0f;
+    int c0 = CellColumn(bx + (float)shape.minX - reach), c1 = CellColumn(bx + (float)shape.maxX + reach);
+    int r0 = CellRow(by + (float)shape.minY - reach), r1 = CellRow(by + (float)shape.maxY + reach);
+    for (int r = r0; r <= r1; ++r)
+    {
+        for (uint32_t slot = cellStart[r * gridColumns + c0]; slot < cellStart[r * gridColumns + c1 + 1]; ++slot)
+        {
+            uint32_t i = reorder ? slot : order[slot];
+            float px = posX[i] - bx, py = posY[i] - by;
+
+            // Deepest penetration over all shapes, with the direction that resolves it
+            float depth = 0.0f, nx = 0.0f, ny = 0.0f;
+            for (size_t s = 0; s < shape.Count(); ++s)
+            {
+                switch (shape.kinds[s])
+                {
+                case ShapeKind::Circle: {
+                    float distance = std::sqrt(px * px + py * py);
+                    float penetration = (float)shape.radius[s] + radius - distance;
+                    if (penetration > depth) {
+                        depth = penetration;
+                        nx = distance > MinDistance ? px / distance : 0.0f;
+                        ny = distance > MinDistance ? py / distance : -1.0f;
+                    }
+                    break;
+                }
+                case ShapeKind::Polygon: {
+                    uint32_t first = shape.firstVertex[s], count = shape.vertexCount[s];
+                    if (count < 3) break;
+                    float area = 0.0f;
+                    for (uint32_t v = 0; v < count; ++v)
+                    {
+                        uint32_t a = first + v, b = first + (v + 1) % count;
+                        area += (float)(shape.vertexX[a] * shape.vertexY[b] - shape.vertexX[b] * shape.vertexY[a]);
+                    }
+                    float side = area > 0.0f ? 1.0f : -1.0f; // Outward normals for either winding
+                    float nearest = -INFINITY, edgeX = 0.0f, edgeY = 0.0f;
+                    for (uint32_t v = 0; v < count; ++v)
+                    {
+                        uint32_t a = first + v, b = first + (v + 1) % count;
+                        float ex = (float)(shape.vertexX[b] - shape.vertexX[a]), ey = (float)(shape.vertexY[b] - shape.vertexY[a]);
+                        float length = std::max(std::sqrt(ex * ex + ey * ey), MinDistance);
+                        float ox = side * ey / length, oy = -side * ex / length;
+                        float distance = ox * (px - (float)shape.vertexX[a]) + oy * (py - (float)shape.vertexY[a]);
+                        if (distance > nearest) { nearest = distance; edgeX = ox; edgeY = oy; }
+                    }
+                    if (nearest > 0.0f && nearest < radius)
+                    {
+                        // Outside: the closest edge point, which is a corner when the particle is past an edge's ends
+                        float closest = INFINITY;
+                        for (uint32_t v = 0; v < count; ++v)
+                        {
+                            uint32_t a = first + v, b = first + (v + 1) % count;
+                            float ax = (float)shape.vertexX[a], ay = (float)shape.vertexY[a];
+                            float ex = (float)shape.vertexX[b] - ax, ey = (float)shape.vertexY[b] - ay;
+                            float t = std::clamp(((px - ax) * ex + (py - ay) * ey) / std::max(ex * ex + ey * ey, MinDistance), 0.0f, 1.0f);
+                            float dx = px - (ax + ex * t), dy = py - (ay + ey * t);
+                            float distance = std::sqrt(dx * dx + dy * dy);
+                            if (distance < closest && distance > MinDistance) {
+                                closest = distance; edgeX = dx / distance; edgeY = dy / distance;
+                            }
+                        }
+                        if (closest < INFINITY) nearest = closest; // Else on the boundary: keep the edge normal
+                    }
+                    float penetration = radius - nearest;
+                    if (penetration > depth) { depth = penetration; nx = edgeX; ny = edgeY; }
+                    break;
+                }
+                }
+            }
+            if (depth <= 0.0f) continue;
+
+            deepest = std::max(deepest, depth);
+            posX[i] += nx * depth;
+            posY[i] += ny * depth;
+            float rx = posX[i] - bx, ry = posY[i] - by;
+            float normalSpeed = (velX[i] - (bodyVx - spin * ry)) * nx + (velY[i] - (bodyVy + spin * rx)) * ny;
+            if (normalSpeed >= 0.0f) continue; // Already leaving the body
+
+            // The body takes its share at once, so the next particle in this substep meets its new velocity
+            float arm = rx * ny - ry * nx;
+            float impulse = -normalSpeed / (inverseParticleMass + inverseMass + inverseInertia * arm * arm);
+            velX[i] += impulse * inverseParticleMass * nx;
+            velY[i] += impulse * inverseParticleMass * ny;
+            bodyVx -= impulse * inverseMass * nx;
+            bodyVy -= impulse * inverseMass * ny;
+            spin -= impulse * inverseInertia * arm;
+        }
+    }
+    if (inverseMass > 0.0f || inverseInertia > 0.0f) {
+        body.velocity.set((Real)(double)bodyVx, (Real)(double)bodyVy);
+        body.angular_vel = (Real)(double)spin;
+    }
+    moved += deepest;
+}
+
+// Substeps of: grid sort, density, forces, integration, then pushing against bodies.
+void FluidSystem::Update(float deltaTime, const std::list<std::unique_ptr<Body>>& bodies,
+    const std::list<std::unique_ptr<Body>>& staticBodies, ThreadPool* pool)
+{
+    size_t n = Count();
+    substeps = 0;
+    if (n == 0 || deltaTime <= 0.0f || smoothingRadius <= 0.0f) return;
+    if (smoothingRadius != calibratedRadius || density != calibratedDensity)
+        Calibrate();
+
+    float fastest = 0.0f;
+    for (size_t i = 0; i < n; ++i)
+        fastest = std::max(fastest, velX[i] * velX[i] + velY[i] * velY[i]);
+    float longest = CourantFactor * smoothingRadius / (soundSpeed + std::sqrt(fastest));
+    substeps = std::clamp((int)std::ceil(deltaTime / longest), 1, std::max(maxSubsteps, 1));
+    const float step = deltaTime / substeps;
+    const float h = smoothingRadius, margin = h * 0.25f;
+
+    densities.resize(n);
+    pressures.resize(n);
+    accelerationX.resize(n);
+    accelerationY.resize(n);
+    for (int s = 0; s < substeps; ++s)
+    {
+        BuildGrid(); // Before taking pointers: reordering swaps the arrays
+        const FluidArrays arrays{ posX.data(), posY.data(), velX.data(), velY.data(), order.data(), cellStart.data(),
+            densities.data(), pressures.data(), accelerationX.data(), accelerationY.data(),
+            gridColumns, gridRows, minX, minY, 1.0f / h,
+            h, h * h, particleMass, restDensity, soundSpeed * soundSpeed, viscosity,
+            4.0f / ((float)PI * std::pow(h, 8.0f)), 30.0f / ((float)PI * std::pow(h, 5.0f)), 40.0f / ((float)PI * std::pow(h, 5.0f)) };
+        float moved = reorder
+            ? RunPasses<true>(arrays, n, pool, gravityX, gravityY, step, minX + margin, minY + margin, maxX - margin, maxY - margin)
+            : RunPasses<false>(arrays, n, pool, gravityX, gravityY, step, minX + margin, minY + margin, maxX - margin, maxY - margin);
+
+        for (const auto& bodyPtr : bodies)
+            PushOut(*bodyPtr, moved);
+        for (const auto& bodyPtr : staticBodies)
+            PushOut(*bodyPtr, moved);
+    }
+}
+
+// Interleave positions into a point array for one batched SDL_RenderPoints call.
+void FluidSystem::CopyPoints(std::vector<SDL_FPoint>& points) const
+{
+    size_t n = Count();
+    points.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        points[i] = { posX[i], posY[i] };
+}
+
+// Remove all particles.
+void FluidSystem::Clear()
+{
+    posX.clear(); posY.clear();
+    velX.clear(); velY.clear();
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+#include <SDL3/SDL.h>
+#include "Body.h"
+#include "ThreadPool.h"
+
+/**
+ * @class FluidSystem
+ * @brief Weakly compressible SPH liquid: particles stored as structure-of-arrays, confined to a box.
+ *
+ * Every substep counting-sorts the particles by cell of a grid with the smoothing radius as
+ * cell size, and (with reorder set) permutes the particle arrays into that order. The 3 x 3
+ * cells around a particle are then three contiguous index ranges, one per grid row, so
+ * the density pass, the pressure and viscosity pass and the integration pass stream through
+ * memory. Each pass is split into pool chunks and only writes its own particles.
+ *
+ * Bodies push the fluid out of their shapes. A particle moving into a body exchanges an
+ * inelastic impulse with it, which changes the velocity of a dynamic body at once, so fluid
+ * and dynamic bodies interact both ways and light bodies float. Shapes are placed at their
+ * body's position without rotation, as the broad phase and the renderer place them. The
+ * coupling pass visits only the grid cells under each body, on the calling thread.
+ */
+class FluidSystem
+{
+public:
+    std::vector<float> posX, posY; ///< Positions, in grid order after an Update when reorder is set
+    std::vector<float> velX, velY; ///< Velocities
+
+    float smoothingRadius = 8.0f;  ///< Kernel radius and grid cell size; particles are spawned half of it apart
+    float density = 0.001f;        ///< Mass per unit area at rest, as World::DefaultDensity: lighter bodies float
+    float soundSpeed = 1000.0f;    ///< Pressure stiffness as a speed; higher compresses less but needs more substeps
+    float viscosity = 20.0f;       ///< Kinematic viscosity
+    float gravityX = 0.0f, gravityY = 0.0f; ///< Uniform acceleration applied to all particles
+    float minX = 0.0f, minY = 0.0f, maxX = 800.0f, maxY = 800.0f; ///< Walls of the container
+    int maxSubsteps = 16;          ///< Upper bound on substeps per Update
+    bool reorder = true;           ///< Keep the particle arrays in grid order (off reads them through an index)
+
+    /**
+     * @brief Add a block of particles at rest, half the smoothing radius apart, its top left particle at (x, y).
+     * @param x,y Position of the top left particle
+     * @param columns,rows Particles per row and per column
+     */
+    void AddBlock(float x, float y, int columns, int rows);
+
+    /**
+     * @brief Advance the fluid by one step, split into substeps short enough for its fastest particle.
+     * @param deltaTime Time step in seconds
+     * @param bodies Bodies that push the fluid; dynamic ones are pushed back (their velocity changes)
+     * @param staticBodies Bodies that only push the fluid
+     * @param pool Thread pool for the particle passes (nullptr runs serially)
+     */
+    void Update(float deltaTime, const std::list<std::unique_ptr<Body>>& bodies,
+        const std::list<std::unique_ptr<Body>>& staticBodies, ThreadPool* pool);
+
+    /**
+     * @brief Copy positions into an interleaved point array for batched rendering.
+     * @param points Receives one point per particle (reused, resized to Count())
+     */
+    void CopyPoints(std::vector<SDL_FPoint>& points) const;
+
+    /**
+     * @brief Remove all particles.
+     */
+    void Clear();
+
+    size_t Count() const { return posX.size(); }  ///< Number of particles
+    int GetSubsteps() const { return substeps; }  ///< Substeps used by the last Update
+    float GetRestDensity() const { return restDensity; } ///< Density of a particle inside a block at rest
+
+    /**
+     * @brief Densities computed in the last substep, by grid slot (by particle when reorder is set).
+     */
+    const std::vector<float>& GetDensities() const { return densities; }
+
+private:
+    // Recompute the particle mass, kernel factors and rest density after the radius or density changed.
+    void Calibrate();
+
+    // Counting-sort the particles by grid cell; with reorder set, also permute the particle arrays.
+    void BuildGrid();
+
+    // Push particles out of the shapes of one body and exchange impulses with it; moved is the
+    // farthest any particle got from its grid cell so far this substep, and grows by this body's pushes.
+    void PushOut(Body& body, float& moved);
+
+    // Grid cell of a position, clamped to the grid.
+    int CellColumn(float x) const;
+    int CellRow(float y) const;
+
+    float particleMass = 16.0f;
+    float restDensity = 1.0f;
+    float calibratedRadius = 0.0f, calibratedDensity = 0.0f; ///< Values Calibrate ran for
+    int substeps = 0;
+
+    int gridColumns = 0, gridRows = 0;
+    std::vector<uint32_t> cellStart;         ///< First grid slot of each cell, plus an end marker
+    std::vector<uint32_t> cellFill;          ///< Counting sort cursor per cell
+    std::vector<uint32_t> particleCell;      ///< Cell of each particle during the sort
+    std::vector<uint32_t> order;             ///< Particle in each grid slot
+    std::vector<float> scratch;              ///< Permutation buffer for reordering
+    std::vector<float> densities, pressures; ///< Per grid slot
+    std::vector<float> accelerationX, accelerationY; ///< Per grid slot
+};
@@ -0,0 +1,335 @@
+// FrameCapture.cpp
+// Offscreen frame capture with one frame of readback latency and a background writer.
+#include "FrameCapture.h"
+#include <chrono>
+#include <cstring>
+
+// CRC-32 (PNG chunk checksum) of a byte range, continuing from crc.
+static uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size)
+{
+    static uint32_t table[256];
+    static bool ready = false; // only the writer thread computes checksums
+    if (!ready) {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        ready = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// Append a big-endian 32-bit value.
+static void PutBigEndian(std::vector<uint8_t>& out, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back((uint8_t)(value >> shift));
+}
+
+// Append a PNG chunk (length, type, data, CRC).
+static void PutChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t size)
+{
+    PutBigEndian(out, (uint32_t)size);
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    PutBigEndian(out, Crc32(0, out.data() + start, out.size() - start));
+}
+
+/**
+ * @brief Minimal zlib stream using fixed-Huffman deflate.
+ *
+ * The only back-reference is "repeat the previous pixel" (distance 4), which is where
+ * simulation frames spend nearly all their bytes: long runs of background. That keeps
+ * the encoder a single greedy pass while still shrinking typical frames about 60x.
+ */
+class PixelRunDeflater
+{
+public:
+    explicit PixelRunDeflater(std::vector<uint8_t>& out) : out(out) {}
+
+    void Compress(const uint8_t* data, size_t size)
+    {
+        out.push_back(0x78); out.push_back(0x01); // zlib header: deflate, 32K window, no dictionary
+        PutBits(1, 1); // final block
+        PutBits(1, 2); // fixed Huffman codes
+        const size_t distance = 4;
+        for (size_t i = 0; i < size;)
+        {
+            size_t run = 0;
+            if (i >= distance)
+                while (run < 258 && i + run < size && data[i + run] == data[i + run - distance]) ++run;
+            if (run >= 3) {
+                PutLength(run);
+                PutHuffman(3, 5); // distance code 3 = distance 4, no extra bits
+                i += run;
+            } else {
+                PutLiteral(data[i++]);
+            }
+        }
+        PutHuffman(0, 7); // end of block (symbol 256)
+        if (bitCount > 0) out.push_back((uint8_t)bitBuffer);
+
+        uint32_t a = 1, b = 0; // Adler-32 of the uncompressed data
+        for (size_t i = 0; i < size; ++i) {
+            a = (a + data[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        PutBigEndian(out, (b << 16) | a);
+    }
+
+private:
+    // Append bits least significant first, as deflate packs header fields and extra bits.
+    void PutBits(uint32_t value, int count)
+    {
+        bitBuffer |= value << bitCount;
+        bitCount += count;
+        while (bitCount >= 8) {
+            out.push_back((uint8_t)bitBuffer);
+            bitBuffer >>= 8;
+            bitCount -= 8;
+        }
+    }
+
+    // Append a Huffman code, which deflate stores most significant bit first.
+    void PutHuffman(uint32_t code, int length)
+    {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i)
+            reversed |= ((code >> i) & 1) << (length - 1 - i);
+        PutBits(reversed, length);
+    }
+
+    void PutLiteral(uint8_t value)
+    {
+        if (value < 144) PutHuffman(0x30 + value, 8);
+        else PutHuffman(0x190 + (value - 144), 9);
+    }
+
+    void PutLength(size_t length)
+    {
+        static const uint16_t base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const uint8_t extra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        int code = 28;
+        while (base[code] > length) --code;
+        int symbol = 257 + code;
+        if (symbol < 280) PutHuffman(symbol - 256, 7);
+        else PutHuffman(0xC0 + (symbol - 280), 8);
+        PutBits((uint32_t)(length - base[code]), extra[code]);
+    }
+
+    std::vector<uint8_t>& out;
+    uint32_t bitBuffer = 0;
+    int bitCount = 0;
+};
+
+FrameCapture::~FrameCapture()
+{
+    Stop();
+}
+
+bool FrameCapture::Start(SDL_Renderer* renderer, int width, int height, const std::string& directory,
+    Format format, bool lossless, size_t bufferCount)
+{
+    Stop();
+    for (auto& target : targets) {
+        target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!target) {
+            SDL_Log("Couldn't create capture target: %s", SDL_GetError());
+            for (auto& created : targets) {
+                if (created) SDL_DestroyTexture(created);
+                created = nullptr;
+            }
+            return false;
+        }
+    }
+    if (format == Format::Raw) {
+        rawFile = std::fopen((directory + "/frames.rgba").c_str(), "wb");
+        if (!rawFile) {
+            for (auto& target : targets) {
+                SDL_DestroyTexture(target);
+                target = nullptr;
+            }
+            return false;
+        }
+    }
+
+    this->renderer = renderer;
+    this->width = width;
+    this->height = height;
+    this->directory = directory;
+    this->format = format;
+    this->lossless = lossless;
+    current = 0;
+    pending = false;
+    spareSlot = -1;
+    captured = 0;
+    dropped = 0;
+    written = 0;
+
+    // Every buffer starts out free; the rings can hold the whole pool, so pushes never fail
+    frames.assign(bufferCount, Frame{});
+    freeFrames = std::make_unique<SpscRingBuffer<uint32_t>>(bufferCount);
+    queuedFrames = std::make_unique<SpscRingBuffer<uint32_t>>(bufferCount);
+    for (uint32_t i = 0; i < bufferCount; ++i)
+        freeFrames->TryPush(&i, 1);
+
+    stopping = false;
+    writer = std::thread(&FrameCapture::WriterLoop, this);
+    return true;
+}
+
+void FrameCapture::Stop()
+{
+    if (!renderer) return;
+    if (pending) {
+        bool wasLossless = lossless;
+        lossless = true; // never lose the final frame
+        ReadBack(targets[1 - current]);
+        lossless = wasLossless;
+        SDL_SetRenderTarget(renderer, nullptr);
+        pending = false;
+    }
+    stopping = true;
+    if (writer.joinable())
+        writer.join();
+    if (rawFile) {
+        std::fclose(rawFile);
+        rawFile = nullptr;
+    }
+    for (auto& target : targets) {
+        SDL_DestroyTexture(target);
+        target = nullptr;
+    }
+    frames.clear();
+    renderer = nullptr;
+}
+
+void FrameCapture::BeginFrame()
+{
+    if (!renderer) return;
+    SDL_SetRenderTarget(renderer, targets[current]);
+}
+
+void FrameCapture::EndFrame(bool present)
+{
+    if (!renderer) return;
+    // The other target holds last frame, which the GPU has had a full frame to finish
+    if (pending)
+        ReadBack(targets[1 - current]);
+    SDL_SetRenderTarget(renderer, nullptr);
+    if (present)
+        SDL_RenderTexture(renderer, targets[current], nullptr, nullptr);
+    pending = true;
+    current = 1 - current;
+}
+
+void FrameCapture::ReadBack(SDL_Texture* texture)
+{
+    uint32_t slot;
+    if (spareSlot >= 0) {
+        slot = (uint32_t)spareSlot;
+        spareSlot = -1;
+    }
+    else {
+        while (!freeFrames->Pop(&slot, 1)) {
+            if (!lossless) {
+                ++dropped; // writer is behind; skip the readback entirely
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    SDL_SetRenderTarget(renderer, texture);
+    SDL_Surface* surface = SDL_RenderReadPixels(renderer, nullptr);
+    if (!surface) {
+        ++dropped;
+        spareSlot = (int)slot; // The writer is the free ring's only producer; keep the buffer for the next readback
+        return;
+    }
+    Frame& frame = frames[slot];
+    frame.width = surface->w;
+    frame.height = surface->h;
+    frame.pitch = surface->pitch;
+    frame.format = surface->format;
+    frame.index = captured++;
+    frame.pixels.resize((size_t)surface->pitch * surface->h); // reuses the allocation after the first frame
+    std::memcpy(frame.pixels.data(), surface->pixels, frame.pixels.size());
+    SDL_DestroySurface(surface);
+    queuedFrames->TryPush(&slot, 1);
+}
+
+void FrameCapture::WriterLoop()
+{
+    for (;;)
+    {
+        bool finishing = stopping.load(); // read before draining so nothing queued before Stop is lost
+        uint32_t slot;
+        if (queuedFrames->Pop(&slot, 1)) {
+            WriteFrame(frames[slot]);
+            freeFrames->TryPush(&slot, 1);
+            continue;
+        }
+        if (finishing) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (rawFile)
+        std::fflush(rawFile);
+}
+
+void FrameCapture::WriteFrame(const Frame& frame)
+{
+    size_t rowBytes = (size_t)frame.width * 4;
+    rgba.resize(rowBytes * frame.height);
+    if (!SDL_ConvertPixels(frame.width, frame.height, frame.format, frame.pixels.data(), frame.pitch,
+            SDL_PIXELFORMAT_RGBA32, rgba.data(), (int)rowBytes)) {
+        SDL_Log("Couldn't convert captured frame: %s", SDL_GetError());
+        return;
+    }
+
+    if (format == Format::Raw) {
+        std::fwrite(rgba.data(), 1, rgba.size(), rawFile);
+        ++written;
+        return;
+    }
+
+    // PNG scanlines each start with a filter byte (0 = none)
+    scanlines.clear();
+    for (int y = 0; y < frame.height; ++y) {
+        scanlines.push_back(0);
+        scanlines.insert(scanlines.end(), rgba.begin() + y * rowBytes, rgba.begin() + (y + 1) * rowBytes);
+    }
+    compressed.clear();
+    PixelRunDeflater(compressed).Compress(scanlines.data(), scanlines.size());
+
+    encoded.clear();
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    encoded.insert(encoded.end(), signature, signature + 8);
+    std::vector<uint8_t> header;
+    PutBigEndian(header, (uint32_t)frame.width);
+    PutBigEndian(header, (uint32_t)frame.height);
+    const uint8_t layout[5] = { 8, 6, 0, 0, 0 }; // 8-bit RGBA, deflate, no filter set, no interlace
+    header.insert(header.end(), layout, layout + 5);
+    PutChunk(encoded, "IHDR", header.data(), header.size());
+    PutChunk(encoded, "IDAT", compressed.data(), compressed.size());
+    PutChunk(encoded, "IEND", nullptr, 0);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "/frame_%06llu.png", frame.index);
+    FILE* file = std::fopen((directory + name).c_str(), "wb");
+    if (!file) {
+        SDL_Log("Couldn't write %s%s", directory.c_str(), name);
+        return;
+    }
+    std::fwrite(encoded.data(), 1, encoded.size(), file);
+    std::fclose(file);
+    ++written;
+}
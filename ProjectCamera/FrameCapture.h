@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <SDL3/SDL.h>
+#include "SpscRingBuffer.h"
+
+/**
+ * @class FrameCapture
+ * @brief Records rendered frames to disk without holding up rendering or the simulation.
+ *
+ * Frames are drawn into one of two target textures. At the end of frame N the texture
+ * holding frame N-1 is read back, so the GPU has had a whole frame to finish it and the
+ * capture adds exactly one frame of latency. The pixels are copied into a fixed pool of
+ * reusable buffers and handed over a lock-free ring to a writer thread, which converts
+ * them to RGBA and writes them out; finished buffers return over a second ring.
+ *
+ * When every buffer is still queued, a frame is dropped and counted (or, in lossless
+ * mode, the render thread waits for the writer). The simulation thread is never involved.
+ *
+ * Raw output is a single file "frames.rgba" of tightly packed RGBA frames, readable by
+ * e.g. ffmpeg -f rawvideo -pix_fmt rgba -s WxH. PNG output is "frame_000000.png" onwards.
+ */
+class FrameCapture
+{
+public:
+    /// Output encoding
+    enum class Format
+    {
+        Raw, ///< One concatenated RGBA stream
+        Png  ///< One PNG file per frame
+    };
+
+    ~FrameCapture();
+
+    /**
+     * @brief Create the target textures and buffer pool and start the writer thread.
+     * @param renderer Renderer whose frames are captured (window or software)
+     * @param width Frame width in pixels
+     * @param height Frame height in pixels
+     * @param directory Existing directory receiving the output
+     * @param format Output encoding
+     * @param lossless Wait for a free buffer instead of dropping frames
+     * @param bufferCount Number of frames that can be in flight to the writer
+     * @return False if the textures or the raw output file could not be created
+     */
+    bool Start(SDL_Renderer* renderer, int width, int height, const std::string& directory,
+        Format format, bool lossless = false, size_t bufferCount = 4);
+
+    /**
+     * @brief Read back the last pending frame, write everything queued and release all resources.
+     */
+    void Stop();
+
+    /**
+     * @brief Redirect rendering into the current capture texture (render thread).
+     */
+    void BeginFrame();
+
+    /**
+     * @brief Finish the frame: queue the previous frame for writing and optionally show this one.
+     * @param present Copy the frame to the window's back buffer (call SDL_RenderPresent afterwards)
+     */
+    void EndFrame(bool present);
+
+    bool IsCapturing() const { return renderer != nullptr; }
+    unsigned long long Captured() const { return captured.load(); } ///< Frames queued for writing
+    unsigned long long Dropped() const { return dropped.load(); }   ///< Frames skipped because no buffer was free
+    unsigned long long Written() const { return written.load(); }   ///< Frames on disk
+
+private:
+    /// One pooled frame in the renderer's native pixel format
+    struct Frame
+    {
+        std::vector<uint8_t> pixels;
+        int width = 0, height = 0, pitch = 0;
+        SDL_PixelFormat format = SDL_PIXELFORMAT_RGBA32;
+        unsigned long long index = 0;
+    };
+
+    // Copy the given target texture into a free buffer and queue it.
+    void ReadBack(SDL_Texture* texture);
+
+    // Writer thread body: take a frame, convert, write, return the buffer.
+    void WriterLoop();
+
+    // Convert one frame to RGBA and write it.
+    void WriteFrame(const Frame& frame);
+
+    SDL_Renderer* renderer = nullptr;
+    SDL_Texture* targets[2] = { nullptr, nullptr };
+    int current = 0;          ///< Target being drawn this frame
+    bool pending = false;     ///< The other target holds a frame not yet read back
+    int spareSlot = -1;       ///< Buffer kept by the render thread after a failed readback, -1 if none
+    int width = 0, height = 0;
+    std::string directory;
+    Format format = Format::Raw;
+    bool lossless = false;
+    FILE* rawFile = nullptr;
+
+    std::vector<Frame> frames;                           ///< Buffer pool
+    std::unique_ptr<SpscRingBuffer<uint32_t>> freeFrames;  ///< Writer to render thread
+    std::unique_ptr<SpscRingBuffer<uint32_t>> queuedFrames; ///< Render to writer thread
+    std::thread writer;
+    std::atomic<bool> stopping{ false };
+    std::vector<uint8_t> rgba, scanlines, compressed, encoded; ///< Writer-side scratch
+    std::atomic<unsigned long long> captured{ 0 }, dropped{ 0 }, written{ 0 };
+};
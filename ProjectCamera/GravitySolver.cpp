@@ -0,0 +1,294 @@
+#include "GravitySolver.h"
+#include <algorithm>
+#include <cmath>
+
+// Bodies per leaf before it splits; small buckets keep leaves cheap to sum directly
+static const int LeafCapacity = 8;
+// Deepest split; bodies at (nearly) the same point simply share a leaf below this
+static const int MaxDepth = 32;
+// Up to this many bodies a direct sum is exact and cheaper than building a tree
+static const size_t DirectThreshold = 128;
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GRAVITY_SIMD 1
+#else
+#define GRAVITY_SIMD 0
+#endif
+
+/**
+ * @brief Compute gravitational accelerations, by direct summation for small n and the tree otherwise.
+ */
+void GravitySolver::Evaluate(const Real* x, const Real* y, const Real* m, size_t n, Real* ax, Real* ay, ThreadPool* pool)
+{
+    if (n <= DirectThreshold)
+        ComputeAccelerationsDirect(x, y, m, n, ax, ay, pool);
+    else
+        ComputeAccelerations(x, y, m, n, ax, ay, pool);
+}
+
+/**
+ * @brief Compute gravitational accelerations with the Barnes-Hut tree.
+ */
+void GravitySolver::ComputeAccelerations(const Real* x, const Real* y, const Real* m, size_t n,
+    Real* ax, Real* ay, ThreadPool* pool)
+{
+    if (n == 0) return;
+    BuildTree(x, y, m, n);
+    auto walkRange = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            Walk(i, x, y, m, ax[i], ay[i]);
+    };
+    if (pool) pool->ParallelFor(n, 64, walkRange);
+    else walkRange(0, n);
+}
+
+// Sum the pull of all n sources on one point (self-pairs give d2 == eps2 and are masked out
+// when eps2 is 0). Eight float or four double lanes per iteration with AVX2, scalar tail.
+template<typename T>
+static void DirectSumScalar(const T* x, const T* y, const T* m, size_t begin, size_t n,
+    T px, T py, T eps2, T& sx, T& sy)
+{
+    for (size_t j = begin; j < n; ++j)
+    {
+        T dx = x[j] - px, dy = y[j] - py;
+        T d2 = dx * dx + dy * dy + eps2;
+        if (d2 <= T(0)) continue;
+        T inv = m[j] / (d2 * sqrt(d2));
+        sx += dx * inv;
+        sy += dy * inv;
+    }
+}
+
+static void DirectSum(const float* x, const float* y, const float* m, size_t n,
+    float px, float py, float eps2, float& sx, float& sy)
+{
+    size_t j = 0;
+#if GRAVITY_SIMD
+    __m256 vpx = _mm256_set1_ps(px), vpy = _mm256_set1_ps(py), veps = _mm256_set1_ps(eps2);
+    __m256 zero = _mm256_setzero_ps(), accX = zero, accY = zero;
+    for (; j + 8 <= n; j += 8)
+    {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + j), vpx);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + j), vpy);
+        __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), veps);
+        __m256 inv = _mm256_div_ps(_mm256_loadu_ps(m + j), _mm256_mul_ps(d2, _mm256_sqrt_ps(d2)));
+        inv = _mm256_and_ps(inv, _mm256_cmp_ps(d2, zero, _CMP_GT_OQ));
+        accX = _mm256_add_ps(accX, _mm256_mul_ps(dx, inv));
+        accY = _mm256_add_ps(accY, _mm256_mul_ps(dy, inv));
+    }
+    alignas(32) float lanesX[8], lanesY[8];
+    _mm256_store_ps(lanesX, accX);
+    _mm256_store_ps(lanesY, accY);
+    for (int k = 0; k < 8; ++k) { sx += lanesX[k]; sy += lanesY[k]; }
+#endif
+    DirectSumScalar(x, y, m, j, n, px, py, eps2, sx, sy);
+}
+
+static void DirectSum(const double* x, const double* y, const double* m, size_t n,
+    double px, double py, double eps2, double& sx, double& sy)
+{
+    size_t j = 0;
+#if GRAVITY_SIMD
+    __m256d vpx = _mm256_set1_pd(px), vpy = _mm256_set1_pd(py), veps = _mm256_set1_pd(eps2);
+    __m256d zero = _mm256_setzero_pd(), accX = zero, accY = zero;
+    for (; j + 4 <= n; j += 4)
+    {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + j), vpx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + j), vpy);
+        __m256d d2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), veps);
+        __m256d inv = _mm256_div_pd(_mm256_loadu_pd(m + j), _mm256_mul_pd(d2, _mm256_sqrt_pd(d2)));
+        inv = _mm256_and_pd(inv, _mm256_cmp_pd(d2, zero, _CMP_GT_OQ));
+        accX = _mm256_add_pd(accX, _mm256_mul_pd(dx, inv));
+        accY = _mm256_add_pd(accY, _mm256_mul_pd(dy, inv));
+    }
+    alignas(32) double lanesX[4], lanesY[4];
+    _mm256_store_pd(lanesX, accX);
+    _mm256_store_pd(lanesY, accY);
+    for (int k = 0; k < 4; ++k) { sx += lanesX[k]; sy += lanesY[k]; }
+#endif
+    DirectSumScalar(x, y, m, j, n, px, py, eps2, sx, sy);
+}
+
+#ifdef PHYSICS_FIXED_POINT
+static void DirectSum(const Fixed* x, const Fixed* y, const Fixed* m, size_t n,
+    Fixed px, Fixed py, Fixed eps2, Fixed& sx, Fixed& sy)
+{
+    DirectSumScalar(x, y, m, 0, n, px, py, eps2, sx, sy);
+}
+#endif
+
+/**
+ * @brief Compute the same accelerations by direct O(n^2) summation.
+ *
+ * Instantiated for float and double regardless of Real, so both precisions can be compared,
+ * and for Fixed in a fixed-point build.
+ */
+template<typename T>
+void GravitySolver::ComputeAccelerationsDirect(const T* x, const T* y, const T* m, size_t n,
+    T* ax, T* ay, ThreadPool* pool) const
+{
+    const T eps2 = T(softening * softening);
+    const T g = T(gravitationalConstant);
+    auto sumRange = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            T sx = 0, sy = 0;
+            DirectSum(x, y, m, n, x[i], y[i], eps2, sx, sy);
+            ax[i] = g * sx;
+            ay[i] = g * sy;
+        }
+    };
+    if (pool) pool->ParallelFor(n, 16, sumRange);
+    else sumRange(0, n);
+}
+
+template void GravitySolver::ComputeAccelerationsDirect<float>(const float*, const float*, const float*, size_t,
+    float*, float*, ThreadPool*) const;
+template void GravitySolver::ComputeAccelerationsDirect<double>(const double*, const double*, const double*, size_t,
+    double*, double*, ThreadPool*) const;
+#ifdef PHYSICS_FIXED_POINT
+template void GravitySolver::ComputeAccelerationsDirect<Fixed>(const Fixed*, const Fixed*, const Fixed*, size_t,
+    Fixed*, Fixed*, ThreadPool*) const;
+#endif
+
+/**
+ * @brief Build the quadtree and aggregate mass and center of mass bottom-up.
+ */
+void GravitySolver::BuildTree(const Real* x, const Real* y, const Real* m, size_t n)
+{
+    Real minX = x[0], maxX = x[0], minY = y[0], maxY = y[0];
+    for (size_t i = 1; i < n; ++i)
+    {
+        minX = std::min(minX, x[i]); maxX = std::max(maxX, x[i]);
+        minY = std::min(minY, y[i]); maxY = std::max(maxY, y[i]);
+    }
+    Real half = 0.5 * std::max(maxX - minX, maxY - minY) + 1e-9;
+
+    nodes.clear();
+    nodes.push_back({ Real(0.5) * (minX + maxX), Real(0.5) * (minY + maxY), half, 0.0, 0.0, 0.0, -1, -1, 0 });
+    nextBody.assign(n, -1);
+    for (size_t i = 0; i < n; ++i)
+        Insert((int)i, 0, 0, x, y);
+
+    // Children always come after their parent, so a reverse sweep is bottom-up
+    for (size_t k = nodes.size(); k-- > 0;)
+    {
+        Node& node = nodes[k];
+        Real mass = 0.0, mx = 0.0, my = 0.0;
+        if (node.firstChild < 0)
+        {
+            for (int b = node.firstBody; b >= 0; b = nextBody[b])
+            {
+                mass += m[b];
+                mx += m[b] * x[b];
+                my += m[b] * y[b];
+            }
+        }
+        else
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                const Node& child = nodes[node.firstChild + c];
+                mass += child.mass;
+                mx += child.mass * child.massX;
+                my += child.mass * child.massY;
+            }
+        }
+        node.mass = mass;
+        node.massX = mass > 0.0 ? mx / mass : node.centerX;
+        node.massY = mass > 0.0 ? my / mass : node.centerY;
+    }
+}
+
+/**
+ * @brief Insert a body, splitting full leaves on the way down.
+ *
+ * Node indices are used instead of references because splitting grows the node array.
+ */
+void GravitySolver::Insert(int i, int node, int depth, const Real* x, const Real* y)
+{
+    while (nodes[node].firstChild >= 0)
+    {
+        const Node& cell = nodes[node];
+        int quadrant = (x[i] >= cell.centerX ? 1 : 0) | (y[i] >= cell.centerY ? 2 : 0);
+        node = cell.firstChild + quadrant;
+        ++depth;
+    }
+    nextBody[i] = nodes[node].firstBody;
+    nodes[node].firstBody = i;
+    if (++nodes[node].bodyCount <= LeafCapacity || depth >= MaxDepth)
+        return;
+
+    // Split: create four children and push this leaf's bodies down into them
+    int firstChild = (int)nodes.size();
+    Real quarter = 0.5 * nodes[node].halfSize;
+    for (int c = 0; c < 4; ++c)
+    {
+        Real cx = nodes[node].centerX + ((c & 1) ? quarter : -quarter);
+        Real cy = nodes[node].centerY + ((c & 2) ? quarter : -quarter);
+        nodes.push_back({ cx, cy, quarter, 0.0, 0.0, 0.0, -1, -1, 0 });
+    }
+    int chain = nodes[node].firstBody;
+    nodes[node].firstChild = firstChild;
+    nodes[node].firstBody = -1;
+    nodes[node].bodyCount = 0;
+    while (chain >= 0)
+    {
+        int next = nextBody[chain];
+        Insert(chain, node, depth, x, y);
+        chain = next;
+    }
+}
+
+/**
+ * @brief Walk the tree for one body and accumulate its acceleration.
+ */
+void GravitySolver::Walk(size_t i, const Real* x, const Real* y, const Real* m, Real& ax, Real& ay) const
+{
+    const Real eps2 = softening * softening;
+    const Real theta2 = theta * theta;
+    const Real px = x[i], py = y[i];
+    Real sx = 0.0, sy = 0.0;
+
+    int stack[4 * MaxDepth + 8];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node& node = nodes[stack[--top]];
+        if (node.mass <= 0.0) continue;
+        if (node.firstChild < 0)
+        {
+            // Leaf: sum its bodies exactly
+            for (int b = node.firstBody; b >= 0; b = nextBody[b])
+            {
+                if ((size_t)b == i) continue;
+                Real dx = x[b] - px, dy = y[b] - py;
+                Real d2 = dx * dx + dy * dy + eps2;
+                Real inv = m[b] / (d2 * sqrt(d2));
+                sx += dx * inv;
+                sy += dy * inv;
+            }
+            continue;
+        }
+        Real dx = node.massX - px, dy = node.massY - py;
+        Real d2 = dx * dx + dy * dy;
+        Real size = 2.0 * node.halfSize;
+        if (size * size < theta2 * d2)
+        {
+            // Far enough away: the whole cell acts as one point mass
+            d2 += eps2;
+            Real inv = node.mass / (d2 * sqrt(d2));
+            sx += dx * inv;
+            sy += dy * inv;
+        }
+        else
+        {
+            for (int c = 0; c < 4; ++c)
+                stack[top++] = node.firstChild + c;
+        }
+    }
+    ax = gravitationalConstant * sx;
+    ay = gravitationalConstant * sy;
+}
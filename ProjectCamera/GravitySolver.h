@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+#include "ThreadPool.h"
+#include "globals.h"
+
+/**
+ * @class GravitySolver
+ * @brief Barnes-Hut mutual gravity between all bodies of a world.
+ *
+ * Bodies are bucketed into a quadtree whose nodes store total mass and center of
+ * mass. Each body then walks the tree: a node whose size over distance is below the
+ * opening angle theta is treated as a single point mass, otherwise its children are
+ * visited. Walks are independent and run in parallel. World installs Evaluate as
+ * the BodyBatch field, so integrators re-evaluate gravity at every stage.
+ */
+class GravitySolver
+{
+public:
+    bool enabled = false;              ///< Mutual gravity is off by default
+    double gravitationalConstant = 1.0; ///< G in world units
+    double theta = 0.5;                ///< Opening angle: 0 is exact, larger is faster and coarser
+    double softening = 1.0;            ///< Plummer softening length, avoids singular close encounters
+
+    /**
+     * @brief Compute gravitational accelerations, by direct summation for small n and the tree otherwise.
+     *
+     * The only entry point used by the world; integrators call it at trial positions.
+     * @param x Body positions X
+     * @param y Body positions Y
+     * @param m Body masses
+     * @param n Number of bodies
+     * @param ax Receives accelerations X
+     * @param ay Receives accelerations Y
+     * @param pool Thread pool for the tree walks (nullptr runs serially)
+     */
+    void Evaluate(const Real* x, const Real* y, const Real* m, size_t n, Real* ax, Real* ay, ThreadPool* pool);
+
+    /**
+     * @brief Compute gravitational accelerations with the Barnes-Hut tree.
+     * @param x Body positions X
+     * @param y Body positions Y
+     * @param m Body masses
+     * @param n Number of bodies
+     * @param ax Receives accelerations X
+     * @param ay Receives accelerations Y
+     * @param pool Thread pool for the tree walks (nullptr runs serially)
+     */
+    void ComputeAccelerations(const Real* x, const Real* y, const Real* m, size_t n,
+        Real* ax, Real* ay, ThreadPool* pool);
+
+    /**
+     * @brief Compute the same accelerations by direct O(n^2) summation.
+     *
+     * Exact reference for benchmarks, also used by Evaluate for small worlds. Available
+     * in float and double whatever Real is; both are vectorized with AVX2.
+     */
+    template<typename T>
+    void ComputeAccelerationsDirect(const T* x, const T* y, const T* m, size_t n,
+        T* ax, T* ay, ThreadPool* pool) const;
+
+private:
+    /// Quadtree node; children are stored as four consecutive nodes
+    struct Node
+    {
+        Real centerX, centerY, halfSize; ///< Square cell
+        Real mass;                       ///< Total mass in the cell
+        Real massX, massY;               ///< Center of mass
+        int firstChild;                    ///< Index of the first child, -1 for leaves
+        int firstBody;                     ///< Head of the leaf's body chain, -1 if empty
+        int bodyCount;                     ///< Bodies in the leaf's chain
+    };
+
+    // Build the tree over the given bodies.
+    void BuildTree(const Real* x, const Real* y, const Real* m, size_t n);
+
+    // Insert body i, starting the descent at the given node at the given depth.
+    void Insert(int i, int node, int depth, const Real* x, const Real* y);
+
+    // Walk the tree for one body and return its acceleration.
+    void Walk(size_t i, const Real* x, const Real* y, const Real* m, Real& ax, Real& ay) const;
+
+    std::vector<Node> nodes;     ///< Tree nodes, root first
+    std::vector<int> nextBody;   ///< Leaf chains: next body in the same leaf, -1 at the end
+};
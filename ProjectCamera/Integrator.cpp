@@ -0,0 +1,192 @@
+// Integrator.cpp
+// Symplectic Euler, velocity Verlet and RK4 over structure-of-arrays body batches.
+#include "Integrator.h"
+#include <initializer_list>
+
+void BodyBatch::Resize(size_t n)
+{
+    for (std::vector<Real>* array : { &x, &y, &vx, &vy, &angle, &spin, &mass, &baseAx, &baseAy, &baseAlpha,
+        &dragX, &dragY, &angularDrag, &fieldScale })
+        array->resize(n);
+}
+
+void BodyBatch::Evaluate(const Real* px, const Real* py, const Real* pvx, const Real* pvy, const Real* pspin,
+    Real* ax, Real* ay, Real* alpha) const
+{
+    size_t n = Size();
+    if (field)
+    {
+        field(px, py, mass.data(), n, ax, ay);
+        for (size_t i = 0; i < n; ++i)
+        {
+            ax[i] = fieldScale[i] * ax[i] + baseAx[i] - dragX[i] * pvx[i];
+            ay[i] = fieldScale[i] * ay[i] + baseAy[i] - dragY[i] * pvy[i];
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            ax[i] = baseAx[i] - dragX[i] * pvx[i];
+            ay[i] = baseAy[i] - dragY[i] * pvy[i];
+        }
+    }
+    for (size_t i = 0; i < n; ++i)
+        alpha[i] = baseAlpha[i] - angularDrag[i] * pspin[i];
+}
+
+// One acceleration evaluation, then velocity and position in that order.
+class SymplecticEulerIntegrator : public Integrator
+{
+public:
+    IntegratorType Type() const override { return IntegratorType::SymplecticEuler; }
+    int EvaluationsPerStep() const override { return 1; }
+
+    void Step(BodyBatch& b, Real dt) override
+    {
+        size_t n = b.Size();
+        ax.resize(n); ay.resize(n); alpha.resize(n);
+        b.Evaluate(b.x.data(), b.y.data(), b.vx.data(), b.vy.data(), b.spin.data(), ax.data(), ay.data(), alpha.data());
+        for (size_t i = 0; i < n; ++i)
+        {
+            b.vx[i] += ax[i] * dt; b.vy[i] += ay[i] * dt;
+            b.x[i] += b.vx[i] * dt; b.y[i] += b.vy[i] * dt;
+            b.spin[i] += alpha[i] * dt;
+            b.angle[i] += b.spin[i] * dt;
+        }
+    }
+
+private:
+    std::vector<Real> ax, ay, alpha;
+};
+
+// Kick half a step, drift a full step, evaluate at the new positions, kick the second half.
+// Drag is evaluated with the half-step velocity, so the scheme stays explicit.
+class VelocityVerletIntegrator : public Integrator
+{
+public:
+    IntegratorType Type() const override { return IntegratorType::VelocityVerlet; }
+    int EvaluationsPerStep() const override { return 2; }
+
+    void Step(BodyBatch& b, Real dt) override
+    {
+        size_t n = b.Size();
+        const Real half = dt / 2;
+        ax.resize(n); ay.resize(n); alpha.resize(n);
+        b.Evaluate(b.x.data(), b.y.data(), b.vx.data(), b.vy.data(), b.spin.data(), ax.data(), ay.data(), alpha.data());
+        for (size_t i = 0; i < n; ++i)
+        {
+            b.vx[i] += ax[i] * half; b.vy[i] += ay[i] * half;
+            b.x[i] += b.vx[i] * dt; b.y[i] += b.vy[i] * dt;
+            b.spin[i] += alpha[i] * half;
+            b.angle[i] += b.spin[i] * dt;
+        }
+        b.Evaluate(b.x.data(), b.y.data(), b.vx.data(), b.vy.data(), b.spin.data(), ax.data(), ay.data(), alpha.data());
+        for (size_t i = 0; i < n; ++i)
+        {
+            b.vx[i] += ax[i] * half; b.vy[i] += ay[i] * half;
+            b.spin[i] += alpha[i] * half;
+        }
+    }
+
+private:
+    std::vector<Real> ax, ay, alpha;
+};
+
+// Classic fourth-order Runge-Kutta on (position, velocity, angle, spin).
+class RK4Integrator : public Integrator
+{
+public:
+    IntegratorType Type() const override { return IntegratorType::RK4; }
+    int EvaluationsPerStep() const override { return 4; }
+
+    void Step(BodyBatch& b, Real dt) override
+    {
+        size_t n = b.Size();
+        for (Stage* s : { &trial, &k[0], &k[1], &k[2], &k[3] })
+            s->Resize(n);
+        const Real weights[4] = { dt / 2, dt / 2, dt, 0 };
+
+        // Stage i is evaluated at the initial state plus weights[i - 1] times stage i - 1
+        for (int stage = 0; stage < 4; ++stage)
+        {
+            const Real* svx = stage == 0 ? b.vx.data() : trial.vx.data();
+            const Real* svy = stage == 0 ? b.vy.data() : trial.vy.data();
+            const Real* sspin = stage == 0 ? b.spin.data() : trial.spin.data();
+            Stage& rate = k[stage];
+            b.Evaluate(stage == 0 ? b.x.data() : trial.x.data(), stage == 0 ? b.y.data() : trial.y.data(),
+                svx, svy, sspin, rate.vx.data(), rate.vy.data(), rate.spin.data()); // d(velocity)/dt
+            rate.x.assign(svx, svx + n); // d(position)/dt
+            rate.y.assign(svy, svy + n);
+            rate.angle.assign(sspin, sspin + n);
+            if (stage == 3) break;
+            const Real h = weights[stage];
+            for (size_t i = 0; i < n; ++i)
+            {
+                trial.x[i] = b.x[i] + h * rate.x[i];
+                trial.y[i] = b.y[i] + h * rate.y[i];
+                trial.vx[i] = b.vx[i] + h * rate.vx[i];
+                trial.vy[i] = b.vy[i] + h * rate.vy[i];
+                trial.angle[i] = b.angle[i] + h * rate.angle[i];
+                trial.spin[i] = b.spin[i] + h * rate.spin[i];
+            }
+        }
+
+        const Real sixth = dt / 6;
+        auto combine = [&](std::vector<Real>& value, std::vector<Real> Stage::* member) {
+            const Real* k1 = (k[0].*member).data(); const Real* k2 = (k[1].*member).data();
+            const Real* k3 = (k[2].*member).data(); const Real* k4 = (k[3].*member).data();
+            for (size_t i = 0; i < n; ++i)
+                value[i] += sixth * (k1[i] + 2 * k2[i] + 2 * k3[i] + k4[i]);
+        };
+        combine(b.x, &Stage::x); combine(b.y, &Stage::y);
+        combine(b.vx, &Stage::vx); combine(b.vy, &Stage::vy);
+        combine(b.angle, &Stage::angle); combine(b.spin, &Stage::spin);
+    }
+
+private:
+    struct Stage
+    {
+        std::vector<Real> x, y, vx, vy, angle, spin;
+        void Resize(size_t n)
+        {
+            for (std::vector<Real>* array : { &x, &y, &vx, &vy, &angle, &spin })
+                array->resize(n);
+        }
+    };
+
+    Stage trial;
+    Stage k[4];
+};
+
+std::unique_ptr<Integrator> Integrator::Create(IntegratorType type)
+{
+    switch (type)
+    {
+    case IntegratorType::VelocityVerlet: return std::make_unique<VelocityVerletIntegrator>();
+    case IntegratorType::RK4: return std::make_unique<RK4Integrator>();
+    default: return std::make_unique<SymplecticEulerIntegrator>();
+    }
+}
+
+const char* Integrator::Name(IntegratorType type)
+{
+    switch (type)
+    {
+    case IntegratorType::VelocityVerlet: return "verlet";
+    case IntegratorType::RK4: return "rk4";
+    default: return "euler";
+    }
+}
+
+bool Integrator::Parse(std::string_view name, IntegratorType& type)
+{
+    for (IntegratorType candidate : { IntegratorType::SymplecticEuler, IntegratorType::VelocityVerlet, IntegratorType::RK4 })
+    {
+        if (name == Name(candidate)) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "globals.h"
+
+/**
+ * @enum IntegratorType
+ * @brief Time integration schemes a World can advance its bodies with.
+ */
+enum class IntegratorType : uint8_t
+{
+    SymplecticEuler, ///< Velocity, then position with the new velocity; first order, one evaluation
+    VelocityVerlet,  ///< Kick-drift-kick; second order and symplectic, two evaluations
+    RK4              ///< Classic Runge-Kutta; fourth order but not symplectic, four evaluations
+};
+
+/**
+ * @struct BodyBatch
+ * @brief Structure-of-arrays state of the moving bodies of a world, advanced as one batch.
+ *
+ * The acceleration of a body is a constant part for the step (applied force over mass plus
+ * gravity, torque over inertia), drag proportional to velocity, and an optional
+ * position-dependent field such as mutual gravity. Integrators re-evaluate all of it at
+ * every stage they need through Evaluate.
+ */
+struct BodyBatch
+{
+    std::vector<Real> x, y, vx, vy;               ///< Linear state
+    std::vector<Real> angle, spin;                ///< Angular state
+    std::vector<Real> mass;                       ///< Masses, for field sources
+    std::vector<Real> baseAx, baseAy, baseAlpha;  ///< Accelerations held constant over the step
+    std::vector<Real> dragX, dragY, angularDrag;  ///< Drag coefficients divided by mass (inertia)
+    std::vector<Real> fieldScale;                 ///< 1 if the field moves the body, 0 for kinematic bodies
+
+    /// Position-dependent acceleration (x, y, mass, count, ax, ay); overwrites ax and ay. May be empty.
+    std::function<void(const Real*, const Real*, const Real*, size_t, Real*, Real*)> field;
+
+    /**
+     * @brief Number of bodies in the batch.
+     */
+    size_t Size() const { return x.size(); }
+
+    /**
+     * @brief Resize every array to n bodies.
+     * @param n New body count
+     */
+    void Resize(size_t n);
+
+    /**
+     * @brief Accelerations of all bodies at a trial state.
+     * @param px,py Trial positions
+     * @param pvx,pvy Trial velocities
+     * @param pspin Trial angular velocities
+     * @param ax,ay Receive linear accelerations
+     * @param alpha Receives angular accelerations
+     */
+    void Evaluate(const Real* px, const Real* py, const Real* pvx, const Real* pvy, const Real* pspin,
+        Real* ax, Real* ay, Real* alpha) const;
+};
+
+/**
+ * @class Integrator
+ * @brief Advances a BodyBatch by one time step.
+ *
+ * Implementations keep their stage arrays between steps, so stepping allocates nothing
+ * once the batch size is stable.
+ */
+class Integrator
+{
+public:
+    virtual ~Integrator() = default;
+
+    /**
+     * @brief Scheme implemented by this integrator.
+     */
+    virtual IntegratorType Type() const = 0;
+
+    /**
+     * @brief Number of acceleration evaluations per step, i.e. its relative cost.
+     */
+    virtual int EvaluationsPerStep() const = 0;
+
+    /**
+     * @brief Advance positions, velocities, angles and spins of the batch.
+     * @param batch Bodies to advance
+     * @param deltaTime Time step
+     */
+    virtual void Step(BodyBatch& batch, Real deltaTime) = 0;
+
+    /**
+     * @brief Create an integrator of the given type.
+     * @param type Scheme to create
+     */
+    static std::unique_ptr<Integrator> Create(IntegratorType type);
+
+    /**
+     * @brief Short name of a scheme ("euler", "verlet", "rk4").
+     * @param type Scheme to name
+     */
+    static const char* Name(IntegratorType type);
+
+    /**
+     * @brief Look up a scheme by its short name.
+     * @param name Name as returned by Name
+     * @param type Receives the scheme
+     * @return False if the name is unknown
+     */
+    static bool Parse(std::string_view name, IntegratorType& type);
+};
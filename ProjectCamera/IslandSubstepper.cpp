@@ -0,0 +1,102 @@
+// IslandSubstepper.cpp
+// Groups joint-connected bodies into islands and picks a CFL-style substep count for each.
+#include "IslandSubstepper.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+void IslandSubstepper::Plan(const BodyBatch& batch, const std::vector<Body*>& bodies, unsigned long long version,
+    const std::vector<Joint>& joints, bool coupled, Real deltaTime)
+{
+    size_t n = bodies.size();
+    int maxLevel = 0;
+    while ((2 << maxLevel) <= maxSubsteps) ++maxLevel;
+    levels.resize(maxLevel + 1);
+    for (int k = 0; k <= maxLevel; ++k)
+    {
+        levels[k].substeps = 1 << k;
+        levels[k].bodies.clear();
+        levels[k].jointActive.assign(joints.size(), 0);
+        levels[k].hasJoints = false;
+    }
+
+    // Islands: joints merge their dynamic ends; a coupling field merges everything
+    parent.resize(n);
+    std::iota(parent.begin(), parent.end(), 0u);
+    if (!joints.empty() && version != indexVersion) {
+        indexOf.clear();
+        for (uint32_t i = 0; i < n; ++i)
+            indexOf.emplace(bodies[i], i);
+        indexVersion = version;
+    }
+    if (coupled) {
+        std::fill(parent.begin(), parent.end(), 0u);
+    } else {
+        for (const Joint& joint : joints)
+        {
+            if (!joint.bodyB || !joint.bodyA->IsDynamic() || !joint.bodyB->IsDynamic()) continue;
+            auto a = indexOf.find(joint.bodyA), b = indexOf.find(joint.bodyB);
+            if (a == indexOf.end() || b == indexOf.end()) continue;
+            uint32_t rootA = Find(a->second), rootB = Find(b->second);
+            if (rootA != rootB) parent[std::max(rootA, rootB)] = std::min(rootA, rootB);
+        }
+    }
+
+    // Each body's request goes to its island root
+    islandSubsteps.assign(n, 1);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        Real radius = bodies[i]->compound.boundingRadius;
+        if (radius <= 0) continue; // Points have no size to tunnel through
+        Real speed = sqrt(batch.vx[i] * batch.vx[i] + batch.vy[i] * batch.vy[i])
+            + fabs(batch.spin[i]) * radius
+            + sqrt(batch.baseAx[i] * batch.baseAx[i] + batch.baseAy[i] * batch.baseAy[i]) * deltaTime;
+        Real travel = speed * deltaTime, limit = courant * radius;
+        if (travel <= limit) continue;
+        int& request = islandSubsteps[Find(i)];
+        request = std::max(request, (int)std::min<Real>(ceil(travel / limit), Real(maxSubsteps)));
+    }
+
+    // Level of every body is the power of two covering its island's request
+    islandCount = 0;
+    substeppedCount = 0;
+    levelOf.resize(n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        uint32_t root = Find(i);
+        if (root == i) ++islandCount;
+        int level = 0;
+        while (level < maxLevel && (1 << level) < islandSubsteps[root]) ++level;
+        levelOf[i] = (uint8_t)level;
+        levels[level].bodies.push_back(i);
+        if (level > 0) ++substeppedCount;
+    }
+
+    // A joint is solved with the level of its dynamic end (both ends share it when both are dynamic)
+    for (size_t j = 0; j < joints.size(); ++j)
+    {
+        int level = 0;
+        for (const Body* body : { joints[j].bodyA, joints[j].bodyB })
+        {
+            if (!body || !body->IsDynamic()) continue;
+            auto found = indexOf.find(body);
+            if (found != indexOf.end()) level = levelOf[found->second];
+        }
+        levels[level].jointActive[j] = 1;
+        levels[level].hasJoints = true;
+    }
+
+    active.clear();
+    for (const Level& level : levels)
+        if (!level.bodies.empty() || level.hasJoints) active.push_back(&level);
+}
+
+uint32_t IslandSubstepper::Find(uint32_t i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Body.h"
+#include "Integrator.h"
+#include "JointSolver.h"
+#include "globals.h"
+
+/**
+ * @class IslandSubstepper
+ * @brief Picks a substep count per island of interacting bodies, so only fast islands pay for fine steps.
+ *
+ * Dynamic bodies connected by joints form an island; kinematic and static bodies do not join
+ * islands together. Each body asks for enough substeps that it travels at most courant times
+ * its bounding radius per substep, counting linear speed, rim speed from spin and the speed
+ * gained over the step. An island takes the largest request of its bodies, rounded up to a
+ * power of two, and islands with the same count are grouped into one level.
+ * With mutual gravity every body interacts with every other, so the whole world is one island.
+ */
+class IslandSubstepper
+{
+public:
+    bool enabled = false;  ///< World::Update uses one step for everything unless enabled
+    Real courant = Real(0.25); ///< Largest fraction of its bounding radius a body may travel per substep
+    int maxSubsteps = 16;  ///< Upper bound on substeps per step (a power of two)
+
+    /// Islands advanced with the same number of substeps
+    struct Level
+    {
+        int substeps = 1;                 ///< Substeps per world step
+        std::vector<uint32_t> bodies;     ///< Batch indices of the bodies in these islands
+        std::vector<uint8_t> jointActive; ///< Per joint: both ends are in these islands
+        bool hasJoints = false;           ///< Any entry of jointActive is set
+    };
+
+    /**
+     * @brief Build islands and assign every body to a level for this step.
+     * @param batch Gathered state and per-step accelerations of the moving bodies
+     * @param bodies Body of each batch slot
+     * @param version World::version, to detect added or removed bodies
+     * @param joints Joints of the world
+     * @param coupled True if a field couples all bodies (one island)
+     * @param deltaTime Coarse step
+     */
+    void Plan(const BodyBatch& batch, const std::vector<Body*>& bodies, unsigned long long version,
+        const std::vector<Joint>& joints, bool coupled, Real deltaTime);
+
+    /**
+     * @brief Non-empty levels of the last Plan, coarsest first.
+     */
+    const std::vector<const Level*>& GetLevels() const { return active; }
+
+    size_t GetIslandCount() const { return islandCount; }          ///< Islands in the last Plan
+    size_t GetSubsteppedCount() const { return substeppedCount; }  ///< Bodies that got more than one substep
+
+private:
+    // Root of a body's island, halving paths on the way.
+    uint32_t Find(uint32_t i);
+
+    std::vector<uint32_t> parent;      ///< Union-find forest over batch indices
+    std::vector<int> islandSubsteps;   ///< Requested substeps, valid at island roots
+    std::vector<uint8_t> levelOf;      ///< Level of every batch index
+    std::unordered_map<const Body*, uint32_t> indexOf; ///< Batch index of every body, rebuilt when version changes
+    unsigned long long indexVersion = ~0ull;
+    std::vector<Level> levels;         ///< Level k has 2^k substeps
+    std::vector<const Level*> active;
+    size_t islandCount = 0;
+    size_t substeppedCount = 0;
+};
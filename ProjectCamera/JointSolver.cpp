@@ -0,0 +1,431 @@
+#include "JointSolver.h"
+#include <algorithm>
+#include <cmath>
+#include "Body.h"
+
+#if defined(__AVX2__) && !defined(PHYSICS_FIXED_POINT)
+#include <immintrin.h>
+#ifdef PHYSICS_SINGLE_PRECISION
+#define JOINT_SIMD_WIDTH 8
+#else
+#define JOINT_SIMD_WIDTH 4
+#endif
+#else
+#define JOINT_SIMD_WIDTH 1
+#endif
+
+// Colors handed out before rows spill into the serial overflow batch.
+static constexpr uint32_t MaxColors = 64;
+
+// Colors smaller than this are solved on the calling thread.
+static constexpr size_t ParallelThreshold = 1024;
+
+// Number of scalar rows a joint contributes.
+static int RowCount(JointType type)
+{
+    switch (type) {
+    case JointType::Revolute: return 2;
+    case JointType::Weld: return 3;
+    default: return 1;
+    }
+}
+
+// Express a world point in a body's local frame.
+static void ToLocal(const Body* body, Real x, Real y, Real local[2])
+{
+    Real dx = x - body->position.x, dy = y - body->position.y;
+    Real c = cos(body->rotation), s = sin(body->rotation);
+    local[0] = c * dx + s * dy;
+    local[1] = -s * dx + c * dy;
+}
+
+void JointSolver::WorldAnchors(const Joint& joint, Real anchors[4])
+{
+    const Body* a = joint.bodyA;
+    Real c = cos(a->rotation), s = sin(a->rotation);
+    anchors[0] = a->position.x + c * joint.anchorA[0] - s * joint.anchorA[1];
+    anchors[1] = a->position.y + s * joint.anchorA[0] + c * joint.anchorA[1];
+    if (const Body* b = joint.bodyB) {
+        c = cos(b->rotation); s = sin(b->rotation);
+        anchors[2] = b->position.x + c * joint.anchorB[0] - s * joint.anchorB[1];
+        anchors[3] = b->position.y + s * joint.anchorB[0] + c * joint.anchorB[1];
+    } else {
+        anchors[2] = joint.anchorB[0];
+        anchors[3] = joint.anchorB[1];
+    }
+}
+
+size_t JointSolver::Add(const Joint& joint)
+{
+    joints.push_back(joint);
+    dirty = true;
+    return joints.size() - 1;
+}
+
+size_t JointSolver::AddDistance(Body* a, Body* b, double ax, double ay, double bx, double by)
+{
+    Joint joint;
+    joint.type = JointType::Distance;
+    joint.bodyA = a;
+    joint.bodyB = b;
+    ToLocal(a, ax, ay, joint.anchorA);
+    if (b) ToLocal(b, bx, by, joint.anchorB);
+    else { joint.anchorB[0] = bx; joint.anchorB[1] = by; }
+    joint.length = hypot(bx - ax, by - ay);
+    return Add(joint);
+}
+
+size_t JointSolver::AddSpring(Body* a, Body* b, double ax, double ay, double bx, double by, double stiffness, double damping)
+{
+    size_t index = AddDistance(a, b, ax, ay, bx, by);
+    joints[index].type = JointType::Spring;
+    joints[index].stiffness = stiffness;
+    joints[index].damping = damping;
+    return index;
+}
+
+size_t JointSolver::AddRevolute(Body* a, Body* b, double x, double y)
+{
+    size_t index = AddDistance(a, b, x, y, x, y);
+    joints[index].type = JointType::Revolute;
+    return index;
+}
+
+size_t JointSolver::AddWeld(Body* a, Body* b, double x, double y)
+{
+    size_t index = AddDistance(a, b, x, y, x, y);
+    joints[index].type = JointType::Weld;
+    joints[index].referenceAngle = (b ? b->rotation : 0.0) - a->rotation;
+    return index;
+}
+
+void JointSolver::RemoveBody(const Body* body)
+{
+    auto end = std::remove_if(joints.begin(), joints.end(),
+        [body](const Joint& joint) { return joint.bodyA == body || joint.bodyB == body; });
+    if (end != joints.end()) {
+        joints.erase(end, joints.end());
+        dirty = true;
+    }
+}
+
+void JointSolver::Clear()
+{
+    joints.clear();
+    dirty = true;
+}
+
+/**
+ * @brief Assign solver slots and greedily color the rows.
+ *
+ * A row takes the lowest color not yet used by either of its bodies. The static world
+ * (slot 0) and kinematic or static bodies never block a color because they are never written. Rows that find all colors
+ * taken go into a final batch that is solved serially.
+ */
+void JointSolver::Rebuild()
+{
+    slotBody.assign(1, nullptr);
+    slotOf.clear();
+    auto slot = [this](Body* body) -> uint32_t {
+        if (!body) return 0;
+        auto inserted = slotOf.emplace(body, (uint32_t)slotBody.size());
+        if (inserted.second) slotBody.push_back(body);
+        return inserted.first->second;
+    };
+    // Kinematic and static bodies first: like the world slot they are read but never written
+    for (const Joint& joint : joints)
+        for (Body* body : { joint.bodyA, joint.bodyB })
+            if (body && !body->IsDynamic()) slot(body);
+    firstDynamicSlot = (uint32_t)slotBody.size();
+
+    std::vector<uint32_t> pendingJoint, pendingColor;
+    std::vector<uint8_t> pendingSub;
+    std::vector<int32_t> pendingA, pendingB;
+    std::vector<uint64_t> used;
+    size_t counts[MaxColors + 1] = {};
+    for (uint32_t j = 0; j < joints.size(); ++j)
+    {
+        uint32_t a = slot(joints[j].bodyA), b = slot(joints[j].bodyB);
+        used.resize(slotBody.size(), 0);
+        for (int sub = 0; sub < RowCount(joints[j].type); ++sub)
+        {
+            uint64_t taken = used[a] | used[b];
+            uint32_t color = 0;
+            while (color < MaxColors && (taken >> color) & 1) ++color;
+            if (color < MaxColors) {
+                if (a >= firstDynamicSlot) used[a] |= uint64_t(1) << color;
+                if (b >= firstDynamicSlot) used[b] |= uint64_t(1) << color;
+            }
+            pendingJoint.push_back(j);
+            pendingSub.push_back((uint8_t)sub);
+            pendingColor.push_back(color);
+            pendingA.push_back((int32_t)a);
+            pendingB.push_back((int32_t)b);
+            ++counts[color];
+        }
+    }
+
+    // Counting sort into color order, dropping empty colors
+    size_t offsets[MaxColors + 1];
+    colorStart.assign(1, 0);
+    serialColor = SIZE_MAX;
+    for (uint32_t c = 0; c <= MaxColors; ++c)
+    {
+        offsets[c] = colorStart.back();
+        if (counts[c] == 0) continue;
+        if (c == MaxColors) serialColor = colorStart.size() - 1;
+        colorStart.push_back(colorStart.back() + counts[c]);
+    }
+    size_t rowCount = pendingJoint.size();
+    rowJoint.resize(rowCount); rowSub.resize(rowCount);
+    rowA.resize(rowCount); rowB.resize(rowCount);
+    for (size_t i = 0; i < rowCount; ++i)
+    {
+        size_t r = offsets[pendingColor[i]]++;
+        rowJoint[r] = pendingJoint[i];
+        rowSub[r] = pendingSub[i];
+        rowA[r] = pendingA[i];
+        rowB[r] = pendingB[i];
+    }
+    normalX.resize(rowCount); normalY.resize(rowCount);
+    armA.resize(rowCount); armB.resize(rowCount);
+    rowMass.resize(rowCount); rowBias.resize(rowCount);
+    rowGamma.resize(rowCount); rowImpulse.resize(rowCount);
+    dirty = false;
+}
+
+/**
+ * @brief Gather body velocities and build this step's rows, then warm start them.
+ *
+ * Rigid rows use Baumgarte feedback on the position error. Springs are soft rows:
+ * with stiffness k and damping c, gamma = 1 / (dt (c + dt k)) softens the effective
+ * mass and the bias pulls with dt k gamma times the stretch.
+ */
+void JointSolver::Prepare(Real deltaTime, const std::vector<uint8_t>* jointActive)
+{
+    size_t slotCount = slotBody.size();
+    velX.assign(slotCount, 0.0); velY.assign(slotCount, 0.0); angVel.assign(slotCount, 0.0);
+    invMass.assign(slotCount, 0.0); invInertia.assign(slotCount, 0.0);
+    for (size_t s = 1; s < slotCount; ++s)
+    {
+        const Body* body = slotBody[s];
+        velX[s] = body->velocity.x;
+        velY[s] = body->velocity.y;
+        angVel[s] = body->angular_vel;
+        invMass[s] = body->InverseMass();
+        invInertia[s] = body->InverseInertia();
+    }
+
+    for (size_t r = 0; r < rowJoint.size(); ++r)
+    {
+        if (jointActive && !(*jointActive)[rowJoint[r]]) {
+            // A zero-mass row never produces an impulse, so the batches stay uniform
+            normalX[r] = normalY[r] = armA[r] = armB[r] = 0;
+            rowMass[r] = rowBias[r] = rowGamma[r] = rowImpulse[r] = 0;
+            continue;
+        }
+        const Joint& joint = joints[rowJoint[r]];
+        const int sub = rowSub[r];
+        const Body* a = joint.bodyA;
+        const Body* b = joint.bodyB;
+        Real anchors[4];
+        WorldAnchors(joint, anchors);
+        Real rax = anchors[0] - a->position.x, ray = anchors[1] - a->position.y;
+        Real rbx = b ? anchors[2] - b->position.x : 0.0, rby = b ? anchors[3] - b->position.y : 0.0;
+        Real dx = anchors[2] - anchors[0], dy = anchors[3] - anchors[1];
+
+        Real nx = 0.0, ny = 0.0, error = 0.0;
+        Real ja = 0.0, jb = 0.0;
+        if (joint.type == JointType::Distance || joint.type == JointType::Spring) {
+            Real length = sqrt(dx * dx + dy * dy);
+            if (length > 1e-9) { nx = dx / length; ny = dy / length; }
+            else { nx = 1.0; }
+            error = length - joint.length;
+        } else if (sub < 2) {
+            nx = sub == 0 ? 1.0 : 0.0;
+            ny = sub == 0 ? 0.0 : 1.0;
+            error = sub == 0 ? dx : dy;
+        } else {
+            // Weld angle row: only angular velocities take part
+            ja = 1.0; jb = 1.0;
+            error = (b ? b->rotation : 0.0) - a->rotation - joint.referenceAngle;
+        }
+        if (nx != 0.0 || ny != 0.0) {
+            ja = rax * ny - ray * nx;
+            jb = rbx * ny - rby * nx;
+        }
+
+        int32_t sa = rowA[r], sb = rowB[r];
+        Real k = (invMass[sa] + invMass[sb]) * (nx * nx + ny * ny)
+            + invInertia[sa] * ja * ja + invInertia[sb] * jb * jb;
+        Real gamma = 0.0, bias = 0.0;
+        if (joint.type == JointType::Spring) {
+            Real soft = deltaTime * (joint.damping + deltaTime * joint.stiffness);
+            if (soft > 0.0) {
+                gamma = 1.0 / soft;
+                bias = error * deltaTime * joint.stiffness * gamma;
+            } else {
+                k = 0.0; // a spring with no stiffness and no damping does nothing
+            }
+        } else {
+            bias = baumgarte / deltaTime * error;
+        }
+
+        normalX[r] = nx; normalY[r] = ny;
+        armA[r] = ja; armB[r] = jb;
+        rowMass[r] = k + gamma > 0.0 ? 1.0 / (k + gamma) : 0.0;
+        rowBias[r] = bias;
+        rowGamma[r] = gamma;
+
+        // Warm start with last step's impulse
+        Real impulse = rowMass[r] > 0 ? joint.impulse[sub] : 0;
+        rowImpulse[r] = impulse;
+        velX[sa] -= nx * impulse * invMass[sa]; velY[sa] -= ny * impulse * invMass[sa];
+        angVel[sa] -= ja * impulse * invInertia[sa];
+        velX[sb] += nx * impulse * invMass[sb]; velY[sb] += ny * impulse * invMass[sb];
+        angVel[sb] += jb * impulse * invInertia[sb];
+    }
+}
+
+/**
+ * @brief One Gauss-Seidel pass over a range of rows.
+ *
+ * Rows of one color never share a dynamic body, so with simd set eight (float) or four
+ * (double) of them are solved at once: body state is gathered into AVX2 lanes and
+ * scattered back lane by lane.
+ * The world, kinematic and static slots are never written.
+ */
+void JointSolver::SolveRows(size_t begin, size_t end, bool simd)
+{
+    Real* vx = velX.data();
+    Real* vy = velY.data();
+    Real* w = angVel.data();
+    const Real* im = invMass.data();
+    const Real* ii = invInertia.data();
+    const int32_t firstDynamic = (int32_t)firstDynamicSlot;
+    size_t i = begin;
+#if JOINT_SIMD_WIDTH == 8
+    for (; simd && i + 8 <= end; i += 8)
+    {
+        __m256i ia = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowA.data() + i));
+        __m256i ib = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowB.data() + i));
+        __m256 vxa = _mm256_i32gather_ps(vx, ia, 4), vya = _mm256_i32gather_ps(vy, ia, 4);
+        __m256 wa = _mm256_i32gather_ps(w, ia, 4);
+        __m256 vxb = _mm256_i32gather_ps(vx, ib, 4), vyb = _mm256_i32gather_ps(vy, ib, 4);
+        __m256 wb = _mm256_i32gather_ps(w, ib, 4);
+        __m256 nx = _mm256_loadu_ps(normalX.data() + i), ny = _mm256_loadu_ps(normalY.data() + i);
+        __m256 ja = _mm256_loadu_ps(armA.data() + i), jb = _mm256_loadu_ps(armB.data() + i);
+        __m256 impulse = _mm256_loadu_ps(rowImpulse.data() + i);
+
+        __m256 cdot = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(nx, _mm256_sub_ps(vxb, vxa)), _mm256_mul_ps(ny, _mm256_sub_ps(vyb, vya))),
+            _mm256_sub_ps(_mm256_mul_ps(jb, wb), _mm256_mul_ps(ja, wa)));
+        __m256 rhs = _mm256_add_ps(_mm256_add_ps(cdot, _mm256_loadu_ps(rowBias.data() + i)),
+            _mm256_mul_ps(_mm256_loadu_ps(rowGamma.data() + i), impulse));
+        __m256 delta = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(_mm256_loadu_ps(rowMass.data() + i), rhs));
+        _mm256_storeu_ps(rowImpulse.data() + i, _mm256_add_ps(impulse, delta));
+
+        __m256 ima = _mm256_i32gather_ps(im, ia, 4), iia = _mm256_i32gather_ps(ii, ia, 4);
+        __m256 imb = _mm256_i32gather_ps(im, ib, 4), iib = _mm256_i32gather_ps(ii, ib, 4);
+        __m256 px = _mm256_mul_ps(nx, delta), py = _mm256_mul_ps(ny, delta);
+        alignas(32) float out[6][8];
+        _mm256_store_ps(out[0], _mm256_sub_ps(vxa, _mm256_mul_ps(px, ima)));
+        _mm256_store_ps(out[1], _mm256_sub_ps(vya, _mm256_mul_ps(py, ima)));
+        _mm256_store_ps(out[2], _mm256_sub_ps(wa, _mm256_mul_ps(_mm256_mul_ps(ja, delta), iia)));
+        _mm256_store_ps(out[3], _mm256_add_ps(vxb, _mm256_mul_ps(px, imb)));
+        _mm256_store_ps(out[4], _mm256_add_ps(vyb, _mm256_mul_ps(py, imb)));
+        _mm256_store_ps(out[5], _mm256_add_ps(wb, _mm256_mul_ps(_mm256_mul_ps(jb, delta), iib)));
+        for (int lane = 0; lane < 8; ++lane)
+        {
+            int32_t a = rowA[i + lane], b = rowB[i + lane];
+            if (a >= firstDynamic) { vx[a] = out[0][lane]; vy[a] = out[1][lane]; w[a] = out[2][lane]; }
+            if (b >= firstDynamic) { vx[b] = out[3][lane]; vy[b] = out[4][lane]; w[b] = out[5][lane]; }
+        }
+    }
+#elif JOINT_SIMD_WIDTH == 4
+    for (; simd && i + 4 <= end; i += 4)
+    {
+        __m128i ia = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rowA.data() + i));
+        __m128i ib = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rowB.data() + i));
+        __m256d vxa = _mm256_i32gather_pd(vx, ia, 8), vya = _mm256_i32gather_pd(vy, ia, 8);
+        __m256d wa = _mm256_i32gather_pd(w, ia, 8);
+        __m256d vxb = _mm256_i32gather_pd(vx, ib, 8), vyb = _mm256_i32gather_pd(vy, ib, 8);
+        __m256d wb = _mm256_i32gather_pd(w, ib, 8);
+        __m256d nx = _mm256_loadu_pd(normalX.data() + i), ny = _mm256_loadu_pd(normalY.data() + i);
+        __m256d ja = _mm256_loadu_pd(armA.data() + i), jb = _mm256_loadu_pd(armB.data() + i);
+        __m256d impulse = _mm256_loadu_pd(rowImpulse.data() + i);
+
+        __m256d cdot = _mm256_add_pd(
+            _mm256_add_pd(_mm256_mul_pd(nx, _mm256_sub_pd(vxb, vxa)), _mm256_mul_pd(ny, _mm256_sub_pd(vyb, vya))),
+            _mm256_sub_pd(_mm256_mul_pd(jb, wb), _mm256_mul_pd(ja, wa)));
+        __m256d rhs = _mm256_add_pd(_mm256_add_pd(cdot, _mm256_loadu_pd(rowBias.data() + i)),
+            _mm256_mul_pd(_mm256_loadu_pd(rowGamma.data() + i), impulse));
+        __m256d delta = _mm256_sub_pd(_mm256_setzero_pd(), _mm256_mul_pd(_mm256_loadu_pd(rowMass.data() + i), rhs));
+        _mm256_storeu_pd(rowImpulse.data() + i, _mm256_add_pd(impulse, delta));
+
+        __m256d ima = _mm256_i32gather_pd(im, ia, 8), iia = _mm256_i32gather_pd(ii, ia, 8);
+        __m256d imb = _mm256_i32gather_pd(im, ib, 8), iib = _mm256_i32gather_pd(ii, ib, 8);
+        __m256d px = _mm256_mul_pd(nx, delta), py = _mm256_mul_pd(ny, delta);
+        alignas(32) double out[6][4];
+        _mm256_store_pd(out[0], _mm256_sub_pd(vxa, _mm256_mul_pd(px, ima)));
+        _mm256_store_pd(out[1], _mm256_sub_pd(vya, _mm256_mul_pd(py, ima)));
+        _mm256_store_pd(out[2], _mm256_sub_pd(wa, _mm256_mul_pd(_mm256_mul_pd(ja, delta), iia)));
+        _mm256_store_pd(out[3], _mm256_add_pd(vxb, _mm256_mul_pd(px, imb)));
+        _mm256_store_pd(out[4], _mm256_add_pd(vyb, _mm256_mul_pd(py, imb)));
+        _mm256_store_pd(out[5], _mm256_add_pd(wb, _mm256_mul_pd(_mm256_mul_pd(jb, delta), iib)));
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            int32_t a = rowA[i + lane], b = rowB[i + lane];
+            if (a >= firstDynamic) { vx[a] = out[0][lane]; vy[a] = out[1][lane]; w[a] = out[2][lane]; }
+            if (b >= firstDynamic) { vx[b] = out[3][lane]; vy[b] = out[4][lane]; w[b] = out[5][lane]; }
+        }
+    }
+#else
+    (void)simd;
+#endif
+    for (; i < end; ++i)
+    {
+        int32_t a = rowA[i], b = rowB[i];
+        Real nx = normalX[i], ny = normalY[i], ja = armA[i], jb = armB[i];
+        Real cdot = nx * (vx[b] - vx[a]) + ny * (vy[b] - vy[a]) + jb * w[b] - ja * w[a];
+        Real delta = -rowMass[i] * (cdot + rowBias[i] + rowGamma[i] * rowImpulse[i]);
+        rowImpulse[i] += delta;
+        if (a >= firstDynamic) { vx[a] -= nx * delta * im[a]; vy[a] -= ny * delta * im[a]; w[a] -= ja * delta * ii[a]; }
+        if (b >= firstDynamic) { vx[b] += nx * delta * im[b]; vy[b] += ny * delta * im[b]; w[b] += jb * delta * ii[b]; }
+    }
+}
+
+void JointSolver::Solve(Real deltaTime, ThreadPool* pool, const std::vector<uint8_t>* jointActive)
+{
+    if (joints.empty()) return;
+    if (dirty) Rebuild();
+    Prepare(deltaTime, jointActive);
+
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        for (size_t c = 0; c + 1 < colorStart.size(); ++c)
+        {
+            size_t begin = colorStart[c], end = colorStart[c + 1];
+            if (c == serialColor)
+                SolveRows(begin, end, false); // Overflow rows may share bodies
+            else if (pool && end - begin >= ParallelThreshold)
+                pool->ParallelFor(end - begin, 256, [this, begin](size_t first, size_t last) {
+                    SolveRows(begin + first, begin + last, true);
+                });
+            else
+                SolveRows(begin, end, true);
+        }
+    }
+
+    // Keep impulses for warm starting and hand the velocities back to the bodies
+    for (size_t r = 0; r < rowJoint.size(); ++r)
+        if (!jointActive || (*jointActive)[rowJoint[r]])
+            joints[rowJoint[r]].impulse[rowSub[r]] = rowImpulse[r];
+    for (size_t s = firstDynamicSlot; s < slotBody.size(); ++s)
+    {
+        Body* body = slotBody[s];
+        body->velocity.x = velX[s];
+        body->velocity.y = velY[s];
+        body->angular_vel = angVel[s];
+    }
+}
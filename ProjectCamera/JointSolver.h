@@ -0,0 +1,157 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "ThreadPool.h"
+#include "globals.h"
+
+class Body;
+
+/**
+ * @enum JointType
+ * @brief Kinds of constraint a Joint can express.
+ */
+enum class JointType : uint8_t
+{
+    Distance, ///< Keeps two anchors at a fixed distance
+    Revolute, ///< Pins two anchors together, free rotation
+    Weld,     ///< Pins two anchors together and locks the relative angle
+    Spring    ///< Damped spring between two anchors
+};
+
+/**
+ * @struct Joint
+ * @brief Connection between two bodies, or between a body and a fixed world point.
+ */
+struct Joint
+{
+    JointType type = JointType::Distance;
+    Body* bodyA = nullptr;            ///< First body (never null)
+    Body* bodyB = nullptr;            ///< Second body, or null to attach to the world
+    Real anchorA[2] = { 0, 0 };       ///< Anchor on A in A's local frame
+    Real anchorB[2] = { 0, 0 };       ///< Anchor on B in B's local frame, or a world point if bodyB is null
+    Real length = 0.0;                ///< Rest length (Distance, Spring)
+    Real referenceAngle = 0.0;        ///< Relative angle B - A to hold (Weld)
+    Real stiffness = 0.0;             ///< Spring constant (Spring)
+    Real damping = 0.0;               ///< Damping coefficient (Spring)
+    Real impulse[3] = { 0, 0, 0 };    ///< Accumulated impulses, reused to warm start the next step
+};
+
+/**
+ * @class JointSolver
+ * @brief Batched sequential-impulse solver for joints.
+ *
+ * Every joint is split into one to three scalar constraint rows. Rows are graph-colored
+ * so that no two rows of the same color touch the same dynamic body; each color is then
+ * solved in parallel on the thread pool, eight (float) or four (double) rows at a time
+ * with AVX2, without locks.
+ * Colors only change when joints are added or removed. Body velocities are gathered into
+ * flat arrays for the solve and written back once at the end.
+ */
+class JointSolver
+{
+public:
+    int iterations = 8;      ///< Velocity iterations per step
+    Real baumgarte = 0.2;    ///< Fraction of position error corrected per step (rigid joints)
+
+    /**
+     * @brief Connect two anchors with a rigid rod of their current length.
+     * @param a First body
+     * @param b Second body, or null for a world anchor
+     * @param ax,ay World position of the anchor on A
+     * @param bx,by World position of the anchor on B (or the world point)
+     * @return Index of the new joint
+     */
+    size_t AddDistance(Body* a, Body* b, double ax, double ay, double bx, double by);
+
+    /**
+     * @brief Connect two anchors with a damped spring whose rest length is their current distance.
+     * @param a First body
+     * @param b Second body, or null for a world anchor
+     * @param ax,ay World position of the anchor on A
+     * @param bx,by World position of the anchor on B (or the world point)
+     * @param stiffness Spring constant
+     * @param damping Damping coefficient
+     * @return Index of the new joint
+     */
+    size_t AddSpring(Body* a, Body* b, double ax, double ay, double bx, double by, double stiffness, double damping);
+
+    /**
+     * @brief Pin two bodies together at a world point, leaving rotation free.
+     * @param a First body
+     * @param b Second body, or null to pin A to the world
+     * @param x,y World position of the pin
+     * @return Index of the new joint
+     */
+    size_t AddRevolute(Body* a, Body* b, double x, double y);
+
+    /**
+     * @brief Glue two bodies together at a world point, keeping their current relative angle.
+     * @param a First body
+     * @param b Second body, or null to fix A to the world
+     * @param x,y World position of the weld point
+     * @return Index of the new joint
+     */
+    size_t AddWeld(Body* a, Body* b, double x, double y);
+
+    /**
+     * @brief Drop every joint attached to a body that is about to be destroyed.
+     * @param body Body being removed
+     */
+    void RemoveBody(const Body* body);
+
+    /**
+     * @brief Remove all joints.
+     */
+    void Clear();
+
+    /**
+     * @brief Apply joint impulses to body velocities (between velocity and position integration).
+     * @param deltaTime Time step
+     * @param pool Pool for the per-color batches, or null to solve on the calling thread
+     * @param jointActive Optional per-joint flags; joints not set are skipped and keep their warm-start impulses
+     */
+    void Solve(Real deltaTime, ThreadPool* pool, const std::vector<uint8_t>* jointActive = nullptr);
+
+    /**
+     * @brief World positions of both anchors of a joint.
+     * @param joint Joint to evaluate
+     * @param anchors Receives ax, ay, bx, by
+     */
+    static void WorldAnchors(const Joint& joint, Real anchors[4]);
+
+    const std::vector<Joint>& GetJoints() const { return joints; }
+    size_t GetRowCount() const { return rowJoint.size(); }
+    size_t GetColorCount() const { return colorStart.empty() ? 0 : colorStart.size() - 1; }
+
+private:
+    // Add a joint and mark the coloring stale.
+    size_t Add(const Joint& joint);
+
+    // Assign solver slots to bodies and color all rows (only after joints change).
+    void Rebuild();
+
+    // Gather body state and fill per-row Jacobians, masses and biases for this step; inactive rows get zero mass.
+    void Prepare(Real deltaTime, const std::vector<uint8_t>* jointActive);
+
+    // Solve rows [begin, end) once; with simd set, rows in the range must not share dynamic bodies.
+    void SolveRows(size_t begin, size_t end, bool simd);
+
+    std::vector<Joint> joints;
+    bool dirty = true; ///< Joints changed since the last coloring
+
+    // Solver bodies (slot 0 is the static world, then kinematic and static bodies)
+    std::vector<Body*> slotBody;
+    uint32_t firstDynamicSlot = 1;   ///< Slots below this are read-only
+    std::unordered_map<const Body*, uint32_t> slotOf;
+    std::vector<Real> velX, velY, angVel, invMass, invInertia;
+
+    // Rows in color order; colorStart[c]..colorStart[c+1] is color c
+    std::vector<uint32_t> rowJoint;   ///< Joint each row belongs to
+    std::vector<uint8_t> rowSub;      ///< Which row of the joint (0..2)
+    std::vector<size_t> colorStart;
+    size_t serialColor = SIZE_MAX;    ///< Color holding overflow rows that must run serially
+    std::vector<int32_t> rowA, rowB;  ///< Body slots
+    std::vector<Real> normalX, normalY, armA, armB; ///< Jacobian: n, rA x n, rB x n
+    std::vector<Real> rowMass, rowBias, rowGamma, rowImpulse;
+};
@@ -4,7 +4,7 @@
  * @brief Construct a new Matrix object representing a 2D rotation matrix.
  * @param rad Angle in radians for the rotation.
  */
-Matrix::Matrix(double rad)
+Matrix::Matrix(Real rad)
 {
     set(rad); // Initialize matrix with rotation angle
 }
@@ -21,9 +21,9 @@ Matrix::~Matrix()
  * @brief Set the matrix to represent a rotation by the given angle.
  * @param rad Angle in radians.
  */
-void Matrix::set(double rad) {
-    double c = cos(rad); // Cosine of angle
-    double s = sin(rad); // Sine of angle
+void Matrix::set(Real rad) {
+    Real c = cos(rad); // Cosine of angle
+    Real s = sin(rad); // Sine of angle
     components[0] = c;   // Row 1, Col 1
     components[1] = -s;  // Row 1, Col 2
     components[2] = s;   // Row 2, Col 1
@@ -2,12 +2,13 @@
 #include<cmath>
 #include<algorithm>
 #include"Vector.h"
+#include "globals.h"
 class Matrix
 {
 public:
-	Matrix(double rad);
+	Matrix(Real rad);
 	~Matrix();
-	void set(double rad);
+	void set(Real rad);
 	Matrix transpose();
 	void transposeThis();
 	Matrix operator*(Matrix rhs);
@@ -21,6 +22,6 @@ public:
 		);
 		return V;
 	}
-	double components[4];
-	double angle;
+	Real components[4];
+	Real angle;
 };
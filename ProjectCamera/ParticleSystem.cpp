@@ -0,0 +1,165 @@
+#include "ParticleSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "globals.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PARTICLE_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLE_SIMD_WIDTH 4
+#else
+#define PARTICLE_SIMD_WIDTH 1
+#endif
+
+/**
+ * @brief Integrate a range of particles: v = v * damping + g * dt, p += v * dt, life -= dt.
+ *
+ * Processes 8 (AVX2) or 4 (SSE2) particles per iteration, with a scalar tail.
+ */
+static void IntegrateRange(float* px, float* py, float* vx, float* vy, float* life,
+    size_t begin, size_t end, float gx, float gy, float damping, float dt)
+{
+    size_t i = begin;
+#if PARTICLE_SIMD_WIDTH == 8
+    const __m256 vdt = _mm256_set1_ps(dt), vdamp = _mm256_set1_ps(damping);
+    const __m256 vgx = _mm256_set1_ps(gx * dt), vgy = _mm256_set1_ps(gy * dt);
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 velx = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(vx + i), vdamp), vgx);
+        __m256 vely = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(vy + i), vdamp), vgy);
+        _mm256_storeu_ps(vx + i, velx);
+        _mm256_storeu_ps(vy + i, vely);
+        _mm256_storeu_ps(px + i, _mm256_add_ps(_mm256_loadu_ps(px + i), _mm256_mul_ps(velx, vdt)));
+        _mm256_storeu_ps(py + i, _mm256_add_ps(_mm256_loadu_ps(py + i), _mm256_mul_ps(vely, vdt)));
+        _mm256_storeu_ps(life + i, _mm256_sub_ps(_mm256_loadu_ps(life + i), vdt));
+    }
+#elif PARTICLE_SIMD_WIDTH == 4
+    const __m128 vdt = _mm_set1_ps(dt), vdamp = _mm_set1_ps(damping);
+    const __m128 vgx = _mm_set1_ps(gx * dt), vgy = _mm_set1_ps(gy * dt);
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 velx = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(vx + i), vdamp), vgx);
+        __m128 vely = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(vy + i), vdamp), vgy);
+        _mm_storeu_ps(vx + i, velx);
+        _mm_storeu_ps(vy + i, vely);
+        _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(velx, vdt)));
+        _mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(vely, vdt)));
+        _mm_storeu_ps(life + i, _mm_sub_ps(_mm_loadu_ps(life + i), vdt));
+    }
+#endif
+    for (; i < end; ++i)
+    {
+        vx[i] = vx[i] * damping + gx * dt;
+        vy[i] = vy[i] * damping + gy * dt;
+        px[i] += vx[i] * dt;
+        py[i] += vy[i] * dt;
+        life[i] -= dt;
+    }
+}
+
+// Reserve storage so emitting up to the given count does not reallocate.
+void ParticleSystem::Reserve(size_t capacity)
+{
+    posX.reserve(capacity); posY.reserve(capacity);
+    velX.reserve(capacity); velY.reserve(capacity);
+    life.reserve(capacity);
+}
+
+// Uniform random float in [0, 1) from a xorshift32 generator.
+float ParticleSystem::Random()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (rngState >> 8) * (1.0f / 16777216.0f);
+}
+
+// Emit a burst of particles from one point with random directions and speeds.
+void ParticleSystem::Emit(float x, float y, size_t count, float speed, float lifetime)
+{
+    const float expiry = lifetime > 0.0f ? lifetime : std::numeric_limits<float>::infinity();
+    anyLifetime = anyLifetime || lifetime > 0.0f;
+    size_t first = Count();
+    posX.resize(first + count, x);
+    posY.resize(first + count, y);
+    velX.resize(first + count);
+    velY.resize(first + count);
+    life.resize(first + count, expiry);
+    for (size_t i = first; i < first + count; ++i)
+    {
+        float angle = (float)(2.0 * PI) * Random();
+        float s = speed * Random();
+        velX[i] = s * std::cos(angle);
+        velY[i] = s * std::sin(angle);
+    }
+}
+
+// Run emitters, integrate all particles in parallel chunks and drop expired ones.
+void ParticleSystem::Update(float deltaTime, ThreadPool* pool)
+{
+    // Emit whole particles from every emitter, carrying the fraction over
+    for (auto& emitter : emitters)
+    {
+        emitter.pending += emitter.rate * deltaTime;
+        size_t count = (size_t)emitter.pending;
+        emitter.pending -= (float)count;
+        if (count > 0)
+            Emit(emitter.x, emitter.y, count, emitter.speed, emitter.lifetime);
+    }
+
+    size_t n = Count();
+    if (n == 0) return;
+    const float damping = std::max(0.0f, 1.0f - drag * deltaTime);
+    float* px = posX.data(); float* py = posY.data();
+    float* vx = velX.data(); float* vy = velY.data();
+    float* lf = life.data();
+    auto integrate = [&](size_t begin, size_t end) {
+        IntegrateRange(px, py, vx, vy, lf, begin, end, gravityX, gravityY, damping, deltaTime);
+    };
+    if (pool) pool->ParallelFor(n, 1 << 15, integrate);
+    else integrate(0, n);
+
+    // Swap-remove expired particles (order is irrelevant for points)
+    // and re-arm the flag only while a finite lifetime survives
+    if (!anyLifetime) return;
+    bool finite = false;
+    for (size_t i = 0; i < n;)
+    {
+        if (life[i] > 0.0f)
+        {
+            finite = finite || life[i] != std::numeric_limits<float>::infinity();
+            ++i;
+            continue;
+        }
+        --n;
+        posX[i] = posX[n]; posY[i] = posY[n];
+        velX[i] = velX[n]; velY[i] = velY[n];
+        life[i] = life[n];
+    }
+    anyLifetime = finite;
+    posX.resize(n); posY.resize(n);
+    velX.resize(n); velY.resize(n);
+    life.resize(n);
+}
+
+// Interleave positions into a point array for one batched SDL_RenderPoints call.
+void ParticleSystem::CopyPoints(std::vector<SDL_FPoint>& points) const
+{
+    size_t n = Count();
+    points.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        points[i] = { posX[i], posY[i] };
+}
+
+// Remove all particles and emitters.
+void ParticleSystem::Clear()
+{
+    posX.clear(); posY.clear();
+    velX.clear(); velY.clear();
+    life.clear();
+    emitters.clear();
+    anyLifetime = false;
+}
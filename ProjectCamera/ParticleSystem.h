@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <SDL3/SDL.h>
+#include "ThreadPool.h"
+
+/**
+ * @struct ParticleEmitter
+ * @brief Continuous source of particles, emitted in batches once per step.
+ */
+struct ParticleEmitter
+{
+    float x = 0.0f, y = 0.0f; ///< Emission point
+    float rate = 0.0f;        ///< Particles per second
+    float speed = 50.0f;      ///< Initial speed
+    float lifetime = 0.0f;    ///< Seconds each particle lives, 0 for forever
+    float pending = 0.0f;     ///< Fractional particles carried to the next step
+};
+
+/**
+ * @class ParticleSystem
+ * @brief Shape-less point particles stored as structure-of-arrays.
+ *
+ * Particles have no rotation, mass, shapes or collision; they only carry position,
+ * velocity and an optional remaining lifetime, so millions of them fit in cache-friendly
+ * float arrays that a SIMD kernel integrates in place.
+ */
+class ParticleSystem
+{
+public:
+    std::vector<float> posX, posY; ///< Positions
+    std::vector<float> velX, velY; ///< Velocities
+    std::vector<float> life;       ///< Remaining lifetime in seconds (infinity for forever)
+    std::vector<ParticleEmitter> emitters; ///< Continuous emitters
+
+    float gravityX = 0.0f, gravityY = 0.0f; ///< Uniform acceleration applied to all particles
+    float drag = 0.0f;                      ///< Linear velocity damping per second
+
+    /**
+     * @brief Number of live particles.
+     * @return Particle count
+     */
+    size_t Count() const { return posX.size(); }
+
+    /**
+     * @brief Reserve storage so emitting up to the given count does not reallocate.
+     * @param capacity Number of particles
+     */
+    void Reserve(size_t capacity);
+
+    /**
+     * @brief Emit a burst of particles from one point in random directions.
+     * @param x Emission point X
+     * @param y Emission point Y
+     * @param count Number of particles
+     * @param speed Maximum initial speed
+     * @param lifetime Seconds each particle lives, 0 for forever
+     */
+    void Emit(float x, float y, size_t count, float speed, float lifetime);
+
+    /**
+     * @brief Run emitters, integrate all particles and drop expired ones.
+     * @param deltaTime Time step in seconds
+     * @param pool Thread pool for the integration kernel (nullptr runs serially)
+     */
+    void Update(float deltaTime, ThreadPool* pool);
+
+    /**
+     * @brief Copy positions into an interleaved point array for batched rendering.
+     * @param points Receives one point per particle (reused, resized to Count())
+     */
+    void CopyPoints(std::vector<SDL_FPoint>& points) const;
+
+    /**
+     * @brief Remove all particles and emitters.
+     */
+    void Clear();
+
+private:
+    // Uniform random float in [0, 1) from a cheap xorshift generator.
+    float Random();
+
+    uint32_t rngState = 0x9E3779B9u; ///< xorshift32 state
+    bool anyLifetime = false;        ///< Skip the expiry sweep while no particle can expire
+};
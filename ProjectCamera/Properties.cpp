@@ -2,69 +2,147 @@
 #include <SDL3/SDL.h>
 #include <SDL3_ttf/SDL_ttf.h>
 #include <string>
+#include <cmath>
+#include <cstring>
+#include "Simulation.h"
 
-void Properties::Init(const std::vector<Vector<double>>& points) {
-    propertiesWindow = ConvexPolygon(points);
+// Digits printed by std::to_string for doubles; values closer than this look identical
+static const double PrintScale = 1e6;
+
+Properties::~Properties() {
+    if (panelTexture) SDL_DestroyTexture(panelTexture);
 }
 
-// Ensure selectedBody is set to the first element in world if not set
-void Properties::EnsureSelectedBody(World& world) {
-    if (!selectedBody) {
-        if (!world.bodies.empty()) {
-            selectedBody = world.bodies.front().get();
-        }
-    } else {
-        // If selectedBody is not in world anymore, reset to first
-        bool found = false;
-        for (auto& b : world.bodies) {
-            if (b.get() == selectedBody) {
-                found = true;
-                break;
-            }
-        }
-        if (!found && !world.bodies.empty()) {
-            selectedBody = world.bodies.front().get();
-        } else if (!found) {
-            selectedBody = nullptr;
-        }
+void Properties::Init(const std::vector<Vector<Real>>& points) {
+    propertiesWindow = ConvexPolygon(points);
+    // Cache the bounding box; it only changes when the layout does
+    double minX = 0, maxX = 0, minY = 0, maxY = 0;
+    if (!points.empty()) {
+        minX = maxX = double(points[0].x);
+        minY = maxY = double(points[0].y);
     }
+    for (const auto& v : points) {
+        minX = std::min(minX, double(v.x));
+        maxX = std::max(maxX, double(v.x));
+        minY = std::min(minY, double(v.y));
+        maxY = std::max(maxY, double(v.y));
+    }
+    panelBounds = { (float)minX, (float)minY, (float)(maxX - minX), (float)(maxY - minY) };
+    panelDirty = true;
 }
 
-void Properties::Update(World& world) {
-    // Ensure selectedBody is always set to the first body if not set or if invalid
-    if (!selectedBody || world.bodies.empty()) {
-        if (!world.bodies.empty()) {
-            selectedBody = world.bodies.front().get();
-        } else {
-            selectedBody = nullptr;
-        }
-    } else {
-        // If selectedBody is not in world anymore, reset to first
-        bool found = false;
-        for (auto& b : world.bodies) {
-            if (b.get() == selectedBody) {
-                found = true;
-                break;
-            }
-        }
-        if (!found && !world.bodies.empty()) {
-            selectedBody = world.bodies.front().get();
-        } else if (!found) {
-            selectedBody = nullptr;
-        }
+bool Properties::DisplayedValues::operator==(const DisplayedValues& other) const {
+    return valid == other.valid && index == other.index && total == other.total &&
+        std::memcmp(values, other.values, sizeof(values)) == 0;
+}
+
+Properties::DisplayedValues Properties::CaptureValues(const RenderSnapshot& snapshot) const {
+    DisplayedValues shown;
+    shown.valid = snapshot.watched.valid;
+    shown.index = selectedIndex;
+    shown.total = totalBodies;
+    if (!shown.valid) return shown;
+    const WatchedBodySnapshot& selected = snapshot.watched;
+    const double raw[7] = { double(selected.position.x), double(selected.position.y),
+        double(selected.velocity.x), double(selected.velocity.y), selected.mass, selected.friction, selected.restitution };
+    for (int i = 0; i < 7; ++i)
+        shown.values[i] = std::nearbyint(raw[i] * PrintScale);
+    return shown;
+}
+
+void Properties::Render(SDL_Renderer* renderer, TTF_Font* font, const RenderSnapshot& snapshot) {
+    // Take the selection as resolved by the simulation (it falls back to the first body if invalid) once it covers the last click
+    Update(snapshot);
+    if (propertiesWindow.vertices.size() != 4) return;
+    DisplayedValues current = CaptureValues(snapshot);
+    int width = (int)panelBounds.w + 1, height = (int)panelBounds.h + 1; // +1 keeps the far border inside
+    if (!panelTexture || textureRenderer != renderer || textureWidth != width || textureHeight != height) {
+        if (panelTexture) SDL_DestroyTexture(panelTexture);
+        panelTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!panelTexture) return;
+        SDL_SetTextureBlendMode(panelTexture, SDL_BLENDMODE_NONE); // Opaque panel, as when drawn directly
+        textureRenderer = renderer;
+        textureWidth = width;
+        textureHeight = height;
+        panelDirty = true;
+    }
+    if (panelDirty || !(current == shownValues)) {
+        SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+        SDL_SetRenderTarget(renderer, panelTexture);
+        RedrawPanel(renderer, font, snapshot);
+        SDL_SetRenderTarget(renderer, previousTarget);
+        shownValues = current;
+        panelDirty = false;
     }
+    SDL_FRect dst = { panelBounds.x, panelBounds.y, (float)width, (float)height };
+    SDL_RenderTexture(renderer, panelTexture, NULL, &dst);
+}
+
+void Properties::RedrawPanel(SDL_Renderer* renderer, TTF_Font* font, const RenderSnapshot& snapshot) {
+    const WatchedBodySnapshot& selected = snapshot.watched;
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    // Draw the rectangle window (filled background)
+    SDL_FRect rect = { 0.0f, 0.0f, panelBounds.w, panelBounds.h };
+    SDL_SetRenderDrawColor(renderer, 30, 30, 30, 220);
+    SDL_RenderFillRect(renderer, &rect);
+    // Draw the border along the vertices, shifted into texture space
+    Vector<Real> origin(2);
+    origin.set(-panelBounds.x, -panelBounds.y);
+    propertiesWindow.Render(origin, renderer);
+    if (!selected.valid || !font) return;
+    // Draw properties as text inside the rectangle
+    int x = 10, y = 10, lineHeight = 22;
+    SDL_Color color = { 255, 255, 255, 255 };
+    auto renderText = [&](const std::string& text, int tx, int ty) {
+        SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), text.size(), color);
+        if (!surface) return;
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+        if (!texture) { SDL_DestroySurface(surface); return; }
+        SDL_FRect dst = { (float)tx, (float)ty, (float)surface->w, (float)surface->h };
+        SDL_RenderTexture(renderer, texture, NULL, &dst);
+        SDL_DestroyTexture(texture);
+        SDL_DestroySurface(surface);
+    };
+    renderText("Properties:", x, y); y += lineHeight;
+    renderText("Position: (" + std::to_string(double(selected.position.x)) + ", " + std::to_string(double(selected.position.y)) + ")", x, y); y += lineHeight;
+    renderText("Velocity: (" + std::to_string(double(selected.velocity.x)) + ", " + std::to_string(double(selected.velocity.y)) + ")", x, y); y += lineHeight;
+    renderText("Mass: " + std::to_string(selected.mass), x, y); y += lineHeight;
+    renderText("Friction: " + std::to_string(selected.friction), x, y); y += lineHeight;
+    renderText("Restitution: " + std::to_string(selected.restitution), x, y); y += lineHeight;
+    RenderBodyIndexSelector(renderer, font, (int)selectedIndex, (int)totalBodies, 10, 10 + lineHeight * 6);
+}
+
+// Set the selected body; the simulation resolves it and reports it back in the next snapshot
+void Properties::SetSelectedBody(size_t index, Simulation& simulation) {
+    selectedIndex = index;
+    pendingWatch = simulation.Watch(index);
+}
+
+void Properties::Update(const RenderSnapshot& snapshot) {
+    totalBodies = snapshot.bodyCount;
+    // A snapshot taken before the last click would undo it; keep the UI's choice until one includes it
+    if (snapshot.watched.request >= pendingWatch)
+        selectedIndex = snapshot.watched.valid ? snapshot.watched.index : 0;
 }
 
-void Properties::HandleEvent(const SDL_Event& e, World& world) {
-    if (!selectedBody || world.bodies.empty() || e.type != SDL_EVENT_MOUSE_BUTTON_DOWN)
+void Properties::HandleEvent(const SDL_Event& e, Simulation& simulation) {
+    if (totalBodies == 0 || e.type != SDL_EVENT_MOUSE_BUTTON_DOWN)
+        return;
+    // Clicks outside the panel pick the body under the cursor
+    float px = e.button.x, py = e.button.y;
+    if (px < panelBounds.x || px > panelBounds.x + panelBounds.w ||
+        py < panelBounds.y || py > panelBounds.y + panelBounds.h) {
+        Simulation* sim = &simulation;
+        simulation.Post([sim, px, py](World& world) {
+            size_t index;
+            if (world.PickBody(px, py, index))
+                sim->Watch(index);
+        });
         return;
-    // Compute bounding box for the selector
-    double minX = propertiesWindow.vertices[0].x, minY = propertiesWindow.vertices[0].y;
-    for (const auto& v : propertiesWindow.vertices) {
-        if (v.x < minX) minX = v.x;
-        if (v.y < minY) minY = v.y;
     }
-    int x = static_cast<int>(minX) + 10, y = static_cast<int>(minY) + 10 + 22 * 6;
+    // Selector position relative to the cached bounding box
+    int x = static_cast<int>(panelBounds.x) + 10, y = static_cast<int>(panelBounds.y) + 10 + 22 * 6;
     int boxWidth = 60, boxHeight = 40;
     int arrowSize = 12;
     int arrowY = y + boxHeight / 2;
@@ -73,31 +151,20 @@ void Properties::HandleEvent(const SDL_Event& e, World& world) {
     SDL_Rect leftArrowRect = { x-10, arrowY-arrowSize/2, arrowSize, arrowSize };
     // Right arrow bounding box
     SDL_Rect rightArrowRect = { x+boxWidth+10-arrowSize, arrowY-arrowSize/2, arrowSize, arrowSize };
-    // Find current index
-    int selectedIndex = 0, totalBodies = 0;
-    for (auto it = world.bodies.begin(); it != world.bodies.end(); ++it, ++totalBodies) {
-        if (it->get() == selectedBody) {
-            selectedIndex = totalBodies;
-        }
-    }
     // Left arrow click
     if (mouseX >= leftArrowRect.x && mouseX <= leftArrowRect.x+leftArrowRect.w &&
         mouseY >= leftArrowRect.y && mouseY <= leftArrowRect.y+leftArrowRect.h) {
         if (totalBodies > 0) {
-            int newIndex = (selectedIndex - 1 + totalBodies) % totalBodies;
-            auto it = world.bodies.begin();
-            std::advance(it, newIndex);
-            selectedBody = it->get();
+            size_t newIndex = (selectedIndex + totalBodies - 1) % totalBodies;
+            SetSelectedBody(newIndex, simulation);
         }
     }
     // Right arrow click
     if (mouseX >= rightArrowRect.x && mouseX <= rightArrowRect.x+rightArrowRect.w &&
         mouseY >= rightArrowRect.y && mouseY <= rightArrowRect.y+rightArrowRect.h) {
         if (totalBodies > 0) {
-            int newIndex = (selectedIndex + 1) % totalBodies;
-            auto it = world.bodies.begin();
-            std::advance(it, newIndex);
-            selectedBody = it->get();
+            size_t newIndex = (selectedIndex + 1) % totalBodies;
+            SetSelectedBody(newIndex, simulation);
         }
     }
 }
@@ -6,6 +6,10 @@
 #include "Body.h"
 #include <SDL3_ttf/SDL_ttf.h>
 #include"World.h"
+#include "RenderSnapshot.h"
+
+class Simulation;
+
 class Properties
 {
     // Private constructor to prevent direct instantiation
@@ -13,7 +17,12 @@ class Properties
 
 public:
     ConvexPolygon propertiesWindow; ///< ConvexPolygon used for the window border
-    Body* selectedBody = nullptr;   ///< Pointer to the currently selected body
+    size_t selectedIndex = 0;       ///< Index of the selected body: the UI's choice until a snapshot reflects it
+    uint64_t pendingWatch = 0;      ///< Watch request of the UI's last choice
+    size_t totalBodies = 0;         ///< Number of bodies in the last snapshot
+
+    // Release the cached panel texture
+    ~Properties();
 
     // Delete copy constructor and assignment operator
     Properties(const Properties&) = delete;
@@ -25,93 +34,15 @@ public:
     }
 
     // Initialize the rectangle window polygon (4 points)
-    void Init(const std::vector<Vector<double>>& points);
+    void Init(const std::vector<Vector<Real>>& points);
 
-    // Set the selected body whose properties will be displayed
-    void SetSelectedBody(Body* body) {
-        selectedBody = body;
-    }
-
-    // Ensure selectedBody is set to the first element in world if not set, or if it is invalid
-    void EnsureSelectedBody(World& world);
+    // Set the selected body whose properties will be displayed (applied by the simulation on its next publish)
+    void SetSelectedBody(size_t index, Simulation& simulation);
 
     // Render the rectangle and the properties of the selected object inside
-    // Pass World by reference, and compute selected index from pointer
-    void Render(SDL_Renderer* renderer, TTF_Font* font, World& world) {
-        // Ensure selectedBody is always set to the first body if not set or if invalid
-        if (!selectedBody || world.bodies.empty()) {
-            if (!world.bodies.empty()) {
-                selectedBody = world.bodies.front().get();
-            } else {
-                selectedBody = nullptr;
-            }
-        } else {
-            // If selectedBody is not in world anymore, reset to first
-            bool found = false;
-            for (auto& b : world.bodies) {
-                if (b.get() == selectedBody) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found && !world.bodies.empty()) {
-                selectedBody = world.bodies.front().get();
-            } else if (!found) {
-                selectedBody = nullptr;
-            }
-        }
-        // Draw the rectangle window (filled background)
-        if (propertiesWindow.vertices.size() == 4) {
-            // Compute bounding box for fill
-            double minX = propertiesWindow.vertices[0].x, maxX = propertiesWindow.vertices[0].x;
-            double minY = propertiesWindow.vertices[0].y, maxY = propertiesWindow.vertices[0].y;
-            for (const auto& v : propertiesWindow.vertices) {
-                if (v.x < minX) minX = v.x;
-                if (v.x > maxX) maxX = v.x;
-                if (v.y < minY) minY = v.y;
-                if (v.y > maxY) maxY = v.y;
-            }
-            SDL_FRect rect = { (float)minX, (float)minY, (float)(maxX - minX), (float)(maxY - minY) };
-            SDL_SetRenderDrawColor(renderer, 30, 30, 30, 220);
-            SDL_RenderFillRect(renderer, &rect);
-        }
-        // Draw the border exactly along the vertices (no offset)
-        propertiesWindow.Render(Vector<double>(0), renderer);
-        if (!selectedBody || !font) return;
-        // Draw properties as text inside the rectangle
-        // Compute text start position relative to the bounding box
-        double minX = propertiesWindow.vertices[0].x, minY = propertiesWindow.vertices[0].y;
-        for (const auto& v : propertiesWindow.vertices) {
-            if (v.x < minX) minX = v.x;
-            if (v.y < minY) minY = v.y;
-        }
-        int x = static_cast<int>(minX) + 10, y = static_cast<int>(minY) + 10, lineHeight = 22;
-        SDL_Color color = { 255, 255, 255, 255 };
-        auto renderText = [&](const std::string& text, int tx, int ty) {
-            SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), strlen(text.c_str()), color);
-            if (!surface) return;
-            SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-            if (!texture) { SDL_DestroySurface(surface); return; }
-            SDL_FRect dst = { (float)tx, (float)ty, (float)surface->w, (float)surface->h };
-            SDL_RenderTexture(renderer, texture, NULL, &dst);
-            SDL_DestroyTexture(texture);
-            SDL_DestroySurface(surface);
-        };
-        renderText("Properties:", x, y); y += lineHeight;
-        renderText("Position: (" + std::to_string(selectedBody->position.x) + ", " + std::to_string(selectedBody->position.y) + ")", x, y); y += lineHeight;
-        renderText("Velocity: (" + std::to_string(selectedBody->velocity.x) + ", " + std::to_string(selectedBody->velocity.y) + ")", x, y); y += lineHeight;
-        renderText("Mass: " + std::to_string(selectedBody->mass), x, y); y += lineHeight;
-        renderText("Friction: " + std::to_string(selectedBody->coeff_friction), x, y); y += lineHeight;
-        renderText("Restitution: " + std::to_string(selectedBody->coeff_restitution), x, y); y += lineHeight;
-        // Compute selected body index
-        int selectedIndex = 0, totalBodies = 0;
-        for (auto it = world.bodies.begin(); it != world.bodies.end(); ++it, ++totalBodies) {
-            if (it->get() == selectedBody) {
-                selectedIndex = totalBodies;
-            }
-        }
-        RenderBodyIndexSelector(renderer, font, selectedIndex, totalBodies, static_cast<int>(minX) + 10, static_cast<int>(minY) + 10 + lineHeight * 6);
-    }
+    // The panel is drawn into a cached texture and only redrawn when the displayed text,
+    // the selection or the layout changes; otherwise this is a single texture copy
+    void Render(SDL_Renderer* renderer, TTF_Font* font, const RenderSnapshot& snapshot);
 
     // Draws a casket (box) with the index of the selected body and two arrows for navigation
     void RenderBodyIndexSelector(SDL_Renderer* renderer, TTF_Font* font, int selectedIndex, int totalBodies, int x, int y) {
@@ -157,10 +88,32 @@ public:
         SDL_RenderLines(renderer, rightArrow, 3);
     }
 
-    // Handle mouse click for arrow navigation
-    void HandleEvent(const SDL_Event& e, World& world);
+    // Handle mouse click for arrow navigation, or pick the clicked body outside the panel
+    void HandleEvent(const SDL_Event& e, Simulation& simulation);
+
+    // Update logic for Properties: pick up the selection and body count from the latest snapshot
+    void Update(const RenderSnapshot& snapshot);
+
+private:
+    // Everything the panel displays, rounded to the printed precision
+    struct DisplayedValues {
+        bool valid = false;
+        size_t index = 0, total = 0;
+        double values[7] = {};
+        bool operator==(const DisplayedValues& other) const;
+    };
+
+    // Capture the values the panel would print for this snapshot
+    DisplayedValues CaptureValues(const RenderSnapshot& snapshot) const;
+
+    // Draw the whole panel into panelTexture (origin at the panel's top-left corner)
+    void RedrawPanel(SDL_Renderer* renderer, TTF_Font* font, const RenderSnapshot& snapshot);
 
-    // Update logic for Properties (e.g., could be used for UI animation, polling, etc.)
-    void Update(World& world);
+    SDL_FRect panelBounds = { 0, 0, 0, 0 }; ///< Bounding box of the window polygon, computed in Init
+    SDL_Texture* panelTexture = nullptr;   ///< Cached rendering of the panel
+    SDL_Renderer* textureRenderer = nullptr; ///< Renderer panelTexture belongs to
+    int textureWidth = 0, textureHeight = 0; ///< Size panelTexture was created with
+    bool panelDirty = true;                ///< Set when the layout changes
+    DisplayedValues shownValues;           ///< Values currently drawn into panelTexture
 };
 
@@ -0,0 +1,130 @@
+#include "RenderSnapshot.h"
+#include <cmath>
+#include <utility>
+#include "globals.h"
+
+// Points per circle outline, as drawn by Circle::Draw.
+static constexpr int CircleSegments = 360;
+
+// Points gathered before they are submitted, so huge snapshots do not need huge buffers.
+static constexpr size_t PointBatch = 65536;
+
+/**
+ * @brief Append every shape of a compound and a record for it at the given body position.
+ * @param compound Shapes to append
+ * @param x,y,rotation Body placement stored in the records
+ * @param records Receives one record per shape, under the shape's kind
+ */
+void ShapeTable::Append(const CompoundShape& compound, float x, float y, float rotation, BodyRecords& records)
+{
+    for (size_t i = 0; i < compound.Count(); ++i)
+    {
+        uint32_t id = 0;
+        switch (compound.kinds[i])
+        {
+        case ShapeKind::Circle:
+            id = (uint32_t)circleRadius.size();
+            circleRadius.push_back((float)compound.radius[i]);
+            break;
+        case ShapeKind::Polygon:
+            id = (uint32_t)polygonFirst.size();
+            polygonFirst.push_back((uint32_t)vertexX.size());
+            polygonCount.push_back(compound.vertexCount[i]);
+            for (uint32_t v = compound.firstVertex[i]; v < compound.firstVertex[i] + compound.vertexCount[i]; ++v)
+            {
+                vertexX.push_back((float)compound.vertexX[v]);
+                vertexY.push_back((float)compound.vertexY[v]);
+            }
+            break;
+        }
+        records[(size_t)compound.kinds[i]].push_back({ x, y, rotation, id });
+    }
+}
+
+// Outline points of all circle records, submitted in large batches (same pixels as Circle::Draw).
+static void RenderCircles(SDL_Renderer* renderer, const std::vector<BodySnapshot>& records, const ShapeTable& table)
+{
+    static const std::vector<std::pair<double, double>> unit = [] {
+        std::vector<std::pair<double, double>> directions(CircleSegments);
+        for (int i = 0; i < CircleSegments; ++i)
+        {
+            double theta = 2.0 * PI * i / CircleSegments;
+            directions[i] = { std::cos(theta), std::sin(theta) };
+        }
+        return directions;
+    }();
+    thread_local std::vector<SDL_FPoint> points;
+    points.clear();
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    for (const BodySnapshot& body : records)
+    {
+        if (body.shapeId >= table.circleRadius.size()) continue;
+        int cx = (int)body.x, cy = (int)body.y, r = (int)table.circleRadius[body.shapeId];
+        for (const auto& [dx, dy] : unit)
+            points.push_back({ (float)(int)(cx + r * dx), (float)(int)(cy + r * dy) });
+        if (points.size() >= PointBatch) {
+            SDL_RenderPoints(renderer, points.data(), (int)points.size());
+            points.clear();
+        }
+    }
+    if (!points.empty())
+        SDL_RenderPoints(renderer, points.data(), (int)points.size());
+}
+
+// Closed outline of every polygon record, one line strip per polygon.
+static void RenderPolygons(SDL_Renderer* renderer, const std::vector<BodySnapshot>& records, const ShapeTable& table)
+{
+    thread_local std::vector<SDL_FPoint> strip;
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+    for (const BodySnapshot& body : records)
+    {
+        if (body.shapeId >= table.polygonFirst.size()) continue;
+        uint32_t first = table.polygonFirst[body.shapeId], count = table.polygonCount[body.shapeId];
+        if (count < 2) continue;
+        strip.clear();
+        for (uint32_t v = 0; v <= count; ++v)
+        {
+            uint32_t k = first + (v == count ? 0 : v); // Back to the first vertex to close the outline
+            strip.push_back({ (float)(int)(body.x + table.vertexX[k]), (float)(int)(body.y + table.vertexY[k]) });
+        }
+        SDL_RenderLines(renderer, strip.data(), (int)strip.size());
+    }
+}
+
+/**
+ * @brief Render all particles and then all fluid particles in one batched submission each, then every joint as a
+ *        line between its anchors, the outline of every soft body and every shape at its recorded body position
+ *        (static bodies first, one loop per shape kind).
+ * @param renderer SDL renderer to use
+ */
+void RenderSnapshot::Render(SDL_Renderer* renderer) const
+{
+    if (!particles.empty()) {
+        SDL_SetRenderDrawColor(renderer, 120, 180, 255, 255);
+        SDL_RenderPoints(renderer, particles.data(), (int)particles.size());
+    }
+    if (!fluid.empty()) {
+        SDL_SetRenderDrawColor(renderer, 60, 120, 255, 255);
+        SDL_RenderPoints(renderer, fluid.data(), (int)fluid.size());
+    }
+    SDL_SetRenderDrawColor(renderer, 255, 200, 80, 255);
+    for (size_t i = 0; i + 1 < jointLines.size(); i += 2)
+        SDL_RenderLine(renderer, jointLines[i].x, jointLines[i].y, jointLines[i + 1].x, jointLines[i + 1].y);
+    SDL_SetRenderDrawColor(renderer, 120, 255, 140, 255);
+    for (size_t i = 0, first = 0; i < softOutlineCounts.size(); first += softOutlineCounts[i++])
+        SDL_RenderLines(renderer, softOutlines.data() + first, (int)softOutlineCounts[i]);
+    if (!shapes) return;
+    auto renderRecords = [&](const BodyRecords& records) {
+        for (size_t k = 0; k < ShapeKindCount; ++k)
+        {
+            switch ((ShapeKind)k)
+            {
+            case ShapeKind::Circle: RenderCircles(renderer, records[k], *shapes); break;
+            case ShapeKind::Polygon: RenderPolygons(renderer, records[k], *shapes); break;
+            }
+        }
+    };
+    if (staticBodies)
+        renderRecords(*staticBodies);
+    renderRecords(bodies);
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <SDL3/SDL.h>
+#include "Vector.h"
+#include "CompoundShape.h"
+#include "Shape.h"
+
+/**
+ * @struct BodySnapshot
+ * @brief Compact per-shape render record copied out of the simulation each step.
+ */
+struct BodySnapshot
+{
+    float x;          ///< World position X of the owning body
+    float y;          ///< World position Y of the owning body
+    float rotation;   ///< Rotation of the owning body (radians)
+    uint32_t shapeId; ///< Index into the ShapeTable arrays of the record's kind
+};
+
+/// Render records grouped by shape kind, so each kind is drawn in one homogeneous loop
+using BodyRecords = std::array<std::vector<BodySnapshot>, ShapeKindCount>;
+
+/**
+ * @struct ShapeTable
+ * @brief Geometry of every shape in a snapshot, stored by value in one set of arrays per kind.
+ */
+struct ShapeTable
+{
+    std::vector<float> circleRadius;    ///< Radius of each circle
+    std::vector<uint32_t> polygonFirst; ///< First vertex of each polygon in vertexX/vertexY
+    std::vector<uint32_t> polygonCount; ///< Vertex count of each polygon
+    std::vector<float> vertexX, vertexY; ///< Body-local polygon vertices
+
+    /**
+     * @brief Append every shape of a compound and a record for it at the given body position.
+     * @param compound Shapes to append
+     * @param x,y,rotation Body placement stored in the records
+     * @param records Receives one record per shape, under the shape's kind
+     */
+    void Append(const CompoundShape& compound, float x, float y, float rotation, BodyRecords& records);
+};
+
+/**
+ * @struct WatchedBodySnapshot
+ * @brief Full set of displayed values for the body shown in the Properties window.
+ */
+struct WatchedBodySnapshot
+{
+    bool valid = false;          ///< False when the world has no bodies
+    size_t index = 0;            ///< Index of the body in World::bodies
+    uint64_t request = 0;        ///< Last Simulation::Watch call this selection reflects
+    Vec2 position;               ///< Position vector
+    Vec2 velocity;               ///< Velocity vector
+    double mass = 0.0;           ///< Mass of the body
+    double friction = 0.0;       ///< Coefficient of friction
+    double restitution = 0.0;    ///< Coefficient of restitution
+};
+
+/**
+ * @struct RenderSnapshot
+ * @brief Immutable view of the world published by the simulation thread.
+ *
+ * The render thread only ever reads snapshots, so it never touches World::bodies
+ * while the simulation is stepping. Shapes are shared, not copied: the shape table
+ * is rebuilt only when bodies are added or removed. Static bodies never move, so their
+ * records are shared between snapshots as well. Records are kept per shape kind and
+ * every kind is drawn by its own loop, without a virtual call per shape.
+ */
+struct RenderSnapshot
+{
+    BodyRecords bodies;                ///< One record per attached shape, by kind
+    std::shared_ptr<const BodyRecords> staticBodies; ///< Records of static bodies, shared until they change
+    std::shared_ptr<const ShapeTable> shapes; ///< Shape geometry indexed by the records' shapeId
+    std::vector<SDL_FPoint> particles; ///< Particle positions, drawn in one batch
+    std::vector<SDL_FPoint> fluid;     ///< Fluid particle positions, drawn in one batch
+    std::vector<SDL_FPoint> jointLines; ///< Anchor pairs, two points per joint
+    std::vector<SDL_FPoint> softOutlines; ///< Closed outline strips of all soft bodies, one after another
+    std::vector<uint32_t> softOutlineCounts; ///< Points of each strip in softOutlines
+    WatchedBodySnapshot watched;      ///< Details of the body selected in the Properties window
+    size_t bodyCount = 0;             ///< Number of bodies in the world
+    unsigned long long step = 0;      ///< Simulation step this snapshot was taken after
+
+    /**
+     * @brief Render every shape in the snapshot.
+     * @param renderer SDL renderer to use
+     */
+    void Render(SDL_Renderer* renderer) const;
+};
@@ -0,0 +1,306 @@
+// Scenario.cpp
+// Coroutine scenarios resumed per simulation step from a timing wheel and the broad-phase pairs.
+#include "Scenario.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <initializer_list>
+#include "World.h"
+
+// Slack when comparing world time against a time wait, so accumulated step lengths count as reached.
+static constexpr double TimeEpsilon = 1e-9;
+
+void ScenarioTask::promise_type::unhandled_exception()
+{
+    std::terminate();
+}
+
+void WaitSteps::await_suspend(ScenarioTask::Handle handle) const
+{
+    ScenarioTask::promise_type& promise = handle.promise();
+    ScenarioScheduler& scheduler = *promise.scheduler;
+    scheduler.AddTimer(promise.id, scheduler.currentStep + steps, -1.0);
+}
+
+void WaitSeconds::await_suspend(ScenarioTask::Handle handle) const
+{
+    ScenarioTask::promise_type& promise = handle.promise();
+    ScenarioScheduler& scheduler = *promise.scheduler;
+    double target = scheduler.currentTime + seconds;
+    scheduler.AddTimer(promise.id, scheduler.EstimateStep(target), target);
+}
+
+void WaitContact::await_suspend(ScenarioTask::Handle handle)
+{
+    waiting = handle;
+    ScenarioTask::promise_type& promise = handle.promise();
+    promise.contact = nullptr;
+    promise.scheduler->contactWaits.push_back({ promise.id, body, other });
+}
+
+ScenarioScheduler::ScenarioScheduler() : slotFirst(WheelSize, NoTimer), slotLast(WheelSize, NoTimer)
+{
+}
+
+ScenarioScheduler::~ScenarioScheduler()
+{
+    for (auto& [id, handle] : tasks)
+        handle.destroy();
+}
+
+uint64_t ScenarioScheduler::Start(ScenarioTask task)
+{
+    ScenarioTask::Handle handle = std::exchange(task.handle, {});
+    if (!handle) return 0;
+    uint64_t id = nextId++;
+    handle.promise().scheduler = this;
+    handle.promise().id = id;
+    tasks.emplace(id, handle);
+    Resume(id, nullptr);
+    return tasks.count(id) ? id : 0;
+}
+
+bool ScenarioScheduler::Stop(uint64_t id)
+{
+    auto it = tasks.find(id);
+    if (it == tasks.end()) return false;
+    if (id == runningTask) {
+        stopRequested = true; // Destroyed once it suspends
+        return true;
+    }
+    it->second.destroy();
+    tasks.erase(it);
+    RemoveContactWaits(id); // Timers and ready entries are skipped when they come up
+    return true;
+}
+
+void ScenarioScheduler::StopAll()
+{
+    for (auto it = tasks.begin(); it != tasks.end();)
+    {
+        if (it->first == runningTask) {
+            stopRequested = true;
+            ++it;
+        } else {
+            it->second.destroy();
+            it = tasks.erase(it);
+        }
+    }
+    timers.clear();
+    slotFirst.assign(WheelSize, NoTimer);
+    slotLast.assign(WheelSize, NoTimer);
+    filingDelta = INFINITY;
+    freeTimer = NoTimer;
+    contactWaits.clear();
+    ready.clear();
+}
+
+void ScenarioScheduler::Advance(World& world)
+{
+    if (world.stepCount > currentStep)
+        lastDeltaTime = (world.time - currentTime) / (double)(world.stepCount - currentStep);
+    currentStep = world.stepCount;
+    currentTime = world.time;
+    resumedCount = 0;
+    if (lastDeltaTime > filingDelta * (1.0 + TimeEpsilon))
+        RefileTimeWaits(); // Steps got longer (beyond rounding of World::time): estimates made with shorter ones would resume late
+
+    // Timers of this step's slot; entries for later turns of the wheel stay where they are
+    size_t slot = currentStep & (WheelSize - 1);
+    uint32_t entry = slotFirst[slot];
+    slotFirst[slot] = slotLast[slot] = NoTimer;
+    while (entry != NoTimer)
+    {
+        TimerEntry& timer = timers[entry];
+        uint32_t following = timer.next;
+        if (timer.step > currentStep) {
+            LinkTimer(entry);
+        } else if (timer.time >= 0 && currentTime + TimeEpsilon < timer.time) {
+            timer.step = EstimateStep(timer.time); // Steps got shorter
+            LinkTimer(entry);
+        } else {
+            MakeReady(timer.task, nullptr);
+            timer.next = freeTimer;
+            freeTimer = entry;
+        }
+        entry = following;
+    }
+
+    // Contact waits against this step's shape contacts, or its broad-phase pairs without them
+    bool shapeContacts = world.contacts.enabled;
+    if (!contactWaits.empty() && (shapeContacts || world.broadPhase.enabled)) {
+        waitsByBody.clear();
+        for (size_t w = 0; w < contactWaits.size(); ++w)
+            waitsByBody.emplace(contactWaits[w].body, w);
+        contactFound.assign(contactWaits.size(), nullptr);
+        auto match = [this](Body* a, Body* b) {
+            for (int side = 0; side < 2; ++side, std::swap(a, b))
+            {
+                auto range = waitsByBody.equal_range(a);
+                for (auto it = range.first; it != range.second; ++it)
+                {
+                    const ContactWait& wait = contactWaits[it->second];
+                    if (!contactFound[it->second] && (!wait.other || wait.other == b))
+                        contactFound[it->second] = b;
+                }
+            }
+        };
+        if (shapeContacts) {
+            for (ContactPhase phase : { ContactPhase::Begin, ContactPhase::Persist })
+                for (const ContactEvent& event : world.contacts.Events(phase))
+                    match(event.bodyA, event.bodyB);
+        } else {
+            if (world.version != bodyIndexVersion) {
+                bodyByIndex.clear();
+                for (const auto& bodyPtr : world.bodies)
+                    bodyByIndex.push_back(bodyPtr.get());
+                bodyIndexVersion = world.version;
+            }
+            world.broadPhase.GetPairs(pairScratch);
+            for (const auto& [first, second] : pairScratch)
+                if (first < bodyByIndex.size() && second < bodyByIndex.size())
+                    match(bodyByIndex[first], bodyByIndex[second]);
+
+            // Static bodies are not in the broad phase: look up the other kind of body around each waiting one
+            if (!world.staticBodies.empty()) {
+                if (world.staticVersion != staticIndexVersion) {
+                    staticByIndex.clear();
+                    for (const auto& bodyPtr : world.staticBodies)
+                        staticByIndex.push_back(bodyPtr.get());
+                    staticIndexVersion = world.staticVersion;
+                }
+                for (size_t w = 0; w < contactWaits.size(); ++w)
+                {
+                    const ContactWait& wait = contactWaits[w];
+                    const Body* body = wait.body;
+                    if (contactFound[w]) continue;
+                    const CompoundShape& compound = body->compound;
+                    double x = double(body->position.x), y = double(body->position.y);
+                    bool isStatic = body->type == BodyType::Static;
+                    regionScratch.clear();
+                    if (isStatic)
+                        world.QueryRegion(x + double(compound.minX), y + double(compound.minY), x + double(compound.maxX), y + double(compound.maxY), regionScratch);
+                    else
+                        world.QueryStaticRegion(x + double(compound.minX), y + double(compound.minY), x + double(compound.maxX), y + double(compound.maxY), regionScratch);
+                    const std::vector<Body*>& others = isStatic ? bodyByIndex : staticByIndex;
+                    for (size_t index : regionScratch)
+                        if (index < others.size() && (!wait.other || wait.other == others[index])) {
+                            contactFound[w] = others[index];
+                            break;
+                        }
+                }
+            }
+        }
+        size_t kept = 0;
+        for (size_t w = 0; w < contactWaits.size(); ++w)
+        {
+            if (contactFound[w]) MakeReady(contactWaits[w].task, contactFound[w]);
+            else contactWaits[kept++] = contactWaits[w];
+        }
+        contactWaits.resize(kept);
+    }
+
+    // Resume in batches: a resumed scenario may make others ready (by removing bodies)
+    while (!ready.empty())
+    {
+        resuming.swap(ready);
+        for (const auto& [task, contact] : resuming)
+            Resume(task, contact); // Skips scenarios stopped while waiting
+        resuming.clear();
+    }
+}
+
+void ScenarioScheduler::ForgetBody(const Body* body)
+{
+    size_t kept = 0;
+    for (const ContactWait& wait : contactWaits)
+    {
+        if (!body || wait.body == body || wait.other == body) MakeReady(wait.task, nullptr);
+        else contactWaits[kept++] = wait;
+    }
+    contactWaits.resize(kept);
+    bodyIndexVersion = ~0ull;
+}
+
+void ScenarioScheduler::AddTimer(uint64_t task, uint64_t step, double time)
+{
+    uint32_t entry = freeTimer;
+    if (entry != NoTimer) {
+        freeTimer = timers[entry].next;
+        timers[entry] = { task, step, time, NoTimer };
+    } else {
+        entry = (uint32_t)timers.size();
+        timers.push_back({ task, step, time, NoTimer });
+    }
+    LinkTimer(entry);
+}
+
+void ScenarioScheduler::LinkTimer(uint32_t entry)
+{
+    if (timers[entry].time >= 0)
+        filingDelta = std::min(filingDelta, lastDeltaTime);
+    size_t slot = timers[entry].step & (WheelSize - 1);
+    timers[entry].next = NoTimer;
+    if (slotLast[slot] == NoTimer) slotFirst[slot] = entry;
+    else timers[slotLast[slot]].next = entry;
+    slotLast[slot] = entry;
+}
+
+void ScenarioScheduler::RefileTimeWaits()
+{
+    refiling.clear();
+    for (size_t slot = 0; slot < WheelSize; ++slot)
+    {
+        for (uint32_t entry = slotFirst[slot]; entry != NoTimer; entry = timers[entry].next)
+            refiling.push_back(entry);
+        slotFirst[slot] = slotLast[slot] = NoTimer;
+    }
+    filingDelta = INFINITY;
+    for (uint32_t entry : refiling)
+    {
+        TimerEntry& timer = timers[entry];
+        if (timer.time >= 0) {
+            if (currentTime + TimeEpsilon >= timer.time) timer.step = currentStep; // Reached during this step
+            else timer.step = std::min(timer.step, EstimateStep(timer.time));
+        }
+        LinkTimer(entry);
+    }
+}
+
+uint64_t ScenarioScheduler::EstimateStep(double time) const
+{
+    if (lastDeltaTime <= 0) return currentStep + 1; // No step seen yet: look again after the next one
+    double steps = std::ceil((time - currentTime) / lastDeltaTime - TimeEpsilon);
+    return currentStep + (uint64_t)std::max(steps, 1.0);
+}
+
+void ScenarioScheduler::MakeReady(uint64_t task, Body* contact)
+{
+    ready.push_back({ task, contact });
+}
+
+void ScenarioScheduler::Resume(uint64_t task, Body* contact)
+{
+    auto it = tasks.find(task);
+    if (it == tasks.end()) return;
+    ScenarioTask::Handle handle = it->second;
+    handle.promise().contact = contact;
+    ++resumedCount;
+    // A scenario may start another, which resumes inside this call
+    uint64_t outerTask = std::exchange(runningTask, task);
+    bool outerStop = std::exchange(stopRequested, false);
+    handle.resume();
+    bool stop = std::exchange(stopRequested, outerStop);
+    runningTask = outerTask;
+    if (handle.done() || stop) {
+        tasks.erase(task);
+        RemoveContactWaits(task);
+        handle.destroy();
+    }
+}
+
+void ScenarioScheduler::RemoveContactWaits(uint64_t task)
+{
+    contactWaits.erase(std::remove_if(contactWaits.begin(), contactWaits.end(),
+        [task](const ContactWait& wait) { return wait.task == task; }), contactWaits.end());
+}
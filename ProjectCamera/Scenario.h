@@ -0,0 +1,229 @@
+#pragma once
+#include <cmath>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Body;
+class World;
+class ScenarioScheduler;
+
+/**
+ * @class ScenarioTask
+ * @brief Return type of a scenario coroutine: a scripted behavior that runs between simulation steps.
+ *
+ * A scenario is any function returning ScenarioTask that takes what it needs (usually World&)
+ * and co_awaits WaitSteps, WaitSeconds or WaitContact. It does nothing until handed to
+ * ScenarioScheduler::Start, which runs it up to its first wait and owns it from then on.
+ * Scenarios run on the thread stepping the world, so they may change it freely.
+ * Engine code does not use exceptions; one escaping a scenario terminates the program.
+ */
+class ScenarioTask
+{
+public:
+    struct promise_type
+    {
+        ScenarioScheduler* scheduler = nullptr; ///< Set by ScenarioScheduler::Start
+        uint64_t id = 0;                        ///< Task id within its scheduler
+        Body* contact = nullptr;                ///< Result of the last WaitContact
+
+        ScenarioTask get_return_object() { return ScenarioTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception();
+    };
+    using Handle = std::coroutine_handle<promise_type>;
+
+    ScenarioTask(ScenarioTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    ScenarioTask(const ScenarioTask&) = delete;
+    ScenarioTask& operator=(const ScenarioTask&) = delete;
+    ScenarioTask& operator=(ScenarioTask&&) = delete;
+    ~ScenarioTask() { if (handle) handle.destroy(); }
+
+private:
+    friend class ScenarioScheduler;
+    explicit ScenarioTask(Handle handle) : handle(handle) {}
+
+    Handle handle; ///< Owned until Start takes it
+};
+
+/**
+ * @brief Resume after the given number of world steps (0 continues without waiting).
+ */
+struct WaitSteps
+{
+    uint64_t steps;
+
+    bool await_ready() const noexcept { return steps == 0; }
+    void await_suspend(ScenarioTask::Handle handle) const;
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Resume at the end of the first step that brings World::time to at least now + seconds.
+ */
+struct WaitSeconds
+{
+    double seconds;
+
+    bool await_ready() const noexcept { return seconds <= 0; }
+    void await_suspend(ScenarioTask::Handle handle) const;
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Resume at the end of the first step in which a body touches another one.
+ *
+ * Touching means the shapes touch when World::contacts is enabled, and otherwise that the broad
+ * phase reports the two bodies' boxes overlapping, so one of the two has to be enabled. Static
+ * bodies count too: without contacts they are found with World::QueryStaticRegion. The
+ * await yields the other body, or nullptr if either body was removed from the world first.
+ */
+struct WaitContact
+{
+    Body* body;              ///< Body to watch
+    Body* other = nullptr;   ///< Only this body counts, or any body if null
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(ScenarioTask::Handle handle);
+    Body* await_resume() const noexcept { return waiting.promise().contact; }
+
+    ScenarioTask::Handle waiting{}; ///< Set while suspended
+};
+
+/**
+ * @class ScenarioScheduler
+ * @brief Owns running scenarios and resumes each one only at the step it waits for.
+ *
+ * Step and time waits go into a hashed timing wheel with one slot per step: a wait of n steps
+ * is filed under slot (now + n) mod WheelSize, and each step only the entries of its own slot
+ * are looked at. A waiting scenario therefore costs nothing on the steps in between, and a
+ * wait longer than the wheel is only looked at once per turn. Time waits are filed under the
+ * step estimated from the last step length. When their slot comes up they are checked against
+ * World::time and filed again if steps got shorter; when steps get longer than any time wait was
+ * estimated with, all time waits are estimated again and pulled forward, so none resumes late.
+ * Each slot is a linked list through one shared entry array with a free list, so filing a wait
+ * does not allocate unless more scenarios are waiting than ever before.
+ * Contact waits are checked against the contact events (or broad-phase pairs), and only while there are any.
+ * Scenarios due in the same step resume in a fixed order: timers in the order they were
+ * filed, then contacts in the order they started waiting. A scenario may start or stop
+ * others, and stop itself, while it runs.
+ */
+class ScenarioScheduler
+{
+public:
+    static constexpr size_t WheelSize = 1024; ///< Slots in the timing wheel (a power of two)
+
+    ScenarioScheduler();
+    ~ScenarioScheduler();
+    ScenarioScheduler(const ScenarioScheduler&) = delete;
+    ScenarioScheduler& operator=(const ScenarioScheduler&) = delete;
+
+    /**
+     * @brief Take ownership of a scenario and run it up to its first wait.
+     * @param task Scenario that has not been started yet
+     * @return Id for Stop, or 0 if the scenario finished without waiting
+     */
+    uint64_t Start(ScenarioTask task);
+
+    /**
+     * @brief End a scenario where it waits; its locals are destroyed.
+     * @return False if no scenario with this id is running
+     */
+    bool Stop(uint64_t id);
+
+    /**
+     * @brief End every scenario.
+     */
+    void StopAll();
+
+    /**
+     * @brief Resume the scenarios due after the world's latest step (called by World::Update).
+     * @param world World that just completed a step; contact waits may query its spatial indices
+     */
+    void Advance(World& world);
+
+    /**
+     * @brief Let contact waits involving a body resume with nullptr, before the body is destroyed.
+     * @param body Body about to be removed, or nullptr for all bodies
+     */
+    void ForgetBody(const Body* body);
+
+    size_t GetRunningCount() const { return tasks.size(); } ///< Scenarios started and not finished
+    size_t GetContactWaitCount() const { return contactWaits.size(); } ///< Scenarios waiting for a contact
+    size_t GetResumedCount() const { return resumedCount; } ///< Resumptions in the last Advance
+
+private:
+    friend struct WaitSteps;
+    friend struct WaitSeconds;
+    friend struct WaitContact;
+
+    /// A step or time wait filed in the wheel
+    struct TimerEntry
+    {
+        uint64_t task;    ///< Id of the waiting scenario
+        uint64_t step;    ///< Step after which it is due
+        double time;      ///< World time it waits for, or a negative value for a step wait
+        uint32_t next;    ///< Next entry in the same slot or free list, or NoTimer
+    };
+
+    static constexpr uint32_t NoTimer = ~0u; ///< End of a slot or of the free list
+
+    /// A scenario waiting for its body to touch another
+    struct ContactWait
+    {
+        uint64_t task;
+        const Body* body;
+        const Body* other;
+    };
+
+    // File a wait in the wheel slot of its due step.
+    void AddTimer(uint64_t task, uint64_t step, double time);
+
+    // Append an entry of timers to the end of the slot of its due step.
+    void LinkTimer(uint32_t entry);
+
+    // Step at which World::time is expected to reach the given time.
+    uint64_t EstimateStep(double time) const;
+
+    // Estimate every time wait again after steps got longer, moving the late ones to earlier slots.
+    void RefileTimeWaits();
+
+    // Queue a waiting scenario to resume in this Advance (or the next one, outside Advance).
+    void MakeReady(uint64_t task, Body* contact);
+
+    // Resume a scenario with the result of its contact wait and destroy it if it finished or was stopped meanwhile.
+    void Resume(uint64_t task, Body* contact);
+
+    // Drop the contact waits of a scenario.
+    void RemoveContactWaits(uint64_t task);
+
+    std::unordered_map<uint64_t, ScenarioTask::Handle> tasks; ///< Running scenarios by id
+    uint64_t nextId = 1;
+    std::vector<TimerEntry> timers;              ///< Entries of all slots and the free list
+    std::vector<uint32_t> slotFirst, slotLast;   ///< WheelSize slot lists into timers, indexed by step mod WheelSize
+    uint32_t freeTimer = NoTimer;                ///< First unused entry of timers
+    std::vector<uint32_t> refiling;              ///< Entries being filed again by RefileTimeWaits
+    double filingDelta = INFINITY;               ///< Shortest step length a waiting time wait was filed with
+    std::vector<ContactWait> contactWaits;
+    std::vector<std::pair<uint64_t, Body*>> ready; ///< Scenarios to resume, with their contact result
+    std::vector<std::pair<uint64_t, Body*>> resuming; ///< Batch of ready being resumed
+    std::vector<std::pair<uint32_t, uint32_t>> pairScratch; ///< Broad-phase pairs of the current step
+    std::vector<Body*> bodyByIndex;              ///< World::bodies in list order, for pair lookups
+    std::vector<Body*> staticByIndex;            ///< World::staticBodies in list order, for region lookups
+    std::vector<size_t> regionScratch;           ///< Result of one region query around a waiting body
+    std::unordered_multimap<const Body*, size_t> waitsByBody; ///< Indices into contactWaits, rebuilt per Advance
+    std::vector<Body*> contactFound;             ///< Partner found for each contact wait this step
+    unsigned long long bodyIndexVersion = ~0ull; ///< World::version bodyByIndex was built for
+    unsigned long long staticIndexVersion = ~0ull; ///< World::staticVersion staticByIndex was built for
+    uint64_t currentStep = 0;                    ///< World::stepCount at the last Advance
+    double currentTime = 0.0;                    ///< World::time at the last Advance
+    double lastDeltaTime = 0.0;                  ///< Length of the last step, for time estimates
+    size_t resumedCount = 0;
+    uint64_t runningTask = 0;                    ///< Scenario being resumed, 0 between resumptions
+    bool stopRequested = false;                  ///< The running scenario asked to be stopped
+};
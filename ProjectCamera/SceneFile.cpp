@@ -0,0 +1,461 @@
+// SceneFile.cpp
+// Parallel streaming loader and exporter for text scene files.
+#include "SceneFile.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+#include "Circle.h"
+#include "ConvexPolygon.h"
+#include "World.h"
+
+// Bytes read from disk per block.
+static const size_t BlockSize = 32u << 20;
+
+// Smallest chunk worth handing to another thread.
+static const size_t MinChunkSize = 1u << 20;
+
+// Text buffered by the exporter before it is flushed to the file.
+static const size_t FlushSize = 16u << 20;
+
+// Material as declared in the file; defaults match an unconfigured Body.
+struct SceneMaterial
+{
+    double density = World::DefaultDensity;
+    double friction = 0.5;
+    double restitution = 0.5;
+};
+
+// Body record as parsed, before anything is allocated in the world.
+struct ParsedBody
+{
+    BodyType type;
+    double x, y, vx, vy;
+    int32_t material;      // -1 for the defaults
+    uint32_t firstShape, shapeCount;
+};
+
+// Shape record as parsed; polygon vertices live in the chunk's vertex array.
+struct ParsedShape
+{
+    ShapeKind kind;
+    double radius;
+    double density;        // negative to use the body's material
+    uint32_t firstVertex, vertexCount;
+};
+
+// Output of parsing one chunk. Kept between blocks so steady-state parsing does not allocate.
+struct ParsedChunk
+{
+    std::vector<ParsedBody> bodies;
+    std::vector<ParsedShape> shapes;
+    std::vector<Real> vertices;           // x, y interleaved
+    const char* errorAt = nullptr;        // start of the offending line
+    const char* errorMessage = nullptr;
+};
+
+// Whitespace within a line.
+static bool IsBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Next whitespace-separated token before lineEnd; false at the end of the line.
+static bool NextToken(const char*& p, const char* lineEnd, std::string_view& token)
+{
+    while (p < lineEnd && IsBlank(*p)) ++p;
+    if (p == lineEnd) return false;
+    const char* start = p;
+    while (p < lineEnd && !IsBlank(*p)) ++p;
+    token = std::string_view(start, p - start);
+    return true;
+}
+
+// Next token parsed as a number; leaves p untouched if the token is not one.
+static bool NextNumber(const char*& p, const char* lineEnd, double& value)
+{
+    const char* q = p;
+    while (q < lineEnd && IsBlank(*q)) ++q;
+    if (q < lineEnd && *q == '+') ++q; // from_chars rejects a leading plus
+    auto result = std::from_chars(q, lineEnd, value);
+    if (result.ec != std::errc() || (result.ptr < lineEnd && !IsBlank(*result.ptr))) return false;
+    p = result.ptr;
+    return true;
+}
+
+// End of the line starting at p (the newline, or end).
+static const char* LineEnd(const char* p, const char* end)
+{
+    const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return newline ? newline : end;
+}
+
+// Offset of the first line at or after from that starts with "body", or text.size().
+static size_t NextBodyLine(std::string_view text, size_t from)
+{
+    if (from == 0 && text.substr(0, 4) == "body") return 0;
+    size_t found = text.find("\nbody", from == 0 ? 0 : from - 1);
+    return found == std::string_view::npos ? text.size() : found + 1;
+}
+
+/**
+ * @brief Parses scene text block by block, keeping materials and chunk buffers across blocks.
+ */
+class SceneParser
+{
+public:
+    SceneParser(World& world, ThreadPool* pool) : world(world), pool(pool) {}
+
+    /**
+     * @brief Parse one block of whole records and add its bodies to the world.
+     * @param text Block text, starting at a line boundary and ending after a complete body
+     * @param firstLine Line number of the block's first line, for error messages
+     * @param error Receives "line: message" on failure
+     * @return False on a syntax error
+     */
+    bool ParseBlock(std::string_view text, size_t firstLine, std::string& error)
+    {
+        if (!ReadMaterials(text, firstLine, error)) return false;
+
+        // Cut at body lines so every chunk owns its bodies' shapes
+        size_t threads = pool ? pool->GetThreadCount() : 1;
+        size_t chunkCount = std::max<size_t>(1, std::min(threads * 4, text.size() / MinChunkSize));
+        std::vector<size_t> cuts(1, 0);
+        for (size_t k = 1; k < chunkCount; ++k) {
+            size_t cut = NextBodyLine(text, std::max(cuts.back() + 1, text.size() * k / chunkCount));
+            if (cut >= text.size()) break;
+            cuts.push_back(cut);
+        }
+        cuts.push_back(text.size());
+        chunkCount = cuts.size() - 1;
+        if (chunks.size() < chunkCount) chunks.resize(chunkCount);
+
+        auto parseRange = [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c)
+                ParseChunk(text.data() + cuts[c], text.data() + cuts[c + 1], chunks[c]);
+        };
+        if (pool && chunkCount > 1) pool->ParallelFor(chunkCount, 1, parseRange);
+        else parseRange(0, chunkCount);
+
+        // Create bodies in file order, stopping at the first error
+        for (size_t c = 0; c < chunkCount; ++c)
+        {
+            Build(chunks[c]);
+            if (chunks[c].errorAt) {
+                size_t offset = chunks[c].errorAt - text.data();
+                size_t line = firstLine + std::count(text.begin(), text.begin() + offset, '\n');
+                error = std::to_string(line) + ": " + chunks[c].errorMessage;
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    // Serial pre-pass over the block's material lines, so chunks can resolve names read-only.
+    // Each name is defined once per file; materialLines records where, so a body can only use
+    // a material from an earlier line whichever block either falls in.
+    bool ReadMaterials(std::string_view text, size_t firstLine, std::string& error)
+    {
+        std::fill(materialLines.begin(), materialLines.end(), nullptr); // Earlier blocks: before every line
+        for (size_t at = text.find("material"); at != std::string_view::npos; at = text.find("material", at + 8))
+        {
+            // Tokenize the whole line as ParseRecord does, so leading blanks are allowed here too
+            size_t lineStart = text.rfind('\n', at);
+            lineStart = lineStart == std::string_view::npos ? 0 : lineStart + 1;
+            const char* p = text.data() + lineStart;
+            const char* lineEnd = LineEnd(p, text.data() + text.size());
+            const char* commentAt = static_cast<const char*>(std::memchr(p, '#', lineEnd - p));
+            if (commentAt) lineEnd = commentAt;
+            std::string_view keyword, name;
+            if (!NextToken(p, lineEnd, keyword) || keyword != "material" || p <= text.data() + at) continue;
+            SceneMaterial material;
+            const char* message = nullptr;
+            if (!NextToken(p, lineEnd, name) || !NextNumber(p, lineEnd, material.density) ||
+                !NextNumber(p, lineEnd, material.friction) || !NextNumber(p, lineEnd, material.restitution))
+                message = "expected material <name> <density> <friction> <restitution>";
+            else if (FindMaterial(name) >= 0)
+                message = "material redefined";
+            if (message) {
+                size_t line = firstLine + std::count(text.begin(), text.begin() + at, '\n');
+                error = std::to_string(line) + ": " + message;
+                return false;
+            }
+            materialNames.emplace_back(name);
+            materials.push_back(material);
+            materialLines.push_back(text.data() + lineStart);
+        }
+        return true;
+    }
+
+    // Index of a declared material, or -1.
+    int32_t FindMaterial(std::string_view name) const
+    {
+        for (size_t i = 0; i < materialNames.size(); ++i)
+            if (materialNames[i] == name) return (int32_t)i;
+        return -1;
+    }
+
+    // Parse records into the chunk's flat arrays; runs on a pool thread.
+    void ParseChunk(const char* begin, const char* end, ParsedChunk& chunk) const
+    {
+        chunk.bodies.clear();
+        chunk.shapes.clear();
+        chunk.vertices.clear();
+        chunk.errorAt = nullptr;
+        for (const char* line = begin; line < end; )
+        {
+            const char* lineEnd = LineEnd(line, end);
+            const char* commentAt = static_cast<const char*>(std::memchr(line, '#', lineEnd - line));
+            const char* recordEnd = commentAt ? commentAt : lineEnd;
+            const char* message = ParseRecord(line, recordEnd, chunk);
+            if (message) {
+                chunk.errorAt = line;
+                chunk.errorMessage = message;
+                return;
+            }
+            line = lineEnd + 1;
+        }
+    }
+
+    // Parse one line; returns an error message or null.
+    const char* ParseRecord(const char* p, const char* lineEnd, ParsedChunk& chunk) const
+    {
+        const char* line = p;
+        std::string_view keyword;
+        if (!NextToken(p, lineEnd, keyword) || keyword == "material") return nullptr;
+
+        if (keyword == "body")
+        {
+            ParsedBody body = { BodyType::Dynamic, 0, 0, 0, 0, -1, (uint32_t)chunk.shapes.size(), 0 };
+            std::string_view type, material;
+            if (!NextToken(p, lineEnd, type)) return "expected body <dynamic|kinematic|static> <x> <y> [<vx> <vy>] [<material>]";
+            if (type == "kinematic") body.type = BodyType::Kinematic;
+            else if (type == "static") body.type = BodyType::Static;
+            else if (type != "dynamic") return "unknown body type";
+            if (!NextNumber(p, lineEnd, body.x) || !NextNumber(p, lineEnd, body.y))
+                return "expected body position";
+            if (NextNumber(p, lineEnd, body.vx) && !NextNumber(p, lineEnd, body.vy))
+                return "expected both velocity components";
+            if (NextToken(p, lineEnd, material)) {
+                body.material = FindMaterial(material);
+                if (body.material < 0 || (materialLines[body.material] && materialLines[body.material] > line))
+                    return "unknown material";
+            }
+            std::string_view extra;
+            if (NextToken(p, lineEnd, extra)) return "unexpected trailing text";
+            chunk.bodies.push_back(body);
+            return nullptr;
+        }
+
+        if (chunk.bodies.empty()) return "shape before any body";
+        ParsedShape shape = { ShapeKind::Circle, 0, -1.0, (uint32_t)chunk.vertices.size() / 2, 0 };
+        if (keyword == "circle")
+        {
+            if (!NextNumber(p, lineEnd, shape.radius) || shape.radius <= 0) return "expected circle <radius> [<density>]";
+        }
+        else if (keyword == "polygon")
+        {
+            double count;
+            if (!NextNumber(p, lineEnd, count) || count < 3 || count != (uint32_t)count)
+                return "expected polygon <count> followed by count vertices";
+            shape.kind = ShapeKind::Polygon;
+            shape.vertexCount = (uint32_t)count;
+            for (uint32_t v = 0; v < 2 * shape.vertexCount; ++v) {
+                double value;
+                if (!NextNumber(p, lineEnd, value)) return "too few polygon vertices";
+                chunk.vertices.push_back((Real)value);
+            }
+        }
+        else
+        {
+            return "unknown record";
+        }
+        if (NextNumber(p, lineEnd, shape.density) && !(shape.density >= 0)) return "shape density must not be negative";
+        std::string_view extra;
+        if (NextToken(p, lineEnd, extra)) return "unexpected trailing text";
+        chunk.shapes.push_back(shape);
+        ++chunk.bodies.back().shapeCount;
+        return nullptr;
+    }
+
+    // Create a chunk's bodies in the world (calling thread only).
+    void Build(const ParsedChunk& chunk)
+    {
+        for (const ParsedBody& parsed : chunk.bodies)
+        {
+            const SceneMaterial& material = parsed.material >= 0 ? materials[parsed.material] : defaults;
+            Body* body = world.CreateBody(parsed.type, parsed.x, parsed.y, parsed.vx, parsed.vy);
+            body->coeff_friction = material.friction;
+            body->coeff_restitution = material.restitution;
+            for (uint32_t s = parsed.firstShape; s < parsed.firstShape + parsed.shapeCount; ++s)
+            {
+                const ParsedShape& shape = chunk.shapes[s];
+                double density = shape.density >= 0 ? shape.density : material.density;
+                if (shape.kind == ShapeKind::Circle) {
+                    body->AttachShape(Circle((float)shape.radius), density);
+                    continue;
+                }
+                corners.resize(shape.vertexCount, Vector<Real>(2));
+                for (uint32_t v = 0; v < shape.vertexCount; ++v)
+                    corners[v].set(chunk.vertices[2 * (shape.firstVertex + v)], chunk.vertices[2 * (shape.firstVertex + v) + 1]);
+                body->AttachShape(ConvexPolygon(corners), density);
+            }
+        }
+    }
+
+    World& world;
+    ThreadPool* pool;
+    std::vector<std::string> materialNames;
+    std::vector<SceneMaterial> materials;
+    std::vector<const char*> materialLines; // Declaring line in the current block, null if in an earlier one
+    SceneMaterial defaults;
+    std::vector<ParsedChunk> chunks;
+    std::vector<Vector<Real>> corners; // polygon scratch for Build
+};
+
+bool SceneFile::Load(World& world, const std::string& path, std::string& error, ThreadPool* pool)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    SceneParser parser(world, pool);
+    std::string buffer;
+    size_t firstLine = 1;
+    bool ok = true;
+    for (bool done = false; ok && !done; )
+    {
+        size_t kept = buffer.size();
+        buffer.resize(kept + BlockSize);
+        size_t read = std::fread(&buffer[kept], 1, BlockSize, file);
+        buffer.resize(kept + read);
+        done = read < BlockSize;
+
+        // Hold back the last body, whose shape lines may continue in the next block
+        size_t cut = buffer.size();
+        if (!done) {
+            size_t last = buffer.rfind("\nbody");
+            cut = last == std::string::npos ? 0 : last + 1;
+            if (cut == 0) continue; // one body larger than a block: keep reading
+        }
+        std::string_view block(buffer.data(), cut);
+        ok = parser.ParseBlock(block, firstLine, error);
+        firstLine += std::count(block.begin(), block.end(), '\n');
+        buffer.erase(0, cut);
+    }
+    std::fclose(file);
+    if (!ok) error = path + ":" + error;
+    return ok;
+}
+
+bool SceneFile::Parse(World& world, std::string_view text, std::string& error, ThreadPool* pool)
+{
+    SceneParser parser(world, pool);
+    return parser.ParseBlock(text, 1, error);
+}
+
+// Append a number in its shortest round-trip form.
+static void PutNumber(std::string& out, double value)
+{
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.push_back(' ');
+    out.append(buffer, result.ptr);
+}
+
+#ifdef PHYSICS_FIXED_POINT
+// Fixed values convert to double exactly below 2^21 in magnitude, so they still round-trip.
+static void PutNumber(std::string& out, Fixed value)
+{
+    PutNumber(out, double(value));
+}
+#endif
+
+// Write materials, then every body with its shapes, flushing to file (if any) as the text grows.
+static void Export(const World& world, std::string& out, FILE* file)
+{
+    // One material per distinct (density, friction, restitution), named m0, m1, ...
+    typedef std::tuple<double, double, double> MaterialKey;
+    std::map<MaterialKey, size_t> materials;
+    auto keyOf = [](const Body& body) {
+        double density = body.compound.Count() > 0 ? (double)body.compound.density[0] : World::DefaultDensity;
+        return MaterialKey(density, (double)body.coeff_friction, (double)body.coeff_restitution);
+    };
+    for (const auto* list : { &world.bodies, &world.staticBodies })
+        for (const auto& bodyPtr : *list)
+            materials.emplace(keyOf(*bodyPtr), materials.size());
+
+    out += "# ProjectCamera scene\n";
+    std::vector<const MaterialKey*> byIndex(materials.size());
+    for (const auto& entry : materials) byIndex[entry.second] = &entry.first;
+    for (size_t i = 0; i < byIndex.size(); ++i) {
+        out += "material m" + std::to_string(i);
+        PutNumber(out, std::get<0>(*byIndex[i]));
+        PutNumber(out, std::get<1>(*byIndex[i]));
+        PutNumber(out, std::get<2>(*byIndex[i]));
+        out.push_back('\n');
+    }
+
+    static const char* typeNames[] = { "dynamic", "kinematic", "static" };
+    for (const auto* list : { &world.bodies, &world.staticBodies })
+        for (const auto& bodyPtr : *list)
+        {
+            const Body& body = *bodyPtr;
+            const CompoundShape& compound = body.compound;
+            MaterialKey key = keyOf(body);
+            out += "body ";
+            out += typeNames[(int)body.type];
+            PutNumber(out, body.position.x);
+            PutNumber(out, body.position.y);
+            if (body.type != BodyType::Static) {
+                PutNumber(out, body.velocity.x);
+                PutNumber(out, body.velocity.y);
+            }
+            out += " m" + std::to_string(materials[key]);
+            out.push_back('\n');
+            for (size_t s = 0; s < compound.Count(); ++s)
+            {
+                if (compound.kinds[s] == ShapeKind::Circle) {
+                    out += "circle";
+                    PutNumber(out, compound.radius[s]);
+                } else {
+                    out += "polygon";
+                    PutNumber(out, compound.vertexCount[s]);
+                    for (uint32_t v = compound.firstVertex[s]; v < compound.firstVertex[s] + compound.vertexCount[s]; ++v) {
+                        PutNumber(out, compound.vertexX[v]);
+                        PutNumber(out, compound.vertexY[v]);
+                    }
+                }
+                if ((double)compound.density[s] != std::get<0>(key))
+                    PutNumber(out, compound.density[s]);
+                out.push_back('\n');
+            }
+            if (file && out.size() >= FlushSize) {
+                std::fwrite(out.data(), 1, out.size(), file);
+                out.clear();
+            }
+        }
+}
+
+bool SceneFile::Save(const World& world, const std::string& path)
+{
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    std::string out;
+    out.reserve(FlushSize + 4096);
+    Export(world, out, file);
+    std::fwrite(out.data(), 1, out.size(), file);
+    bool ok = std::ferror(file) == 0;
+    return std::fclose(file) == 0 && ok;
+}
+
+void SceneFile::Write(const World& world, std::string& out)
+{
+    Export(world, out, nullptr);
+}
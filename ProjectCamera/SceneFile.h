@@ -0,0 +1,64 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include "ThreadPool.h"
+
+class World;
+
+/**
+ * @class SceneFile
+ * @brief Text scene format with a parallel streaming loader and a matching exporter.
+ *
+ * One record per line; '#' starts a comment:
+ *
+ *   material <name> <density> <friction> <restitution>
+ *   body <dynamic|kinematic|static> <x> <y> [<vx> <vy>] [<material>]
+ *   circle <radius> [<density>]
+ *   polygon <count> <x1> <y1> ... <xn> <yn> [<density>]
+ *
+ * Shape lines attach to the body line before them (polygon vertices are body-local).
+ * A material is declared once, on a line before the bodies that use it; bodies without
+ * one use World::DefaultDensity and the Body friction/restitution defaults.
+ *
+ * Files are read in large blocks. Each block is cut at body boundaries into chunks that
+ * are parsed in parallel into flat per-chunk arrays (reused from block to block), then
+ * the bodies are created in file order on the calling thread.
+ */
+class SceneFile
+{
+public:
+    /**
+     * @brief Add every body of a scene file to a world.
+     * @param world World receiving the bodies
+     * @param path Scene file
+     * @param error Receives "file:line: message" on failure
+     * @param pool Pool for parsing chunks in parallel, or null for one thread
+     * @return False if the file could not be read or has a syntax error; bodies before the error stay added
+     */
+    static bool Load(World& world, const std::string& path, std::string& error, ThreadPool* pool);
+
+    /**
+     * @brief Add every body of scene text to a world.
+     * @param world World receiving the bodies
+     * @param text Scene text
+     * @param error Receives "line: message" on failure
+     * @param pool Pool for parsing chunks in parallel, or null for one thread
+     * @return False on a syntax error
+     */
+    static bool Parse(World& world, std::string_view text, std::string& error, ThreadPool* pool);
+
+    /**
+     * @brief Write every body and static body of a world to a scene file.
+     * @param world World to export
+     * @param path Output file
+     * @return False if the file could not be written
+     */
+    static bool Save(const World& world, const std::string& path);
+
+    /**
+     * @brief Append the scene text of a world to a string.
+     * @param world World to export
+     * @param out Receives the text (appended)
+     */
+    static void Write(const World& world, std::string& out);
+};
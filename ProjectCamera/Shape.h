@@ -1,9 +1,46 @@
 #pragma once
 #include "Vector.h"
-#include <SDL3/SDL.h>
+#include "globals.h"
+#include <cstddef>
+#include <cstdint>
+
+// Concrete shape type, so flat shape arrays can switch on it instead of calling through a vtable.
+// Shape objects only describe a shape while it is attached; bodies and snapshots store it as plain
+// values per kind. A new kind needs a value here, a Shape subclass computing the properties below,
+// storage in CompoundShape and ShapeTable, and a case in every switch on ShapeKind (the compiler
+// flags the ones missing it).
+enum class ShapeKind : uint8_t { Circle, Polygon };
+
+// Number of shape kinds, for per-kind arrays.
+constexpr size_t ShapeKindCount = 2;
+
 class Shape
 {
 public:
-	virtual void Render(const Vector<double>& position, SDL_Renderer* renderer) = 0;
-};
+	virtual ~Shape() = default;
 
+	ShapeKind Kind() const { return kind; }
+	// Radius of the smallest circle around the body origin that contains the shape
+	Real BoundingRadius() const { return boundingRadius; }
+	// Area, i.e. mass at unit density
+	Real Area() const { return area; }
+	// Centroid in body-local coordinates
+	Real CentroidX() const { return centroidX; }
+	Real CentroidY() const { return centroidY; }
+	// Moment of inertia about the centroid at unit density
+	Real Inertia() const { return inertia; }
+	// Local axis-aligned bounding box
+	Real MinX() const { return minX; }
+	Real MinY() const { return minY; }
+	Real MaxX() const { return maxX; }
+	Real MaxY() const { return maxY; }
+
+protected:
+	explicit Shape(ShapeKind kind) : kind(kind) {}
+
+	// Computed once by the derived constructor; shapes are immutable after that
+	ShapeKind kind;
+	Real area = 0, centroidX = 0, centroidY = 0, inertia = 0;
+	Real boundingRadius = 0;
+	Real minX = 0, minY = 0, maxX = 0, maxY = 0;
+};
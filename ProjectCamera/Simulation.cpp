@@ -0,0 +1,166 @@
+#include "Simulation.h"
+#include "AllocationTracker.h"
+#include <chrono>
+
+// Upper bound on catch-up steps per wake-up, so a slow step cannot spiral.
+static const int MaxStepsPerWake = 8;
+
+/**
+ * @brief Construct a simulation driving the given world.
+ * @param world World to step
+ * @param fixedStep Simulation time step in seconds
+ */
+Simulation::Simulation(World& world, double fixedStep)
+    : world(world)
+    , fixedStep(fixedStep)
+{
+}
+
+/**
+ * @brief Stop the simulation thread if it is still running.
+ */
+Simulation::~Simulation()
+{
+    Stop();
+}
+
+/**
+ * @brief Publish an initial snapshot and start the simulation thread.
+ */
+void Simulation::Start()
+{
+    if (running.exchange(true)) return;
+    Publish(); // the render thread always has something to draw
+    thread = std::thread(&Simulation::Run, this);
+}
+
+/**
+ * @brief Stop and join the simulation thread.
+ */
+void Simulation::Stop()
+{
+    running = false;
+    if (thread.joinable())
+        thread.join();
+}
+
+/**
+ * @brief Queue a world mutation to be applied at the next step boundary.
+ * @param command Callable receiving the world to mutate
+ */
+void Simulation::Post(CommandQueue::Command command)
+{
+    commands.Push(std::move(command));
+}
+
+/**
+ * @brief Fixed-rate loop run on the simulation thread.
+ *
+ * Commands are applied before each step, so every mutation lands on a step
+ * boundary. One snapshot is published per wake-up, after all due steps.
+ */
+void Simulation::Run()
+{
+    using Clock = std::chrono::steady_clock;
+    const auto step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(fixedStep));
+    auto next = Clock::now() + step;
+    while (running)
+    {
+        int steps = 0;
+        while (Clock::now() >= next && steps < MaxStepsPerWake)
+        {
+            {
+                AllocationScope scope(AllocationSubsystem::Commands);
+                commands.Apply(world);
+            }
+            world.Update(fixedStep);
+            next += step;
+            ++steps;
+        }
+        if (steps == MaxStepsPerWake)
+            next = Clock::now() + step; // fell behind: drop the backlog instead of spiraling
+        if (steps > 0)
+            Publish();
+        std::this_thread::sleep_until(next);
+    }
+}
+
+/**
+ * @brief Copy the current world state into the back snapshot buffer and publish it.
+ *
+ * The snapshot vectors are reused, so steady-state publishing does not allocate.
+ */
+void Simulation::Publish()
+{
+    AllocationScope allocationScope(AllocationSubsystem::Snapshot);
+    // Rebuild the shared shape table (dynamic shapes first, then static) and the static
+    // records only when bodies were added or removed
+    if (world.version != shapeTableVersion || world.staticVersion != staticTableVersion)
+    {
+        auto table = std::make_shared<ShapeTable>();
+        BodyRecords dynamicRecords; // Only the geometry is kept; moving records are written every publish below
+        for (const auto& bodyPtr : world.bodies)
+            table->Append(bodyPtr->compound, 0, 0, 0, dynamicRecords);
+        auto records = std::make_shared<BodyRecords>();
+        for (const auto& bodyPtr : world.staticBodies)
+            table->Append(bodyPtr->compound, (float)bodyPtr->position.x, (float)bodyPtr->position.y,
+                (float)bodyPtr->rotation, *records);
+        shapeTable = std::move(table);
+        staticRecords = std::move(records);
+        shapeTableVersion = world.version;
+        staticTableVersion = world.staticVersion;
+    }
+
+    RenderSnapshot& snapshot = snapshots.WriteBuffer();
+    snapshot.shapes = shapeTable;
+    snapshot.staticBodies = staticRecords;
+    snapshot.bodyCount = world.bodies.size();
+    snapshot.step = world.stepCount;
+
+    // Shape ids follow the same traversal order the table was built with: the n-th shape of a kind has id n
+    for (std::vector<BodySnapshot>& records : snapshot.bodies)
+        records.clear();
+    for (const auto& bodyPtr : world.bodies)
+    {
+        const CompoundShape& compound = bodyPtr->compound;
+        for (size_t i = 0; i < compound.Count(); ++i)
+        {
+            std::vector<BodySnapshot>& records = snapshot.bodies[(size_t)compound.kinds[i]];
+            records.push_back({ (float)bodyPtr->position.x, (float)bodyPtr->position.y,
+                (float)bodyPtr->rotation, (uint32_t)records.size() });
+        }
+    }
+
+    world.particles.CopyPoints(snapshot.particles);
+    world.fluid.CopyPoints(snapshot.fluid);
+    world.softBodies.CopyOutlines(snapshot.softOutlines, snapshot.softOutlineCounts);
+
+    snapshot.jointLines.clear();
+    for (const Joint& joint : world.joints.GetJoints())
+    {
+        Real anchors[4];
+        JointSolver::WorldAnchors(joint, anchors);
+        snapshot.jointLines.push_back({ (float)anchors[0], (float)anchors[1] });
+        snapshot.jointLines.push_back({ (float)anchors[2], (float)anchors[3] });
+    }
+
+    // Details for the Properties window; an out of range index falls back to the first body
+    snapshot.watched.request = watchRequests.load(std::memory_order_acquire); // Before the index it covers
+    size_t index = watchedIndex.load(std::memory_order_relaxed);
+    if (index >= world.bodies.size()) index = 0;
+    snapshot.watched.valid = !world.bodies.empty();
+    if (snapshot.watched.valid)
+    {
+        auto it = world.bodies.begin();
+        std::advance(it, index);
+        const Body* body = it->get();
+        snapshot.watched.index = index;
+        snapshot.watched.position = body->position;
+        snapshot.watched.velocity = body->velocity;
+        snapshot.watched.mass = double(body->mass);
+        snapshot.watched.friction = double(body->coeff_friction);
+        snapshot.watched.restitution = double(body->coeff_restitution);
+    }
+
+    snapshots.Publish();
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "World.h"
+#include "CommandQueue.h"
+#include "RenderSnapshot.h"
+#include "TripleBuffer.h"
+
+/**
+ * @class Simulation
+ * @brief Runs World::Update on its own thread at a fixed rate.
+ *
+ * After every batch of steps the simulation publishes a RenderSnapshot into a
+ * lock-free triple buffer, which the SDL thread reads without ever blocking.
+ * All world mutations from the UI are posted as commands and applied at step
+ * boundaries, so the world is only ever touched by the simulation thread.
+ */
+class Simulation
+{
+public:
+    /**
+     * @brief Construct a simulation driving the given world.
+     * @param world World to step (owned by the caller, must outlive the simulation)
+     * @param fixedStep Simulation time step in seconds
+     */
+    Simulation(World& world, double fixedStep = 1.0 / 120.0);
+
+    /**
+     * @brief Stop the simulation thread if it is still running.
+     */
+    ~Simulation();
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    /**
+     * @brief Start stepping the world on the simulation thread.
+     */
+    void Start();
+
+    /**
+     * @brief Stop and join the simulation thread.
+     */
+    void Stop();
+
+    /**
+     * @brief Queue a world mutation to be applied at the next step boundary.
+     * @param command Callable receiving the world to mutate
+     */
+    void Post(CommandQueue::Command command);
+
+    /**
+     * @brief Choose which body's details are copied into each snapshot.
+     * @param index Index of the body in World::bodies
+     * @return Number of this request; snapshots report the last request they reflect in watched.request
+     */
+    uint64_t Watch(size_t index)
+    {
+        watchedIndex.store(index, std::memory_order_relaxed);
+        return watchRequests.fetch_add(1, std::memory_order_release) + 1;
+    }
+
+    /**
+     * @brief Get the newest published snapshot (render thread only, never blocks).
+     * @return The most recent snapshot
+     */
+    const RenderSnapshot& AcquireSnapshot() { return snapshots.Acquire(); }
+
+    /**
+     * @brief Get the fixed simulation time step.
+     * @return Time step in seconds
+     */
+    double GetFixedStep() const { return fixedStep; }
+
+private:
+    // Thread body: apply commands, step, publish, sleep until the next step is due.
+    void Run();
+
+    // Copy the current world state into the back snapshot buffer and publish it.
+    void Publish();
+
+    World& world;                       ///< World stepped by this simulation
+    double fixedStep;                   ///< Time step in seconds
+    std::thread thread;                 ///< Simulation thread
+    std::atomic<bool> running{ false }; ///< Cleared to ask the thread to exit
+    std::atomic<size_t> watchedIndex{ 0 }; ///< Body index shown in the Properties window
+    std::atomic<uint64_t> watchRequests{ 0 }; ///< Watch calls so far
+    CommandQueue commands;              ///< Pending world mutations
+    TripleBuffer<RenderSnapshot> snapshots; ///< Published render state
+
+    std::shared_ptr<const ShapeTable> shapeTable; ///< Shared with snapshots
+    unsigned long long shapeTableVersion = ~0ull; ///< World::version the shape table was built for
+    std::shared_ptr<const BodyRecords> staticRecords; ///< Shared with snapshots
+    unsigned long long staticTableVersion = ~0ull; ///< World::staticVersion the static records were built for
+};
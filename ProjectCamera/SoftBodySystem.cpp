@@ -0,0 +1,264 @@
+// SoftBodySystem.cpp
+// Mass-spring soft bodies: SIMD spring evaluation over edge arrays, then per-point accumulation and integration.
+#include "SoftBodySystem.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SPRING_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPRING_SIMD_WIDTH 4
+#else
+#define SPRING_SIMD_WIDTH 1
+#endif
+
+// Substep length times the highest point frequency; symplectic Euler is stable below 2.
+static constexpr float StabilityLimit = 1.0f;
+
+// Shortest spring length used for its direction, so coincident points get no force instead of NaN.
+static constexpr float MinSpringLength = 1e-12f;
+
+// Arrays read and written by the spring pass.
+struct SpringArrays
+{
+    const float *px, *py, *vx, *vy;
+    const uint32_t *a, *b;
+    const float *rest, *k, *c;
+    float *fx, *fy;
+};
+
+/**
+ * @brief Force of a range of springs on their first point: (k * stretch + c * stretch speed) along the spring.
+ *
+ * With simd set, processes 8 (AVX2, gathered) or 4 (SSE2) springs per iteration, with a scalar
+ * tail; both paths perform the same operations in the same order.
+ */
+static void SpringForces(const SpringArrays& s, size_t begin, size_t end, bool simd)
+{
+    size_t i = begin;
+#if SPRING_SIMD_WIDTH == 8
+    if (simd)
+    {
+        const __m256 one = _mm256_set1_ps(1.0f), shortest = _mm256_set1_ps(MinSpringLength);
+        for (; i + 8 <= end; i += 8)
+        {
+            __m256i a = _mm256_loadu_si256((const __m256i*)(s.a + i));
+            __m256i b = _mm256_loadu_si256((const __m256i*)(s.b + i));
+            __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(s.px, b, 4), _mm256_i32gather_ps(s.px, a, 4));
+            __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(s.py, b, 4), _mm256_i32gather_ps(s.py, a, 4));
+            __m256 dvx = _mm256_sub_ps(_mm256_i32gather_ps(s.vx, b, 4), _mm256_i32gather_ps(s.vx, a, 4));
+            __m256 dvy = _mm256_sub_ps(_mm256_i32gather_ps(s.vy, b, 4), _mm256_i32gather_ps(s.vy, a, 4));
+            __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+            __m256 inverse = _mm256_div_ps(one, _mm256_max_ps(length, shortest));
+            __m256 nx = _mm256_mul_ps(dx, inverse), ny = _mm256_mul_ps(dy, inverse);
+            __m256 stretch = _mm256_sub_ps(length, _mm256_loadu_ps(s.rest + i));
+            __m256 speed = _mm256_add_ps(_mm256_mul_ps(dvx, nx), _mm256_mul_ps(dvy, ny));
+            __m256 force = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(s.k + i), stretch),
+                _mm256_mul_ps(_mm256_loadu_ps(s.c + i), speed));
+            _mm256_storeu_ps(s.fx + i, _mm256_mul_ps(force, nx));
+            _mm256_storeu_ps(s.fy + i, _mm256_mul_ps(force, ny));
+        }
+    }
+#elif SPRING_SIMD_WIDTH == 4
+    if (simd)
+    {
+        const __m128 one = _mm_set1_ps(1.0f), shortest = _mm_set1_ps(MinSpringLength);
+        auto gather = [](const float* values, const uint32_t* index) {
+            return _mm_set_ps(values[index[3]], values[index[2]], values[index[1]], values[index[0]]);
+        };
+        for (; i + 4 <= end; i += 4)
+        {
+            const uint32_t* a = s.a + i;
+            const uint32_t* b = s.b + i;
+            __m128 dx = _mm_sub_ps(gather(s.px, b), gather(s.px, a));
+            __m128 dy = _mm_sub_ps(gather(s.py, b), gather(s.py, a));
+            __m128 dvx = _mm_sub_ps(gather(s.vx, b), gather(s.vx, a));
+            __m128 dvy = _mm_sub_ps(gather(s.vy, b), gather(s.vy, a));
+            __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+            __m128 inverse = _mm_div_ps(one, _mm_max_ps(length, shortest));
+            __m128 nx = _mm_mul_ps(dx, inverse), ny = _mm_mul_ps(dy, inverse);
+            __m128 stretch = _mm_sub_ps(length, _mm_loadu_ps(s.rest + i));
+            __m128 speed = _mm_add_ps(_mm_mul_ps(dvx, nx), _mm_mul_ps(dvy, ny));
+            __m128 force = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(s.k + i), stretch), _mm_mul_ps(_mm_loadu_ps(s.c + i), speed));
+            _mm_storeu_ps(s.fx + i, _mm_mul_ps(force, nx));
+            _mm_storeu_ps(s.fy + i, _mm_mul_ps(force, ny));
+        }
+    }
+#else
+    (void)simd;
+#endif
+    for (; i < end; ++i)
+    {
+        uint32_t a = s.a[i], b = s.b[i];
+        float dx = s.px[b] - s.px[a], dy = s.py[b] - s.py[a];
+        float dvx = s.vx[b] - s.vx[a], dvy = s.vy[b] - s.vy[a];
+        float length = std::sqrt(dx * dx + dy * dy);
+        float inverse = 1.0f / std::max(length, MinSpringLength);
+        float nx = dx * inverse, ny = dy * inverse;
+        float force = s.k[i] * (length - s.rest[i]) + s.c[i] * (dvx * nx + dvy * ny);
+        s.fx[i] = force * nx;
+        s.fy[i] = force * ny;
+    }
+}
+
+// Add a lattice of points joined by horizontal, vertical and both diagonal springs.
+int SoftBodySystem::AddLattice(float x, float y, int columns, int rows, float spacing, float pointMass,
+    float springStiffness, float springDamping, bool pinTop)
+{
+    if (columns < 2 || rows < 2 || spacing <= 0.0f || pointMass <= 0.0f) return -1;
+    SoftBody body;
+    body.firstPoint = (uint32_t)PointCount();
+    body.pointCount = (uint32_t)(columns * rows);
+    body.firstSpring = (uint32_t)SpringCount();
+    body.firstOutline = (uint32_t)outline.size();
+    for (int r = 0; r < rows; ++r)
+        for (int c = 0; c < columns; ++c)
+        {
+            posX.push_back(x + spacing * c);
+            posY.push_back(y + spacing * r);
+            velX.push_back(0.0f);
+            velY.push_back(0.0f);
+            inverseMass.push_back(pinTop && r == 0 ? 0.0f : 1.0f / pointMass);
+        }
+
+    auto point = [&](int c, int r) { return body.firstPoint + (uint32_t)(r * columns + c); };
+    auto addSpring = [&](uint32_t a, uint32_t b) {
+        springA.push_back(a);
+        springB.push_back(b);
+        restLength.push_back(std::hypot(posX[b] - posX[a], posY[b] - posY[a]));
+        stiffness.push_back(springStiffness);
+        damping.push_back(springDamping);
+    };
+    for (int r = 0; r < rows; ++r)
+        for (int c = 0; c < columns; ++c)
+        {
+            if (c + 1 < columns) addSpring(point(c, r), point(c + 1, r));
+            if (r + 1 < rows) addSpring(point(c, r), point(c, r + 1));
+            if (c + 1 < columns && r + 1 < rows) {
+                addSpring(point(c, r), point(c + 1, r + 1));     // Shear springs keep the cells from collapsing
+                addSpring(point(c + 1, r), point(c, r + 1));
+            }
+        }
+    body.springCount = (uint32_t)SpringCount() - body.firstSpring;
+
+    // Hull: the lattice border, clockwise from the top left point
+    for (int c = 0; c < columns; ++c) outline.push_back(point(c, 0));
+    for (int r = 1; r < rows; ++r) outline.push_back(point(columns - 1, r));
+    for (int c = columns - 2; c >= 0; --c) outline.push_back(point(c, rows - 1));
+    for (int r = rows - 2; r > 0; --r) outline.push_back(point(0, r));
+    body.outlineCount = (uint32_t)outline.size() - body.firstOutline;
+
+    bodies.push_back(body);
+    prepared = false;
+    return (int)bodies.size() - 1;
+}
+
+// Build the per-point spring lists and the highest point frequency, which sets the substep count.
+void SoftBodySystem::Prepare()
+{
+    size_t points = PointCount(), springs = SpringCount();
+    incidentFirst.assign(points + 1, 0);
+    for (size_t s = 0; s < springs; ++s)
+    {
+        ++incidentFirst[springA[s] + 1];
+        ++incidentFirst[springB[s] + 1];
+    }
+    for (size_t p = 0; p < points; ++p)
+        incidentFirst[p + 1] += incidentFirst[p];
+    incident.resize(2 * springs);
+    std::vector<uint32_t> fill(incidentFirst.begin(), incidentFirst.end() - 1);
+    std::vector<float> sumStiffness(points, 0.0f), sumDamping(points, 0.0f);
+    for (size_t s = 0; s < springs; ++s)
+    {
+        incident[fill[springA[s]]++] = (uint32_t)(s << 1);
+        incident[fill[springB[s]]++] = (uint32_t)(s << 1 | 1);
+        for (uint32_t p : { springA[s], springB[s] })
+        {
+            sumStiffness[p] += stiffness[s];
+            sumDamping[p] += damping[s];
+        }
+    }
+    maxFrequency = 0.0f;
+    for (size_t p = 0; p < points; ++p)
+        maxFrequency = std::max(maxFrequency, std::sqrt(sumStiffness[p] * inverseMass[p]) + sumDamping[p] * inverseMass[p]);
+    forceX.resize(springs);
+    forceY.resize(springs);
+    prepared = true;
+}
+
+// Split the step into stable substeps; each evaluates all springs, then moves all points.
+void SoftBodySystem::Update(float deltaTime, ThreadPool* pool)
+{
+    if (!prepared) Prepare();
+    size_t points = PointCount(), springs = SpringCount();
+    substeps = 0;
+    if (points == 0 || deltaTime <= 0.0f) return;
+    substeps = std::clamp((int)std::ceil(deltaTime * maxFrequency / StabilityLimit), 1, std::max(maxSubsteps, 1));
+    const float h = deltaTime / substeps;
+
+    const SpringArrays arrays{ posX.data(), posY.data(), velX.data(), velY.data(), springA.data(), springB.data(),
+        restLength.data(), stiffness.data(), damping.data(), forceX.data(), forceY.data() };
+    auto springRange = [&](size_t begin, size_t end) {
+        SpringForces(arrays, begin, end, vectorized);
+    };
+    auto pointRange = [&](size_t begin, size_t end) {
+        for (size_t p = begin; p < end; ++p)
+        {
+            float fx = 0.0f, fy = 0.0f;
+            for (uint32_t k = incidentFirst[p]; k < incidentFirst[p + 1]; ++k)
+            {
+                uint32_t entry = incident[k];
+                if (entry & 1) { fx -= forceX[entry >> 1]; fy -= forceY[entry >> 1]; }
+                else { fx += forceX[entry >> 1]; fy += forceY[entry >> 1]; }
+            }
+            float w = inverseMass[p];
+            if (w == 0.0f) continue; // Pinned
+            velX[p] += (gravityX + fx * w) * h;
+            velY[p] += (gravityY + fy * w) * h;
+            posX[p] += velX[p] * h;
+            posY[p] += velY[p] * h;
+            if (posY[p] > floorY) {
+                posY[p] = floorY;
+                velY[p] = std::min(velY[p], 0.0f);
+            }
+        }
+    };
+    for (int s = 0; s < substeps; ++s)
+    {
+        if (pool) pool->ParallelFor(springs, 4096, springRange);
+        else springRange(0, springs);
+        if (pool) pool->ParallelFor(points, 2048, pointRange);
+        else pointRange(0, points);
+    }
+}
+
+// Closed outline strips of all bodies, one after another.
+void SoftBodySystem::CopyOutlines(std::vector<SDL_FPoint>& points, std::vector<uint32_t>& counts) const
+{
+    points.clear();
+    counts.clear();
+    for (const SoftBody& body : bodies)
+    {
+        for (uint32_t i = 0; i <= body.outlineCount; ++i)
+        {
+            uint32_t p = outline[body.firstOutline + (i == body.outlineCount ? 0 : i)]; // Back to the first point
+            points.push_back({ posX[p], posY[p] });
+        }
+        counts.push_back(body.outlineCount + 1);
+    }
+}
+
+// Remove all soft bodies.
+void SoftBodySystem::Clear()
+{
+    posX.clear(); posY.clear();
+    velX.clear(); velY.clear();
+    inverseMass.clear();
+    springA.clear(); springB.clear();
+    restLength.clear(); stiffness.clear(); damping.clear();
+    outline.clear();
+    bodies.clear();
+    prepared = false;
+}
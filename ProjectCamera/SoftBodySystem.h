@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <SDL3/SDL.h>
+#include "ThreadPool.h"
+
+/**
+ * @struct SoftBody
+ * @brief One deformable object: its ranges in the point, spring and outline arrays of a SoftBodySystem.
+ */
+struct SoftBody
+{
+    uint32_t firstPoint = 0, pointCount = 0;     ///< Points of the body
+    uint32_t firstSpring = 0, springCount = 0;   ///< Springs between its points
+    uint32_t firstOutline = 0, outlineCount = 0; ///< Hull of the points, as indices into the point arrays in drawing order
+};
+
+/**
+ * @class SoftBodySystem
+ * @brief Mass-spring soft bodies: point masses joined by damped springs, stored as structure-of-arrays.
+ *
+ * Every substep first evaluates all springs over the contiguous edge arrays, 8 (AVX2) or
+ * 4 (SSE2) at a time, writing one force per spring. Then every point sums the forces of its
+ * own springs through a compressed incidence list and integrates with symplectic Euler.
+ * Neither pass writes anything another chunk reads, so both run in parallel chunks
+ * without atomics, and the result does not depend on the thread count.
+ *
+ * Explicit springs blow up when a substep is long compared to their period, so each step is
+ * split into as many substeps as the stiffest point needs (up to maxSubsteps). Soft bodies do
+ * not collide with rigid bodies or each other; they only rest on an optional floor.
+ */
+class SoftBodySystem
+{
+public:
+    std::vector<float> posX, posY;   ///< Point positions
+    std::vector<float> velX, velY;   ///< Point velocities
+    std::vector<float> inverseMass;  ///< 1 / mass of each point, 0 for pinned points
+    std::vector<uint32_t> springA, springB; ///< Points joined by each spring
+    std::vector<float> restLength, stiffness, damping; ///< Per-spring parameters
+    std::vector<uint32_t> outline;   ///< Outline indices of all bodies, see SoftBody
+    std::vector<SoftBody> bodies;    ///< Soft bodies in creation order
+
+    float gravityX = 0.0f, gravityY = 0.0f; ///< Uniform acceleration applied to all points
+    float floorY = std::numeric_limits<float>::infinity(); ///< Points are kept above this height (y grows downward)
+    int maxSubsteps = 64;            ///< Upper bound on substeps per Update
+    bool vectorized = true;          ///< Use the SIMD spring kernel (the scalar one is kept for comparison)
+
+    /**
+     * @brief Add a rectangular lattice with structural and shear springs, its top left point at (x, y).
+     * @param x,y Position of the top left point
+     * @param columns,rows Points per row and per column (at least 2 each)
+     * @param spacing Rest distance between neighboring points
+     * @param pointMass Mass of every point
+     * @param springStiffness Stiffness of every spring (force per unit of stretch)
+     * @param springDamping Damping of every spring (force per unit of stretch speed)
+     * @param pinTop Pin the top row in place
+     * @return Index of the new body in bodies, or -1 if the lattice is degenerate
+     */
+    int AddLattice(float x, float y, int columns, int rows, float spacing, float pointMass,
+        float springStiffness, float springDamping, bool pinTop);
+
+    /**
+     * @brief Advance all soft bodies by one step, split into stable substeps.
+     * @param deltaTime Time step in seconds
+     * @param pool Thread pool for both passes (nullptr runs serially)
+     */
+    void Update(float deltaTime, ThreadPool* pool);
+
+    /**
+     * @brief Copy the outline of every body as a closed line strip for batched rendering.
+     * @param points Receives the strips one after another (reused)
+     * @param counts Receives the number of points of each strip (reused)
+     */
+    void CopyOutlines(std::vector<SDL_FPoint>& points, std::vector<uint32_t>& counts) const;
+
+    /**
+     * @brief Remove all soft bodies.
+     */
+    void Clear();
+
+    size_t PointCount() const { return posX.size(); }      ///< Points of all bodies
+    size_t SpringCount() const { return springA.size(); }  ///< Springs of all bodies
+    int GetSubsteps() const { return substeps; }          ///< Substeps used by the last Update
+
+private:
+    // Rebuild the incidence lists and the stable substep length after springs were added.
+    void Prepare();
+
+    std::vector<float> forceX, forceY;    ///< Force of each spring on its first point, per substep
+    std::vector<uint32_t> incidentFirst;  ///< Start of each point's list in incident, plus an end marker
+    std::vector<uint32_t> incident;       ///< Spring index << 1, low bit set where the point is the spring's second point
+    float maxFrequency = 0.0f;            ///< Highest point frequency (stiffness and damping over mass), per second
+    bool prepared = true;                 ///< Incidence lists match the springs
+    int substeps = 0;
+};
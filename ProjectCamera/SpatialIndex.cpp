@@ -0,0 +1,210 @@
+#include "SpatialIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Items per leaf
+static const int LeafSize = 4;
+// Deep enough for any balanced tree over size_t items
+static const int StackSize = 128;
+
+/**
+ * @brief Rebuild the tree over the current body positions.
+ * @param bodies Bodies of the world
+ */
+void SpatialIndex::Build(const std::list<std::unique_ptr<Body>>& bodies)
+{
+    items.clear();
+    nodes.clear();
+    size_t index = 0;
+    for (const auto& bodyPtr : bodies)
+    {
+        double radius = double(bodyPtr->compound.boundingRadius);
+        items.push_back({ double(bodyPtr->position.x), double(bodyPtr->position.y), radius, index++ });
+    }
+    if (!items.empty())
+        BuildNode(0, (int)items.size());
+}
+
+/**
+ * @brief Build a subtree with a median split along the longest axis of the item centers.
+ */
+int SpatialIndex::BuildNode(int first, int count)
+{
+    int nodeIndex = (int)nodes.size();
+    nodes.push_back({});
+    Node bounds = { std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), first, count };
+    double cminX = bounds.minX, cminY = bounds.minY, cmaxX = bounds.maxX, cmaxY = bounds.maxY;
+    for (int i = first; i < first + count; ++i)
+    {
+        const Item& item = items[i];
+        bounds.minX = std::min(bounds.minX, item.x - item.radius);
+        bounds.minY = std::min(bounds.minY, item.y - item.radius);
+        bounds.maxX = std::max(bounds.maxX, item.x + item.radius);
+        bounds.maxY = std::max(bounds.maxY, item.y + item.radius);
+        cminX = std::min(cminX, item.x); cmaxX = std::max(cmaxX, item.x);
+        cminY = std::min(cminY, item.y); cmaxY = std::max(cmaxY, item.y);
+    }
+    if (count <= LeafSize)
+    {
+        nodes[nodeIndex] = bounds;
+        return nodeIndex;
+    }
+    bool splitX = (cmaxX - cminX) >= (cmaxY - cminY);
+    int half = count / 2;
+    std::nth_element(items.begin() + first, items.begin() + first + half, items.begin() + first + count,
+        [splitX](const Item& a, const Item& b) { return splitX ? a.x < b.x : a.y < b.y; });
+    BuildNode(first, half);                            // left child at nodeIndex + 1
+    int right = BuildNode(first + half, count - half);
+    bounds.first = right;
+    bounds.count = 0;
+    nodes[nodeIndex] = bounds;
+    return nodeIndex;
+}
+
+// Region query: prune boxes that miss the region, then test each bounding circle against it.
+void SpatialIndex::QueryRegion(double minX, double minY, double maxX, double maxY, std::vector<size_t>& output) const
+{
+    if (nodes.empty()) return;
+    int stack[StackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        int nodeIndex = stack[--top];
+        const Node& node = nodes[nodeIndex];
+        if (node.maxX < minX || node.minX > maxX || node.maxY < minY || node.minY > maxY) continue;
+        if (node.count == 0)
+        {
+            stack[top++] = nodeIndex + 1;
+            stack[top++] = node.first;
+            continue;
+        }
+        for (int i = node.first; i < node.first + node.count; ++i)
+        {
+            const Item& item = items[i];
+            // Closest point of the box to the circle center
+            double cx = std::clamp(item.x, minX, maxX), cy = std::clamp(item.y, minY, maxY);
+            double dx = item.x - cx, dy = item.y - cy;
+            if (dx * dx + dy * dy <= item.radius * item.radius)
+                output.push_back(item.body);
+        }
+    }
+}
+
+// Radius query: prune boxes farther than the radius, then test circle against circle.
+void SpatialIndex::QueryRadius(double x, double y, double radius, std::vector<size_t>& output) const
+{
+    if (nodes.empty()) return;
+    int stack[StackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        int nodeIndex = stack[--top];
+        const Node& node = nodes[nodeIndex];
+        double cx = std::clamp(x, node.minX, node.maxX), cy = std::clamp(y, node.minY, node.maxY);
+        if ((x - cx) * (x - cx) + (y - cy) * (y - cy) > radius * radius) continue;
+        if (node.count == 0)
+        {
+            stack[top++] = nodeIndex + 1;
+            stack[top++] = node.first;
+            continue;
+        }
+        for (int i = node.first; i < node.first + node.count; ++i)
+        {
+            const Item& item = items[i];
+            double dx = item.x - x, dy = item.y - y, reach = item.radius + radius;
+            if (dx * dx + dy * dy <= reach * reach)
+                output.push_back(item.body);
+        }
+    }
+}
+
+// Closest-hit raycast: slab test per node, shrinking the search as closer hits are found.
+RayHit SpatialIndex::Raycast(const RayQuery& ray) const
+{
+    RayHit result;
+    double length = std::sqrt(ray.directionX * ray.directionX + ray.directionY * ray.directionY);
+    if (nodes.empty() || length <= 0.0) return result;
+    const double dx = ray.directionX / length, dy = ray.directionY / length;
+    const double invX = 1.0 / dx, invY = 1.0 / dy; // infinities are fine for the slab test
+    double best = ray.maxDistance;
+    int stack[StackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        int nodeIndex = stack[--top];
+        const Node& node = nodes[nodeIndex];
+        // Slab test against the node box, clipped to the best hit so far
+        double tx1 = (node.minX - ray.originX) * invX, tx2 = (node.maxX - ray.originX) * invX;
+        double ty1 = (node.minY - ray.originY) * invY, ty2 = (node.maxY - ray.originY) * invY;
+        double tmin = std::max(std::min(tx1, tx2), std::min(ty1, ty2));
+        double tmax = std::min(std::max(tx1, tx2), std::max(ty1, ty2));
+        if (std::isnan(tmin) || std::isnan(tmax)) { tmin = 0.0; tmax = best; } // ray along a box edge
+        if (tmax < 0.0 || tmin > tmax || tmin > best) continue;
+        if (node.count == 0)
+        {
+            stack[top++] = nodeIndex + 1;
+            stack[top++] = node.first;
+            continue;
+        }
+        for (int i = node.first; i < node.first + node.count; ++i)
+        {
+            const Item& item = items[i];
+            // Ray against bounding circle: |o + t d - c|^2 = r^2
+            double ox = ray.originX - item.x, oy = ray.originY - item.y;
+            double b = ox * dx + oy * dy;
+            double c = ox * ox + oy * oy - item.radius * item.radius;
+            double disc = b * b - c;
+            if (disc < 0.0) continue;
+            double t = -b - std::sqrt(disc);
+            if (t < 0.0) t = c <= 0.0 ? 0.0 : -1.0; // origin inside the circle hits at 0
+            if (t >= 0.0 && t <= best)
+            {
+                best = t;
+                result.hit = true;
+                result.body = item.body;
+                result.distance = t;
+            }
+        }
+    }
+    return result;
+}
+
+// Point pick: among bounding circles containing the point, take the closest center.
+bool SpatialIndex::Pick(double x, double y, size_t& index) const
+{
+    if (nodes.empty()) return false;
+    double bestDistance = std::numeric_limits<double>::max();
+    bool found = false;
+    int stack[StackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        int nodeIndex = stack[--top];
+        const Node& node = nodes[nodeIndex];
+        if (x < node.minX || x > node.maxX || y < node.minY || y > node.maxY) continue;
+        if (node.count == 0)
+        {
+            stack[top++] = nodeIndex + 1;
+            stack[top++] = node.first;
+            continue;
+        }
+        for (int i = node.first; i < node.first + node.count; ++i)
+        {
+            const Item& item = items[i];
+            double d2 = (item.x - x) * (item.x - x) + (item.y - y) * (item.y - y);
+            if (d2 <= item.radius * item.radius && d2 < bestDistance)
+            {
+                bestDistance = d2;
+                index = item.body;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <list>
+#include <memory>
+#include <vector>
+#include "Body.h"
+
+/**
+ * @struct RayQuery
+ * @brief A ray for batched raycasts: origin, direction (any length) and maximum distance.
+ */
+struct RayQuery
+{
+    double originX, originY;
+    double directionX, directionY;
+    double maxDistance;
+};
+
+/**
+ * @struct RayHit
+ * @brief Closest body hit by a ray, if any.
+ */
+struct RayHit
+{
+    bool hit = false;     ///< False if the ray hit nothing within its maximum distance
+    size_t body = 0;      ///< Index of the body in World::bodies (World::staticBodies if staticBody)
+    bool staticBody = false; ///< The hit body is static
+    double distance = 0.0; ///< Distance from the ray origin to the hit point
+};
+
+/**
+ * @class SpatialIndex
+ * @brief Bounding volume hierarchy over the bodies of a world.
+ *
+ * Each body is represented by its bounding circle (position plus the largest shape
+ * BoundingRadius). The tree is built top-down with median splits along the longest
+ * axis and answers region, radius, ray and point queries in O(log n) per result.
+ * Queries are const and may run concurrently once the tree is built.
+ */
+class SpatialIndex
+{
+public:
+    /**
+     * @brief Rebuild the tree over the current body positions.
+     * @param bodies Bodies of the world; results refer to their list index
+     */
+    void Build(const std::list<std::unique_ptr<Body>>& bodies);
+
+    /**
+     * @brief Find bodies whose bounding circle overlaps an axis-aligned box.
+     * @param output Receives body indices (appended)
+     */
+    void QueryRegion(double minX, double minY, double maxX, double maxY, std::vector<size_t>& output) const;
+
+    /**
+     * @brief Find bodies whose bounding circle overlaps a circle.
+     * @param output Receives body indices (appended)
+     */
+    void QueryRadius(double x, double y, double radius, std::vector<size_t>& output) const;
+
+    /**
+     * @brief Find the closest body along a ray.
+     * @param ray The ray to cast
+     * @return Closest hit, if any
+     */
+    RayHit Raycast(const RayQuery& ray) const;
+
+    /**
+     * @brief Find the body under a point (the one whose center is closest, if several overlap).
+     * @param index Receives the body index
+     * @return False if no body contains the point
+     */
+    bool Pick(double x, double y, size_t& index) const;
+
+private:
+    struct Item
+    {
+        double x, y, radius; ///< Bounding circle
+        size_t body;         ///< Index in World::bodies
+    };
+    struct Node
+    {
+        double minX, minY, maxX, maxY; ///< Bounds of everything below
+        int first, count;              ///< Leaf: item range; internal: count is 0, first is the right child
+    };
+
+    // Build the subtree over items [first, first + count) and return its node index.
+    int BuildNode(int first, int count);
+
+    std::vector<Item> items; ///< Reordered so every leaf owns a contiguous range
+    std::vector<Node> nodes; ///< Depth-first, root first: an internal node's left child directly follows it
+};
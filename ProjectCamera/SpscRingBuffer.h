@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class SpscRingBuffer
+ * @brief Lock-free bounded queue for exactly one producer and one consumer thread.
+ * @tparam T Trivially copyable element type
+ *
+ * The producer never waits: if there is not enough room, a batch is rejected and the
+ * caller decides what to drop. Head and tail live on separate cache lines so the two
+ * threads do not false-share.
+ */
+template<typename T>
+class SpscRingBuffer
+{
+public:
+    /**
+     * @brief Allocate the ring.
+     * @param capacity Number of elements, rounded up to a power of two
+     */
+    explicit SpscRingBuffer(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    /**
+     * @brief Push a whole batch or nothing (producer thread only).
+     * @param items Elements to copy in
+     * @param count Number of elements
+     * @return False if the batch did not fit
+     */
+    bool TryPush(const T* items, size_t count)
+    {
+        size_t head = this->head.load(std::memory_order_relaxed);
+        size_t tail = this->tail.load(std::memory_order_acquire);
+        if (slots.size() - (head - tail) < count) return false;
+        for (size_t i = 0; i < count; ++i)
+            slots[(head + i) & mask] = items[i];
+        this->head.store(head + count, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pop up to maxCount elements (consumer thread only).
+     * @param items Receives the elements
+     * @param maxCount Room in items
+     * @return Number of elements popped
+     */
+    size_t Pop(T* items, size_t maxCount)
+    {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        size_t head = this->head.load(std::memory_order_acquire);
+        size_t count = head - tail;
+        if (count > maxCount) count = maxCount;
+        for (size_t i = 0; i < count; ++i)
+            items[i] = slots[(tail + i) & mask];
+        this->tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Capacity of the ring.
+     * @return Number of slots
+     */
+    size_t Capacity() const { return slots.size(); }
+
+private:
+    std::vector<T> slots;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> head{ 0 }; ///< Next slot the producer writes
+    alignas(64) std::atomic<size_t> tail{ 0 }; ///< Next slot the consumer reads
+};
@@ -0,0 +1,121 @@
+// SweepAndPrune.cpp
+// Sort-and-sweep broad phase that exploits temporal coherence between steps.
+#include "SweepAndPrune.h"
+#include <algorithm>
+
+void SweepAndPrune::Update(const std::list<std::unique_ptr<Body>>& bodies, unsigned long long version)
+{
+    UpdateBounds(bodies);
+    swapCount = 0;
+    rebuilt = version != builtVersion || endpoints[0].size() != 2 * bodies.size();
+    if (rebuilt) {
+        Rebuild();
+        builtVersion = version;
+        return;
+    }
+    SortAxis(0);
+    SortAxis(1);
+}
+
+void SweepAndPrune::Reset()
+{
+    endpoints[0].clear();
+    endpoints[1].clear();
+    pairs.clear();
+    builtVersion = ~0ull;
+}
+
+void SweepAndPrune::GetPairs(std::vector<std::pair<uint32_t, uint32_t>>& output) const
+{
+    output.clear();
+    output.reserve(pairs.size());
+    for (uint64_t key : pairs)
+        output.push_back({ (uint32_t)(key >> 32), (uint32_t)key });
+}
+
+void SweepAndPrune::UpdateBounds(const std::list<std::unique_ptr<Body>>& bodies)
+{
+    size_t n = bodies.size();
+    minX.resize(n); minY.resize(n); maxX.resize(n); maxY.resize(n);
+    size_t i = 0;
+    for (const auto& bodyPtr : bodies)
+    {
+        const Body& body = *bodyPtr;
+        minX[i] = body.position.x + body.compound.minX;
+        minY[i] = body.position.y + body.compound.minY;
+        maxX[i] = body.position.x + body.compound.maxX;
+        maxY[i] = body.position.y + body.compound.maxY;
+        ++i;
+    }
+}
+
+void SweepAndPrune::Rebuild()
+{
+    uint32_t n = (uint32_t)minX.size();
+    const std::vector<Real>* low[2] = { &minX, &minY };
+    const std::vector<Real>* high[2] = { &maxX, &maxY };
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        std::vector<Endpoint>& list = endpoints[axis];
+        list.resize(2 * (size_t)n);
+        for (uint32_t i = 0; i < n; ++i) {
+            list[2 * i] = { (*low[axis])[i], i << 1 };
+            list[2 * i + 1] = { (*high[axis])[i], i << 1 | 1 };
+        }
+        // Mins before maxes at equal values, so touching boxes count as overlapping like Overlaps does
+        std::sort(list.begin(), list.end(), [](const Endpoint& a, const Endpoint& b) {
+            return a.value < b.value || (a.value == b.value && (a.tag & 1) < (b.tag & 1));
+        });
+    }
+
+    // Sweep x: every body whose min is passed while another is open overlaps it on x
+    pairs.clear();
+    std::vector<uint32_t> open;
+    for (const Endpoint& endpoint : endpoints[0])
+    {
+        uint32_t body = endpoint.tag >> 1;
+        if (endpoint.tag & 1) {
+            open.erase(std::find(open.begin(), open.end(), body));
+            continue;
+        }
+        for (uint32_t other : open)
+            if (minY[body] <= maxY[other] && minY[other] <= maxY[body])
+                pairs.insert(PairKey(body, other));
+        open.push_back(body);
+    }
+}
+
+void SweepAndPrune::SortAxis(int axis)
+{
+    std::vector<Endpoint>& list = endpoints[axis];
+    const std::vector<Real>& low = axis == 0 ? minX : minY;
+    const std::vector<Real>& high = axis == 0 ? maxX : maxY;
+
+    // Refresh the values in place; the order is still last step's
+    for (Endpoint& endpoint : list)
+        endpoint.value = (endpoint.tag & 1) ? high[endpoint.tag >> 1] : low[endpoint.tag >> 1];
+
+    for (size_t i = 1; i < list.size(); ++i)
+    {
+        Endpoint moving = list[i];
+        size_t j = i;
+        while (j > 0 && (list[j - 1].value > moving.value ||
+            (list[j - 1].value == moving.value && (list[j - 1].tag & 1) > (moving.tag & 1))))
+        {
+            const Endpoint& passed = list[j - 1];
+            uint32_t a = moving.tag >> 1, b = passed.tag >> 1;
+            bool movingIsMax = moving.tag & 1, passedIsMax = passed.tag & 1;
+            if (!movingIsMax && passedIsMax) {
+                // A min moved below another box's max: they may now overlap
+                if (Overlaps(a, b)) pairs.insert(PairKey(a, b));
+            } else if (movingIsMax && !passedIsMax) {
+                // A max moved below another box's min: they no longer overlap on this axis
+                pairs.erase(PairKey(a, b));
+            }
+            list[j] = passed;
+            --j;
+            ++swapCount;
+        }
+        list[j] = moving;
+    }
+}
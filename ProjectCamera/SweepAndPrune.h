@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <memory_resource>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "Body.h"
+#include "globals.h"
+
+/**
+ * @class SweepAndPrune
+ * @brief Incremental broad phase: bodies whose world AABBs overlap, kept up to date every step.
+ *
+ * The min and max of every body's box are stored as endpoints in one sorted array per axis.
+ * Each step the arrays are re-sorted with insertion sort, which is close to O(n) when bodies
+ * move little, and every endpoint swap updates the overlap pair set directly: a min passing a
+ * max left-to-right can start an overlap, a max passing a min ends one. Only adding or
+ * removing bodies triggers a full rebuild.
+ */
+class SweepAndPrune
+{
+public:
+    bool enabled = false; ///< Updated by World::Update only when enabled
+
+    /**
+     * @brief Bring the endpoint arrays and pair set up to date with the current body positions.
+     * @param bodies Bodies of the world; pairs refer to their list index
+     * @param version World::version, to detect added or removed bodies
+     */
+    void Update(const std::list<std::unique_ptr<Body>>& bodies, unsigned long long version);
+
+    /**
+     * @brief Drop all state, so the next Update rebuilds from scratch.
+     */
+    void Reset();
+
+    /**
+     * @brief Copy the overlapping pairs out, lower body index first.
+     * @param output Receives the pairs (replaced)
+     */
+    void GetPairs(std::vector<std::pair<uint32_t, uint32_t>>& output) const;
+
+    size_t GetPairCount() const { return pairs.size(); }
+    size_t GetSwapCount() const { return swapCount; }   ///< Endpoint swaps in the last Update
+    bool WasRebuilt() const { return rebuilt; }         ///< Last Update sorted from scratch
+
+private:
+    /// One end of a body's box on one axis
+    struct Endpoint
+    {
+        Real value;
+        uint32_t tag; ///< body index << 1 | 1 for a max endpoint
+    };
+
+    // Recompute the world AABB of every body.
+    void UpdateBounds(const std::list<std::unique_ptr<Body>>& bodies);
+
+    // Fill and fully sort the endpoint arrays and find all pairs with one sweep.
+    void Rebuild();
+
+    // Insertion-sort one axis, adding and removing pairs on every swap.
+    void SortAxis(int axis);
+
+    // True if the boxes of two bodies overlap on both axes.
+    bool Overlaps(uint32_t a, uint32_t b) const
+    {
+        return minX[a] <= maxX[b] && minX[b] <= maxX[a] && minY[a] <= maxY[b] && minY[b] <= maxY[a];
+    }
+
+    static uint64_t PairKey(uint32_t a, uint32_t b)
+    {
+        return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+    }
+
+    std::vector<Real> minX, minY, maxX, maxY; ///< World AABB per body
+    std::vector<Endpoint> endpoints[2];       ///< Sorted endpoints for x and y
+    // Pair nodes are recycled through this pool, so pairs that begin and end every step do not
+    // reach the heap once it has grown to the peak pair count. Declared before the set it feeds.
+    std::pmr::unsynchronized_pool_resource pairNodes;
+    std::pmr::unordered_set<uint64_t> pairs{ &pairNodes }; ///< Overlapping pairs as PairKey
+    unsigned long long builtVersion = ~0ull;  ///< World::version the arrays were built for
+    size_t swapCount = 0;
+    bool rebuilt = false;
+};
@@ -0,0 +1,182 @@
+// Telemetry.cpp
+// Background writer for per-step body telemetry.
+#include "Telemetry.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <SDL3/SDL.h>
+#include "World.h"
+
+// Records encoded per block
+static const size_t BlockSize = 1 << 14;
+
+// Append an unsigned LEB128 varint.
+static void PutVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+// Append raw bytes.
+static void PutBytes(std::vector<uint8_t>& out, const void* data, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+// Replace every run of zero bytes by 0x00 followed by the run length as a varint.
+static void ZeroRunLengthEncode(const std::vector<uint8_t>& in, std::vector<uint8_t>& out)
+{
+    out.clear();
+    for (size_t i = 0; i < in.size();) {
+        if (in[i] != 0) {
+            out.push_back(in[i++]);
+            continue;
+        }
+        size_t run = 0;
+        while (i < in.size() && in[i] == 0) { ++run; ++i; }
+        out.push_back(0);
+        PutVarint(out, run);
+    }
+}
+
+TelemetryRecorder::~TelemetryRecorder()
+{
+    Stop();
+}
+
+bool TelemetryRecorder::Start(const std::string& path, unsigned fields, bool compress, size_t bodies, size_t capacity)
+{
+    Stop();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    this->fields = fields;
+    this->compress = compress;
+    ring = std::make_unique<SpscRingBuffer<TelemetryRecord>>(std::max(capacity, StepsInRing * bodies));
+    recorded = 0;
+    dropped = 0;
+    oversized = 0;
+    const uint32_t header[4] = { 0x4C544850u /* "PHTL" */, 1u, fields, compress ? 1u : 0u };
+    std::fwrite(header, sizeof(header), 1, file);
+    bytesWritten = sizeof(header);
+    stopping = false;
+    writer = std::thread(&TelemetryRecorder::WriterLoop, this);
+    return true;
+}
+
+void TelemetryRecorder::Stop()
+{
+    if (!file) return;
+    stopping = true;
+    if (writer.joinable())
+        writer.join();
+    std::fclose(file);
+    file = nullptr;
+}
+
+void TelemetryRecorder::Record(const World& world)
+{
+    if (!file) return;
+    staging.clear();
+    uint32_t index = 0;
+    for (const auto& bodyPtr : world.bodies)
+    {
+        const Body& body = *bodyPtr;
+        double vx = double(body.velocity.x), vy = double(body.velocity.y), w = double(body.angular_vel);
+        double energy = 0.5 * double(body.mass) * (vx * vx + vy * vy) + 0.5 * double(body.inertia) * w * w;
+        staging.push_back({ world.stepCount, index++, { double(body.position.x), double(body.position.y), vx, vy, energy } });
+    }
+    if (staging.empty()) return;
+    if (staging.size() > ring->Capacity()) {
+        // Would be dropped on every step from now on: say so once instead of only counting
+        if (oversized++ == 0)
+            SDL_Log("Telemetry: a step has %zu records but the ring holds %zu; restart telemetry to record them",
+                staging.size(), ring->Capacity());
+        dropped += staging.size();
+        return;
+    }
+    // All of a step or none of it, so readers never see partial steps
+    if (ring->TryPush(staging.data(), staging.size()))
+        recorded += staging.size();
+    else
+        dropped += staging.size();
+}
+
+void TelemetryRecorder::WriterLoop()
+{
+    std::vector<TelemetryRecord> block(BlockSize);
+    for (;;)
+    {
+        bool finishing = stopping.load(); // read before draining so nothing queued before Stop is lost
+        size_t count = ring->Pop(block.data(), block.size());
+        if (count > 0) {
+            WriteBlock(block.data(), count);
+            continue;
+        }
+        if (finishing) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    std::fflush(file);
+}
+
+void TelemetryRecorder::WriteBlock(const TelemetryRecord* records, size_t count)
+{
+    payload.clear();
+    if (!compress)
+    {
+        for (size_t i = 0; i < count; ++i) PutBytes(payload, &records[i].step, sizeof(uint64_t));
+        for (size_t i = 0; i < count; ++i) PutBytes(payload, &records[i].body, sizeof(uint32_t));
+    }
+    else
+    {
+        uint64_t previousStep = 0;
+        int64_t previousBody = 0;
+        for (size_t i = 0; i < count; ++i) {
+            PutVarint(payload, records[i].step - previousStep);
+            previousStep = records[i].step;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            int64_t delta = (int64_t)records[i].body - previousBody;
+            PutVarint(payload, (uint64_t)((delta << 1) ^ (delta >> 63))); // zigzag
+            previousBody = records[i].body;
+        }
+    }
+
+    // Selected value columns: position (0, 1), velocity (2, 3), energy (4)
+    const unsigned columnField[5] = { Position, Position, Velocity, Velocity, Energy };
+    std::vector<uint64_t>& bits = xorScratch;
+    for (int column = 0; column < 5; ++column)
+    {
+        if (!(fields & columnField[column])) continue;
+        if (!compress) {
+            for (size_t i = 0; i < count; ++i) PutBytes(payload, &records[i].values[column], sizeof(double));
+            continue;
+        }
+        // XOR with the previous value leaves the shared sign, exponent and high mantissa bits zero;
+        // byte planes then group those zeros into long runs
+        bits.resize(count);
+        uint64_t previous = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t current;
+            std::memcpy(&current, &records[i].values[column], sizeof(current));
+            bits[i] = current ^ previous;
+            previous = current;
+        }
+        for (int plane = 7; plane >= 0; --plane)
+            for (size_t i = 0; i < count; ++i)
+                payload.push_back((uint8_t)(bits[i] >> (plane * 8)));
+    }
+
+    const std::vector<uint8_t>* out = &payload;
+    if (compress) {
+        ZeroRunLengthEncode(payload, encoded);
+        out = &encoded;
+    }
+    const uint32_t blockHeader[2] = { (uint32_t)count, (uint32_t)out->size() };
+    std::fwrite(blockHeader, sizeof(blockHeader), 1, file);
+    std::fwrite(out->data(), 1, out->size(), file);
+    bytesWritten += sizeof(blockHeader) + out->size();
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SpscRingBuffer.h"
+
+class World;
+
+/**
+ * @struct TelemetryRecord
+ * @brief One body's state after one step, as queued for the writer thread.
+ */
+struct TelemetryRecord
+{
+    uint64_t step;     ///< World::stepCount after the step
+    uint32_t body;     ///< Index of the body in World::bodies
+    double values[5];  ///< Position X/Y, velocity X/Y, kinetic energy
+};
+
+/**
+ * @class TelemetryRecorder
+ * @brief Streams per-step body state to a columnar binary file from a background thread.
+ *
+ * World::Update calls Record after every step. Record copies the selected bodies into a
+ * lock-free SPSC ring and returns; if the ring is full, the whole step is dropped and
+ * counted rather than blocking the simulation. A writer thread drains the ring in blocks
+ * and writes them to disk. Start sizes the ring for several steps of the world's bodies;
+ * a step that outgrows the whole ring (bodies were added since) can never be queued, so
+ * such steps are counted separately and reported once.
+ *
+ * File layout (little endian):
+ *   header: "PHTL", uint32 version (1), uint32 field mask, uint32 flags (1 = compressed)
+ *   blocks: uint32 record count, uint32 payload bytes, payload
+ *   payload columns: step, body, then the selected value columns in Field order
+ *   raw columns: uint64 steps, uint32 bodies, doubles
+ *   compressed: steps and bodies as zigzag varint deltas, doubles XOR-ed with the previous
+ *   value and split into byte planes, then the whole payload zero-run-length encoded
+ */
+class TelemetryRecorder
+{
+public:
+    static constexpr size_t StepsInRing = 8; ///< Fewest whole steps the ring holds at Start
+
+    /// Value columns that can be recorded
+    enum Field : unsigned
+    {
+        Position = 1, ///< position x and y
+        Velocity = 2, ///< velocity x and y
+        Energy = 4    ///< kinetic energy, linear plus angular
+    };
+
+    ~TelemetryRecorder();
+
+    /**
+     * @brief Open the file and start the writer thread.
+     * @param path Output file
+     * @param fields Bitmask of Field values to write
+     * @param compress Write compressed blocks
+     * @param bodies Bodies in the world now; the ring grows to hold at least StepsInRing steps of them
+     * @param capacity Ring capacity in records
+     * @return False if the file could not be opened
+     */
+    bool Start(const std::string& path, unsigned fields, bool compress, size_t bodies, size_t capacity = 1 << 18);
+
+    /**
+     * @brief Flush everything queued, stop the writer thread and close the file.
+     */
+    void Stop();
+
+    /**
+     * @brief Queue the state of every body after a step (simulation thread only, never blocks).
+     * @param world World that just stepped
+     */
+    void Record(const World& world);
+
+    bool IsRecording() const { return file != nullptr; }
+    unsigned long long Recorded() const { return recorded.load(); } ///< Records queued so far
+    unsigned long long Dropped() const { return dropped.load(); }   ///< Records dropped because the ring was full
+    unsigned long long OversizedSteps() const { return oversized.load(); } ///< Steps dropped because they exceed the whole ring
+    unsigned long long BytesWritten() const { return bytesWritten.load(); } ///< File size so far
+
+private:
+    // Writer thread body: drain, encode, write, repeat.
+    void WriterLoop();
+
+    // Encode and write one block of records.
+    void WriteBlock(const TelemetryRecord* records, size_t count);
+
+    FILE* file = nullptr;
+    unsigned fields = 0;
+    bool compress = false;
+    std::unique_ptr<SpscRingBuffer<TelemetryRecord>> ring;
+    std::thread writer;
+    std::atomic<bool> stopping{ false };
+    std::vector<TelemetryRecord> staging;        ///< Producer-side batch for one step
+    std::vector<uint8_t> payload, encoded;       ///< Writer-side encode buffers
+    std::vector<uint64_t> xorScratch;            ///< Writer-side XOR deltas of one column
+    std::atomic<unsigned long long> recorded{ 0 }, dropped{ 0 }, oversized{ 0 }, bytesWritten{ 0 };
+};
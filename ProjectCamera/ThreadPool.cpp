@@ -0,0 +1,106 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+/**
+ * @brief Create a pool with the given number of worker threads.
+ * @param workerCount Number of workers
+ */
+ThreadPool::ThreadPool(size_t workerCount)
+{
+    for (size_t i = 0; i < workerCount; ++i)
+        workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+/**
+ * @brief Stop and join all workers.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+/**
+ * @brief Process-wide pool sized to the machine.
+ * @return Shared pool
+ */
+ThreadPool& ThreadPool::Shared()
+{
+    static ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()) - 2);
+    return pool;
+}
+
+/**
+ * @brief Run job over [0, count) in parallel and wait for it to finish.
+ *
+ * Small loops, and pools without workers, run inline on the calling thread.
+ * @param count Number of items
+ * @param grain Minimum number of items per chunk
+ * @param job Callable receiving a half-open item range
+ */
+void ThreadPool::ParallelFor(size_t count, size_t grain, const Job& job)
+{
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    if (workers.empty() || count <= grain) {
+        job(0, count);
+        return;
+    }
+    std::lock_guard<std::mutex> dispatch(dispatchMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = &job;
+        jobCount = count;
+        jobSubsystem = AllocationTracker::Current();
+        // Aim for a few chunks per thread so uneven items still balance
+        jobGrain = std::max(grain, count / (GetThreadCount() * 4));
+        nextIndex = 0;
+        pending = workers.size();
+        ++generation;
+    }
+    wake.notify_all();
+    RunChunks();
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending == 0; });
+    current = nullptr;
+}
+
+/**
+ * @brief Worker thread body.
+ */
+void ThreadPool::WorkerLoop()
+{
+    unsigned long long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        {
+            AllocationScope scope(jobSubsystem);
+            RunChunks();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0)
+            done.notify_one();
+    }
+}
+
+/**
+ * @brief Pull chunks of the current loop until none are left.
+ */
+void ThreadPool::RunChunks()
+{
+    for (;;) {
+        size_t begin = nextIndex.fetch_add(jobGrain);
+        if (begin >= jobCount) return;
+        (*current)(begin, std::min(begin + jobGrain, jobCount));
+    }
+}
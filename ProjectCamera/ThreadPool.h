@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "AllocationTracker.h"
+
+/**
+ * @class ThreadPool
+ * @brief Fixed set of worker threads for data-parallel loops.
+ *
+ * ParallelFor splits an index range into chunks that the workers and the calling
+ * thread pull from a shared counter. One loop runs at a time per pool; calling
+ * ParallelFor from inside a job is not supported.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @class Job
+     * @brief Non-owning reference to a callable receiving a half-open item range.
+     *
+     * Unlike std::function it never copies the callable, so starting a loop does not allocate
+     * however much the lambda captures. The callable must outlive the ParallelFor call, which
+     * a lambda written in the argument list or a local variable always does.
+     */
+    class Job
+    {
+    public:
+        template <typename Function>
+        Job(const Function& function)
+            : callable(&function),
+              invoke([](const void* callable, size_t begin, size_t end) { (*static_cast<const Function*>(callable))(begin, end); }) {}
+
+        void operator()(size_t begin, size_t end) const { invoke(callable, begin, end); }
+
+    private:
+        const void* callable;
+        void (*invoke)(const void*, size_t, size_t);
+    };
+
+    /**
+     * @brief Create a pool with the given number of worker threads.
+     * @param workerCount Number of workers (the calling thread also takes part in every loop)
+     */
+    explicit ThreadPool(size_t workerCount);
+
+    /**
+     * @brief Stop and join all workers.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Run job over [0, count) in parallel and wait for it to finish.
+     * @param count Number of items
+     * @param grain Minimum number of items per chunk
+     * @param job Callable receiving a half-open item range
+     */
+    void ParallelFor(size_t count, size_t grain, const Job& job);
+
+    /**
+     * @brief Number of threads that take part in a loop (workers plus caller).
+     * @return Thread count
+     */
+    size_t GetThreadCount() const { return workers.size() + 1; }
+
+    /**
+     * @brief Process-wide pool sized to the machine (one core is left to the render thread).
+     * @return Shared pool
+     */
+    static ThreadPool& Shared();
+
+private:
+    // Worker thread body: wait for a new loop, help run it, report completion.
+    void WorkerLoop();
+
+    // Pull chunks of the current loop until none are left.
+    void RunChunks();
+
+    std::vector<std::thread> workers;
+    std::mutex dispatchMutex;          ///< Serializes ParallelFor calls
+    std::mutex mutex;                  ///< Guards the loop description below
+    std::condition_variable wake;      ///< Signals workers that a loop started
+    std::condition_variable done;      ///< Signals the caller that all workers finished
+    const Job* current = nullptr;      ///< Job of the running loop
+    size_t jobCount = 0;               ///< Item count of the running loop
+    size_t jobGrain = 1;               ///< Chunk size of the running loop
+    std::atomic<size_t> nextIndex{ 0 }; ///< First item of the next unclaimed chunk
+    size_t pending = 0;                ///< Workers that have not finished the running loop
+    AllocationSubsystem jobSubsystem = AllocationSubsystem::Other; ///< Caller's subsystem, charged for the workers' allocations too
+    unsigned long long generation = 0; ///< Incremented for every loop
+    bool stopping = false;             ///< Set on destruction
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class TripleBuffer
+ * @brief Lock-free single-producer/single-consumer triple buffer.
+ * @tparam T Type of the buffered value (reused in place, never reallocated)
+ *
+ * The writer always owns a back buffer and the reader always owns a front buffer.
+ * Publishing swaps the back buffer with the shared middle slot; acquiring swaps the
+ * front buffer with the middle slot only if a newer value was published. Neither
+ * side ever waits for the other.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+    /**
+     * @brief Get the buffer the writer may fill (writer thread only).
+     * @return Reference to the back buffer
+     */
+    T& WriteBuffer() { return buffers[back]; }
+
+    /**
+     * @brief Publish the back buffer to the reader (writer thread only).
+     */
+    void Publish()
+    {
+        uint8_t previous = middle.exchange(static_cast<uint8_t>(back | FreshBit), std::memory_order_acq_rel);
+        back = previous & IndexMask;
+    }
+
+    /**
+     * @brief Get the most recently published buffer (reader thread only).
+     *
+     * Returns the same buffer as the previous call if nothing new was published.
+     * @return Reference to the front buffer
+     */
+    const T& Acquire()
+    {
+        if (middle.load(std::memory_order_relaxed) & FreshBit) {
+            uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+            front = previous & IndexMask;
+        }
+        return buffers[front];
+    }
+
+private:
+    static constexpr uint8_t IndexMask = 0x3;
+    static constexpr uint8_t FreshBit = 0x4;
+
+    T buffers[3];                     ///< Back, middle and front storage
+    uint8_t back = 0;                 ///< Index owned by the writer
+    std::atomic<uint8_t> middle{ 1 }; ///< Shared index plus "fresh" flag
+    uint8_t front = 2;                ///< Index owned by the reader
+};
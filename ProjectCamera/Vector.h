@@ -1,4 +1,5 @@
 #pragma once
+#include "globals.h"
 #include <cmath>
 #include <algorithm>
 #include <iostream> //debug
@@ -221,7 +222,7 @@ void Vector<C>::updatelen()
 {
     sqr_length = 0;
     for (int i = 0; i < size; i++)
-        sqr_length += components[i] * components[i];
+        sqr_length += double(components[i] * components[i]);
     length = sqrt(sqr_length);  // Update length as well
 }
 
@@ -356,4 +357,19 @@ Vector<C> Vector<C>::Zero(int dimension) {
         zeroVec.components[i] = C{};
     zeroVec.updatelen();
     return zeroVec;
-}
\ No newline at end of file
+}
+
+/**
+ * @struct Vec2
+ * @brief Plain two-component vector for per-body state: no dimension field or component array.
+ */
+struct Vec2
+{
+    Real x = 0; ///< X component
+    Real y = 0; ///< Y component
+
+    /**
+     * @brief Set both components.
+     */
+    void set(Real x1, Real y1) { x = x1; y = y1; }
+};
@@ -4,58 +4,344 @@
 #include <initializer_list>
 #include <SDL3/SDL.h>
 #include "World.h"
+#include "AllocationTracker.h"
 #include "Vector.h"  // for Zero()
 #include "Shape.h"
 
-// Update all bodies in the world for the given time step.
+// Apply force passes, then update all bodies in the world for the given time step.
 void World::Update(double deltaTime)
 {
+    AllocationScope allocationScope(AllocationSubsystem::World); // Strict builds expect none once settled
+    spatialIndexValid = false; // Bodies are about to move
+    GatherBatch();
+    bool hasJoints = !joints.GetJoints().empty();
+    if (!substepper.enabled) {
+        AdvanceBatch(batch, batchBodies, deltaTime, hasJoints, nullptr);
+    } else {
+        substepper.Plan(batch, batchBodies, version, joints.GetJoints(), (bool)batch.field, (Real)deltaTime);
+        const auto& levels = substepper.GetLevels();
+        for (const IslandSubstepper::Level* level : levels)
+        {
+            double substep = deltaTime / level->substeps;
+            bool single = levels.size() == 1; // Everything at one rate: step the whole batch in place
+            BodyBatch& stepBatch = single ? batch : levelBatch;
+            const std::vector<Body*>& owners = single ? batchBodies : levelBodies;
+            if (!single)
+                CopyBatch(batch, level->bodies, levelBatch, levelBodies);
+            for (int s = 0; s < level->substeps; ++s)
+                AdvanceBatch(stepBatch, owners, substep, level->hasJoints, single ? nullptr : &level->jointActive);
+        }
+    }
+    if (broadPhase.enabled || contacts.enabled)
+        broadPhase.Update(bodies, version); // Insertion sort from last step's order
+    if (contacts.enabled)
+        contacts.Update(bodies, version, staticBodies, staticVersion, GetStaticIndex(), broadPhase, threadPool); // Before scenarios, which may wait on contacts
+    particles.Update((float)deltaTime, threadPool); // Integrate point particles
+    softBodies.Update((float)deltaTime, threadPool); // Springs, in as many substeps as the stiffest needs
+    fluid.Update((float)deltaTime, bodies, staticBodies, threadPool); // Pushes dynamic bodies by changing their velocity
+    ++stepCount;
+    time += deltaTime;
+    if (telemetry)
+        telemetry->Record(*this); // Copies into a ring buffer, never waits on disk
+    scenarios.Advance(*this); // Scripts see the finished step and may change the world for the next
+}
+
+// Copy the state and per-step forces of all moving bodies into the integration batch.
+void World::GatherBatch()
+{
+    size_t n = bodies.size();
+    batchBodies.clear();
+    batch.Resize(n);
+    size_t i = 0;
     for (auto& bodyPtr : bodies)
     {
-        bodyPtr->Update(deltaTime); // Update physics for each body
-        bodyPtr->force = Vector<double>::Zero(2); // Reset force after update
-        bodyPtr->torque = 0; // Reset torque after update
+        Body* body = bodyPtr.get();
+        batchBodies.push_back(body);
+        batch.x[i] = body->position.x; batch.y[i] = body->position.y;
+        batch.vx[i] = body->velocity.x; batch.vy[i] = body->velocity.y;
+        batch.angle[i] = body->rotation; batch.spin[i] = body->angular_vel;
+        batch.mass[i] = body->mass;
+        if (body->IsDynamic())
+        {
+            // Kinematic bodies keep zeros everywhere: they coast at their scripted velocity
+            Real inverseMass = body->mass > 0 ? 1 / body->mass : 0;
+            Real inverseInertia = body->inertia > 0 ? 1 / body->inertia : 0;
+            batch.baseAx[i] = body->force.x * inverseMass + body->gravity.x;
+            batch.baseAy[i] = body->force.y * inverseMass + body->gravity.y;
+            batch.baseAlpha[i] = body->torque * inverseInertia;
+            batch.dragX[i] = body->liniar_drag.x * inverseMass;
+            batch.dragY[i] = body->liniar_drag.y * inverseMass;
+            batch.angularDrag[i] = body->angular_drag * inverseInertia;
+            batch.fieldScale[i] = 1;
+        }
+        else
+        {
+            batch.baseAx[i] = batch.baseAy[i] = batch.baseAlpha[i] = 0;
+            batch.dragX[i] = batch.dragY[i] = batch.angularDrag[i] = 0;
+            batch.fieldScale[i] = 0;
+        }
+        ++i;
+    }
+    if (mutualGravity.enabled && n >= 2)
+        batch.field = [this](const Real* x, const Real* y, const Real* m, size_t count, Real* ax, Real* ay) {
+            mutualGravity.Evaluate(x, y, m, count, ax, ay, threadPool);
+        };
+    else
+        batch.field = nullptr;
+}
+
+// Copy the selected slots of a batch (and their bodies) into another batch.
+void World::CopyBatch(const BodyBatch& source, const std::vector<uint32_t>& slots, BodyBatch& target, std::vector<Body*>& owners)
+{
+    target.Resize(slots.size());
+    owners.resize(slots.size());
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        uint32_t k = slots[i];
+        owners[i] = batchBodies[k];
+        target.x[i] = source.x[k]; target.y[i] = source.y[k];
+        target.vx[i] = source.vx[k]; target.vy[i] = source.vy[k];
+        target.angle[i] = source.angle[k]; target.spin[i] = source.spin[k];
+        target.mass[i] = source.mass[k];
+        target.baseAx[i] = source.baseAx[k]; target.baseAy[i] = source.baseAy[k]; target.baseAlpha[i] = source.baseAlpha[k];
+        target.dragX[i] = source.dragX[k]; target.dragY[i] = source.dragY[k]; target.angularDrag[i] = source.angularDrag[k];
+        target.fieldScale[i] = source.fieldScale[k];
+    }
+    target.field = nullptr; // Levels are only split when no field couples the bodies
+}
+
+// Integrate a batch by one (sub)step, apply the given joints and write the state back to its bodies.
+void World::AdvanceBatch(BodyBatch& stepBatch, const std::vector<Body*>& owners, double deltaTime,
+    bool solveJoints, const std::vector<uint8_t>* jointActive)
+{
+    integrator->Step(stepBatch, (Real)deltaTime); // Forces to velocities to positions, gravity re-evaluated per stage
+
+    // Joints see the positions at the start of the step, as they would between velocity and position
+    // integration. Their impulses change velocities the integrator already used, so each body is
+    // also moved by its velocity change over the step (exact for symplectic Euler).
+    if (solveJoints)
+    {
+        for (size_t i = 0; i < owners.size(); ++i)
+        {
+            Body* body = owners[i];
+            body->velocity.x = stepBatch.vx[i]; body->velocity.y = stepBatch.vy[i];
+            body->angular_vel = stepBatch.spin[i];
+        }
+        joints.Solve(deltaTime, threadPool, jointActive);
+    }
+    for (size_t i = 0; i < owners.size(); ++i)
+    {
+        Body* body = owners[i];
+        if (!solveJoints)
+        {
+            body->velocity.x = stepBatch.vx[i]; body->velocity.y = stepBatch.vy[i];
+            body->angular_vel = stepBatch.spin[i];
+        }
+        else if (body->IsDynamic())
+        {
+            stepBatch.x[i] += (body->velocity.x - stepBatch.vx[i]) * deltaTime;
+            stepBatch.y[i] += (body->velocity.y - stepBatch.vy[i]) * deltaTime;
+            stepBatch.angle[i] += (body->angular_vel - stepBatch.spin[i]) * deltaTime;
+            stepBatch.vx[i] = body->velocity.x; stepBatch.vy[i] = body->velocity.y; // Next substep starts here
+            stepBatch.spin[i] = body->angular_vel;
+        }
+        body->position.x = stepBatch.x[i]; body->position.y = stepBatch.y[i];
+        body->rotation = stepBatch.angle[i];
+        body->force = Vec2(); // Already folded into the batch; reset for the next step
+        body->torque = 0;
     }
 }
 
 // Render all bodies in the world using the given SDL renderer.
 void World::Render(SDL_Renderer* renderer)
 {
+    for (auto& bodyPtr : staticBodies)
+        bodyPtr->Render(renderer); // Level geometry first, underneath
     for (auto& bodyPtr : bodies)
     {
         bodyPtr->Render(renderer); // Render each body
     }
+    // All particles in a single batched submission
+    std::vector<SDL_FPoint>& points = renderPoints;
+    particles.CopyPoints(points);
+    SDL_SetRenderDrawColor(renderer, 120, 180, 255, 255);
+    SDL_RenderPoints(renderer, points.data(), (int)points.size());
+    fluid.CopyPoints(points);
+    SDL_SetRenderDrawColor(renderer, 60, 120, 255, 255);
+    SDL_RenderPoints(renderer, points.data(), (int)points.size());
+    // Soft bodies as the outline of their points
+    std::vector<uint32_t>& counts = renderCounts;
+    softBodies.CopyOutlines(points, counts);
+    SDL_SetRenderDrawColor(renderer, 120, 255, 140, 255);
+    for (size_t i = 0, first = 0; i < counts.size(); first += counts[i++])
+        SDL_RenderLines(renderer, points.data() + first, (int)counts[i]);
+}
+
+// Create a shapeless body of the given type in this world's arena and return it for setup.
+Body* World::CreateBody(BodyType type, double positionX, double positionY, double velocityX, double velocityY)
+{
+    if (type == BodyType::Static)
+        velocityX = velocityY = 0;
+    std::unique_ptr<Body> bodyPtr(new (&arena) Body(positionX, positionY, velocityX, velocityY, 0.1)); // 0.1 is kept only for shapes without area
+    bodyPtr->type = type;
+    Body* body = bodyPtr.get();
+    if (type == BodyType::Static) {
+        staticBodies.push_back(std::move(bodyPtr));
+        ++staticVersion;
+    } else {
+        bodies.push_back(std::move(bodyPtr));
+        ++version;
+        spatialIndexValid = false;
+    }
+    return body;
 }
 
-// Add a new body to the world with position, velocity, force, and shape.
+// Add a new body to the world with position, velocity, force, and shape; mass and inertia follow from the shape.
 void World::AddBody(double positionX, double positionY, double velocityX,
-    double velocityY, double initialForceX, double initialForceY, Shape* shp)
+    double velocityY, double initialForceX, double initialForceY, Shape* shp, double density)
+{
+    Body* body = CreateBody(BodyType::Dynamic, positionX, positionY, velocityX, velocityY);
+    body->force.set(initialForceX, initialForceY);
+    body->AttachShape(*std::unique_ptr<Shape>(shp), density); // Flatten the shape, deriving mass and inertia
+}
+
+// Add a body moved only by its velocity (set by scripts); it has infinite mass for joints.
+void World::AddKinematicBody(double positionX, double positionY, double velocityX, double velocityY, Shape* shp)
 {
-    Vector<double> pos(2);
-    pos.set(positionX, positionY);
-    Vector<double> vel(2);
-    vel.set(velocityX, velocityY);
-    Vector<double> force(2);
-    force.set(initialForceX, initialForceY);
+    CreateBody(BodyType::Kinematic, positionX, positionY, velocityX, velocityY)->AttachShape(*std::unique_ptr<Shape>(shp), DefaultDensity);
+}
+
+// Add a body that never moves. It is kept apart from bodies, so it costs nothing per step.
+void World::AddStaticBody(double positionX, double positionY, Shape* shp)
+{
+    CreateBody(BodyType::Static, positionX, positionY, 0, 0)->AttachShape(*std::unique_ptr<Shape>(shp), DefaultDensity);
+}
 
-    auto bodyPtr = std::make_unique<Body>(pos, vel, 0.1, force); // Create new body
-    bodyPtr->shapes.push_back(std::unique_ptr<Shape>(shp)); // Attach shape to body
-    bodies.push_back(std::move(bodyPtr)); // Add body to world
+// Get a body by its index in the list, or nullptr if out of range.
+Body* World::GetBody(size_t index)
+{
+    if (index >= bodies.size()) return nullptr;
+    auto it = bodies.begin();
+    std::advance(it, index);
+    return it->get();
 }
 
-// Remove a body from the world by its index in the list.
+// Remove a body (and any joints attached to it) from the world by its index in the list.
 void World::RemoveBody(size_t index)
 {
     if (index < bodies.size())
     {
         auto it = bodies.begin();
         std::advance(it, index);
+        joints.RemoveBody(it->get());
+        scenarios.ForgetBody(it->get());
+        contacts.ForgetBody(it->get());
         bodies.erase(it); // Remove body at the given index
+        ++version;
+        spatialIndexValid = false;
     }
 }
 
-// Remove all bodies from the world.
+// Remove a static body (and any joints attached to it) by its index in staticBodies.
+void World::RemoveStaticBody(size_t index)
+{
+    if (index < staticBodies.size())
+    {
+        auto it = staticBodies.begin();
+        std::advance(it, index);
+        joints.RemoveBody(it->get());
+        scenarios.ForgetBody(it->get());
+        contacts.ForgetBody(it->get());
+        staticBodies.erase(it);
+        ++staticVersion;
+    }
+}
+
+// Remove all bodies, static bodies and joints from the world.
 void World::ClearBodies()
 {
+    joints.Clear();
+    scenarios.ForgetBody(nullptr);
+    contacts.ForgetBody(nullptr);
     bodies.clear();
+    staticBodies.clear();
+    ++version;
+    ++staticVersion;
+    spatialIndexValid = false;
+}
+
+// Rebuild the spatial index if bodies moved since it was built.
+const SpatialIndex& World::GetSpatialIndex()
+{
+    if (!spatialIndexValid)
+    {
+        spatialIndex.Build(bodies);
+        spatialIndexValid = true;
+    }
+    return spatialIndex;
+}
+
+// Rebuild the static index if static bodies were added or removed.
+const SpatialIndex& World::GetStaticIndex()
+{
+    if (staticIndexVersion != staticVersion)
+    {
+        staticIndex.Build(staticBodies);
+        staticIndexVersion = staticVersion;
+    }
+    return staticIndex;
+}
+
+// Find bodies overlapping an axis-aligned region.
+void World::QueryRegion(double minX, double minY, double maxX, double maxY, std::vector<size_t>& output)
+{
+    GetSpatialIndex().QueryRegion(minX, minY, maxX, maxY, output);
+}
+
+// Find bodies overlapping a circle.
+void World::QueryRadius(double x, double y, double radius, std::vector<size_t>& output)
+{
+    GetSpatialIndex().QueryRadius(x, y, radius, output);
+}
+
+// Find static bodies overlapping an axis-aligned region.
+void World::QueryStaticRegion(double minX, double minY, double maxX, double maxY, std::vector<size_t>& output)
+{
+    GetStaticIndex().QueryRegion(minX, minY, maxX, maxY, output);
+}
+
+// Find static bodies overlapping a circle.
+void World::QueryStaticRadius(double x, double y, double radius, std::vector<size_t>& output)
+{
+    GetStaticIndex().QueryRadius(x, y, radius, output);
+}
+
+// Cast a batch of rays in parallel; the indices are built once up front and only read by the workers.
+void World::Raycast(const RayQuery* rays, RayHit* hits, size_t count)
+{
+    const SpatialIndex& index = GetSpatialIndex();
+    const SpatialIndex& fixed = GetStaticIndex();
+    bool anyStatic = !staticBodies.empty();
+    auto castRange = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            hits[i] = index.Raycast(rays[i]);
+            if (!anyStatic) continue;
+            RayQuery clipped = rays[i];
+            if (hits[i].hit) clipped.maxDistance = hits[i].distance; // only closer static hits matter
+            RayHit staticHit = fixed.Raycast(clipped);
+            if (staticHit.hit && (!hits[i].hit || staticHit.distance < hits[i].distance)) {
+                hits[i] = staticHit;
+                hits[i].staticBody = true;
+            }
+        }
+    };
+    if (threadPool) threadPool->ParallelFor(count, 256, castRange);
+    else castRange(0, count);
+}
+
+// Find the body under a point.
+bool World::PickBody(double x, double y, size_t& index)
+{
+    return GetSpatialIndex().Pick(x, y, index);
 }
\ No newline at end of file
@@ -3,29 +3,169 @@
 #pragma once
 #include <list>
 #include <memory>
+#include <memory_resource>
 #include "Body.h"
+#include "ContactStream.h"
 #include "Shape.h"
+#include "FluidSystem.h"
+#include "GravitySolver.h"
+#include "Integrator.h"
+#include "IslandSubstepper.h"
+#include "JointSolver.h"
+#include "ParticleSystem.h"
+#include "Scenario.h"
+#include "SoftBodySystem.h"
+#include "SpatialIndex.h"
+#include "SweepAndPrune.h"
+#include "Telemetry.h"
+#include "ThreadPool.h"
 
 // The World class manages all physics bodies and simulation logic.
 class World
 {
+    // Per-world arena every Body is allocated from. Declared first so it outlives them;
+    // not synchronized, since a world is only ever touched by one thread at a time.
+    std::pmr::unsynchronized_pool_resource arena;
+
 public:
     // List of all bodies in the world. Each body is owned by a unique_ptr.
     std::list<std::unique_ptr<Body>> bodies;
 
-    // Update all bodies in the world for the given time step.
+    // Static bodies: never integrated, never in the per-step passes, indexed once when they change.
+    std::list<std::unique_ptr<Body>> staticBodies;
+
+    // Bumped whenever bodies are added or removed, so observers can cache per-body data.
+    unsigned long long version = 0;
+
+    // Bumped whenever static bodies are added or removed.
+    unsigned long long staticVersion = 0;
+
+    // Number of completed Update calls.
+    unsigned long long stepCount = 0;
+
+    // Simulated seconds of all completed Update calls.
+    double time = 0.0;
+
+    // Optional per-step telemetry stream, fed at the end of every Update.
+    std::unique_ptr<TelemetryRecorder> telemetry;
+
+    // Barnes-Hut mutual gravity between bodies (off by default).
+    GravitySolver mutualGravity;
+
+    // Joints between bodies, solved between velocity and position integration.
+    JointSolver joints;
+
+    // Shape-less point particles integrated alongside the rigid bodies.
+    ParticleSystem particles;
+
+    // Mass-spring lattices, deformable bodies integrated alongside the rigid ones.
+    SoftBodySystem softBodies;
+
+    // SPH liquid in a box, pushed by the bodies and pushing the dynamic ones back.
+    FluidSystem fluid;
+
+    // Incremental overlap pairs of body AABBs, refreshed after integration (off by default).
+    SweepAndPrune broadPhase;
+
+    // Begin/persist/end events of touching bodies, from the broad-phase pairs after each step (off by default).
+    ContactStream contacts;
+
+    // Per-island substep counts from body speed and size, so fast islands step finer (off by default).
+    IslandSubstepper substepper;
+
+    // Scripted scenarios, resumed at the end of the steps they wait for.
+    ScenarioScheduler scenarios;
+
+    // Pool used for parallel force passes; nullptr runs them on the calling thread.
+    ThreadPool* threadPool = &ThreadPool::Shared();
+
+    // Apply force passes, then update all bodies in the world for the given time step.
     void Update(double deltaTime);
 
+    // Choose the scheme that advances bodies in Update (symplectic Euler by default).
+    void SetIntegrator(IntegratorType type) { integrator = Integrator::Create(type); }
+
+    // Scheme currently used by Update.
+    IntegratorType GetIntegratorType() const { return integrator->Type(); }
+
     // Render all bodies in the world using the given SDL renderer.
     void Render(SDL_Renderer* renderer);
 
-    // Add a new body to the world with position, velocity, force, and shape.
+    // Mass per unit area of shapes added without an explicit density.
+    static constexpr double DefaultDensity = 0.001;
+
+    // Create a shapeless body of the given type in this world's arena and return it for setup (attach shapes next).
+    Body* CreateBody(BodyType type, double positionX, double positionY, double velocityX, double velocityY);
+
+    // Add a new body to the world with position, velocity, force, and shape; mass and inertia follow from the shape.
     void AddBody(double positionX, double positionY, double velocityX,
-        double velocityY, double initialForceX, double initialForceY, Shape* shp);
+        double velocityY, double initialForceX, double initialForceY, Shape* shp, double density = DefaultDensity);
+
+    // Add a body moved only by its velocity (set by scripts); it has infinite mass for joints.
+    void AddKinematicBody(double positionX, double positionY, double velocityX, double velocityY, Shape* shp);
+
+    // Add a body that never moves. It is kept apart from bodies, so it costs nothing per step.
+    void AddStaticBody(double positionX, double positionY, Shape* shp);
+
+    // Get a body by its index in the list, or nullptr if out of range.
+    Body* GetBody(size_t index);
 
-    // Remove a body from the world by its index in the list.
+    // Remove a body (and any joints attached to it) from the world by its index in the list.
     void RemoveBody(size_t index);
 
-    // Remove all bodies from the world.
+    // Remove a static body (and any joints attached to it) by its index in staticBodies.
+    void RemoveStaticBody(size_t index);
+
+    // Remove all bodies, static bodies and joints from the world.
     void ClearBodies();
+
+    // Find bodies overlapping an axis-aligned region (indices into bodies are appended to output).
+    void QueryRegion(double minX, double minY, double maxX, double maxY, std::vector<size_t>& output);
+
+    // Find bodies overlapping a circle (indices into bodies are appended to output).
+    void QueryRadius(double x, double y, double radius, std::vector<size_t>& output);
+
+    // Find static bodies overlapping an axis-aligned region (indices into staticBodies are appended to output).
+    void QueryStaticRegion(double minX, double minY, double maxX, double maxY, std::vector<size_t>& output);
+
+    // Find static bodies overlapping a circle (indices into staticBodies are appended to output).
+    void QueryStaticRadius(double x, double y, double radius, std::vector<size_t>& output);
+
+    // Cast a batch of rays against bodies and static bodies, writing the closest hit of each; runs in parallel on threadPool.
+    void Raycast(const RayQuery* rays, RayHit* hits, size_t count);
+
+    // Find the body under a point. Returns false if there is none.
+    bool PickBody(double x, double y, size_t& index);
+
+    // Mark the spatial index stale after moving bodies outside of Update.
+    void InvalidateSpatialIndex() { spatialIndexValid = false; }
+
+private:
+    // Copy the state and per-step forces of all moving bodies into the integration batch.
+    void GatherBatch();
+
+    // Copy the selected slots of a batch (and their bodies) into another batch.
+    void CopyBatch(const BodyBatch& source, const std::vector<uint32_t>& slots, BodyBatch& target, std::vector<Body*>& owners);
+
+    // Integrate a batch by one (sub)step, apply the given joints and write the state back to its bodies.
+    void AdvanceBatch(BodyBatch& stepBatch, const std::vector<Body*>& owners, double deltaTime,
+        bool solveJoints, const std::vector<uint8_t>* jointActive);
+
+    // Rebuild the spatial index if bodies moved since it was built.
+    const SpatialIndex& GetSpatialIndex();
+
+    // Rebuild the static index if static bodies were added or removed.
+    const SpatialIndex& GetStaticIndex();
+
+    SpatialIndex spatialIndex;       // Acceleration structure for the queries above
+    bool spatialIndexValid = false;  // False after any step or structural change
+    SpatialIndex staticIndex;        // Same over staticBodies; steps never touch it
+    unsigned long long staticIndexVersion = ~0ull; // staticVersion the static index was built for
+    std::unique_ptr<Integrator> integrator = Integrator::Create(IntegratorType::SymplecticEuler);
+    BodyBatch batch;                 // Structure-of-arrays copy of bodies for the integrator
+    std::vector<Body*> batchBodies;  // Body of each batch slot, in list order
+    BodyBatch levelBatch;            // Bodies of one substep level, copied out of batch
+    std::vector<Body*> levelBodies;  // Body of each levelBatch slot
+    std::vector<SDL_FPoint> renderPoints; // Point scratch for Render, reused across frames
+    std::vector<uint32_t> renderCounts;   // Soft body outline lengths within renderPoints
 };
@@ -1,3 +1,24 @@
 #pragma once
 const double PI = 3.14159265358979323846;
+
+// Scalar type of body state, shapes and solver arrays. Define PHYSICS_SINGLE_PRECISION in the
+// preprocessor definitions to build the engine in float (twice the SIMD lanes, half the bandwidth).
+// PHYSICS_FIXED_POINT builds it on the Q32.32 Fixed type instead, for bit-identical results on any CPU and compiler.
+#if defined(PHYSICS_FIXED_POINT)
+#include "Fixed.h"
+typedef Fixed Real;
+constexpr const char* RealName = "fixed";
+#elif defined(PHYSICS_SINGLE_PRECISION)
+typedef float Real;
+constexpr const char* RealName = "float";
+#else
+typedef double Real;
+constexpr const char* RealName = "double";
+#endif
+
+// Math on Real is called unqualified (sqrt(x), not std::sqrt(x)) so Fixed finds its own overloads by
+// argument-dependent lookup; these declarations bring in the float and double ones.
+#include <cmath>
+using std::sqrt; using std::sin; using std::cos; using std::atan2; using std::hypot;
+using std::fabs; using std::abs; using std::floor; using std::ceil;
 #pragma warning(disable : 4244)
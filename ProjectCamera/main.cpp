@@ -3,33 +3,58 @@
  * @brief Entry point for the Physics Renderer application.
  *
  * Initializes SDL, creates the main window and renderer, sets up the world and debugger,
- * and runs the main event loop for simulation and rendering.
+ * and runs the main event loop for rendering. The simulation steps on its own thread.
  */
 #include <SDL3/SDL.h>
 #include <SDL3_ttf/SDL_ttf.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include "Body.h"
 #include "World.h"
 #include "Shape.h"
 #include "Vector.h"
 #include "Circle.h"
+#include "AllocationTracker.h"
 #include "Debugger.h"
 #include "Properties.h"
+#include "Simulation.h"
+#include "Benchmarks.h"
+#include "ControlServer.h"
+#include "BatchRunner.h"
+#include "FrameCapture.h"
+#include "SceneFile.h"
 
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 800
 
-// Global SDL objects and font
-SDL_Window* window = nullptr;         // Main application window
-SDL_Renderer* renderer = nullptr;     // SDL renderer
-TTF_Font* gFont = nullptr;            // Global font
-SDL_Window* gWindow = nullptr;        // Global window pointer for debugger
+// Parse a non-negative decimal count; false for anything else (signs, junk, out of range).
+static bool ParseCount(const char* text, unsigned long long& value)
+{
+    if (*text < '0' || *text > '9') return false;
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtoull(text, &end, 10);
+    return *end == '\0' && errno == 0;
+}
 
 /**
  * @brief Main function for the Physics Renderer application.
  *
  * Initializes SDL and SDL_ttf, creates the main window and renderer, sets up the world and debugger,
- * and runs the main event loop for simulation and rendering.
+ * starts the simulation thread and runs the main event loop, rendering the latest published snapshot.
+ *
+ * Passing --bench <name> [count] runs a headless benchmark instead and exits.
+ * Passing --batch <sweep file> <summary file> [threads] runs a headless parameter sweep and exits.
+ * Passing --capture <directory> <frames> [raw|png] [script] renders offscreen without a window,
+ * after running the Debugger commands in the script file, and writes frames until the count is reached.
+ * Passing --scene <file> loads a scene file into the world before the simulation starts.
+ * Passing --control <socket path> also accepts Debugger commands over a Unix domain socket.
+ * Passing --record <directory> [raw|png] also writes every displayed frame (dropping frames if the disk falls behind).
+ * Passing --strict-allocations turns on the allocation tracker's strict mode: benchmarks fail, and the
+ * overlay warns, when World::Update allocates in steady state (needs a PHYSICS_TRACK_ALLOCATIONS build).
  *
  * @param argc Number of command-line arguments.
  * @param argv Array of command-line arguments.
@@ -37,6 +62,112 @@ SDL_Window* gWindow = nullptr;        // Global window pointer for debugger
  */
 int main(int argc, char* argv[])
 {
+    for (int i = 1; i < argc; ++i)
+        if (std::string(argv[i]) == "--strict-allocations")
+            AllocationTracker::SetStrict(true);
+
+    // Headless benchmark mode
+    if (argc >= 3 && std::string(argv[1]) == "--bench") {
+        std::vector<std::string> report;
+        unsigned long long count = 0;
+        bool flag = argc >= 4 && argv[3][0] == '-' && argv[3][1] == '-'; // --strict-allocations, no count
+        if (argc >= 4 && !flag && !ParseCount(argv[3], count)) {
+            std::cerr << "Usage: --bench <name> [count] [--strict-allocations] (count is a non-negative integer)" << std::endl;
+            return 1;
+        }
+        bool known = RunBenchmark(argv[2], (size_t)count, report);
+        for (const auto& line : report)
+            std::cout << line << '\n';
+        return known ? 0 : 1;
+    }
+
+    // Headless parameter sweep: many independent worlds, one summary file
+    if (argc >= 4 && std::string(argv[1]) == "--batch") {
+        BatchRunner batch;
+        std::string error;
+        if (!batch.LoadSweep(argv[2], error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        unsigned long long threads = 0;
+        if (argc >= 5 && !ParseCount(argv[4], threads)) {
+            std::cerr << "Usage: --batch <sweep file> <summary file> [threads] (threads is a non-negative integer)" << std::endl;
+            return 1;
+        }
+        double ms = batch.Run((size_t)threads);
+        if (!batch.WriteSummary(argv[3])) {
+            std::cerr << "cannot write " << argv[3] << std::endl;
+            return 1;
+        }
+        std::cout << "batch: " << batch.GetRuns().size() << " runs in " << ms << " ms ("
+                  << batch.GetRuns().size() * 1000.0 / std::max(ms, 1e-3) << " runs/s)" << std::endl;
+        return 0;
+    }
+
+    // Headless capture: software renderer into a surface, every published step becomes a frame
+    if (argc >= 4 && std::string(argv[1]) == "--capture") {
+        std::string directory = argv[2];
+        unsigned long long frameCount = 0;
+        if (!ParseCount(argv[3], frameCount)) {
+            std::cerr << "Usage: --capture <directory> <frames> [raw|png] [script] (frames is a non-negative integer)" << std::endl;
+            return 1;
+        }
+        FrameCapture::Format format = argc >= 5 && std::string(argv[4]) == "png"
+            ? FrameCapture::Format::Png : FrameCapture::Format::Raw;
+        SDL_Surface* surface = SDL_CreateSurface(WINDOW_WIDTH, WINDOW_HEIGHT, SDL_PIXELFORMAT_RGBA32);
+        SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+        if (!renderer) {
+            SDL_Log("Couldn't create software renderer: %s", SDL_GetError());
+            SDL_DestroySurface(surface);
+            return 1;
+        }
+
+        World world;
+        Simulation simulation(world);
+        if (argc >= 6) {
+            std::ifstream script(argv[5]);
+            for (std::string line; std::getline(script, line); )
+                simulation.Post([line](World& world) {
+                    std::vector<std::string> output;
+                    Debugger::ExecuteCommand(world, line, output);
+                });
+        }
+
+        FrameCapture capture;
+        if (!capture.Start(renderer, WINDOW_WIDTH, WINDOW_HEIGHT, directory, format, true)) {
+            std::cerr << "cannot capture to " << directory << std::endl;
+            SDL_DestroyRenderer(renderer);
+            SDL_DestroySurface(surface);
+            return 1;
+        }
+        simulation.Start();
+        unsigned long long lastStep = ~0ull;
+        for (unsigned long long frame = 0; frame < frameCount; ) {
+            const RenderSnapshot& snapshot = simulation.AcquireSnapshot();
+            if (snapshot.step == lastStep) {
+                SDL_Delay(1); // Nothing new published yet
+                continue;
+            }
+            lastStep = snapshot.step;
+            capture.BeginFrame();
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
+            {
+                AllocationScope scope(AllocationSubsystem::Render);
+                snapshot.Render(renderer);
+            }
+            capture.EndFrame(false);
+            ++frame;
+        }
+        simulation.Stop();
+        capture.Stop();
+        std::cout << "capture: " << capture.Written() << " frames written, " << capture.Dropped()
+                  << " dropped, last step " << lastStep << std::endl;
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroySurface(surface);
+        return 0;
+    }
+
     // Initialize SDL
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
@@ -51,8 +182,8 @@ int main(int argc, char* argv[])
     }
 
     // Load font (change path as needed)
-    gFont = TTF_OpenFont("C:/Windows/Fonts/arial.ttf", 16);
-    if (!gFont) {
+    TTF_Font* font = TTF_OpenFont("C:/Windows/Fonts/arial.ttf", 16);
+    if (!font) {
         SDL_Log("Couldn't load font");
         TTF_Quit();
         SDL_Quit();
@@ -60,28 +191,28 @@ int main(int argc, char* argv[])
     }
 
     // Create window
-    window = SDL_CreateWindow("Physics Renderer", WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_RESIZABLE);
-    gWindow = window; // Assign to global pointer for debugger
+    SDL_Window* window = SDL_CreateWindow("Physics Renderer", WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_RESIZABLE);
     if (!window) {
         SDL_Log("Couldn't create window: %s", SDL_GetError());
-        TTF_CloseFont(gFont);
+        TTF_CloseFont(font);
         TTF_Quit();
         return SDL_APP_FAILURE;
     }
 
     // Create renderer
-    renderer = SDL_CreateRenderer(window, nullptr);
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, nullptr);
     if (!renderer) {
         SDL_Log("Couldn't create renderer: %s", SDL_GetError());
         SDL_DestroyWindow(window);
-        TTF_CloseFont(gFont);
+        TTF_CloseFont(font);
         TTF_Quit();
         return SDL_APP_FAILURE;
     }
 
-    // Create world, debugger and properties window
+    // Create world, simulation, debugger and properties window
     World world;
-    Debugger debugger(&world);
+    Simulation simulation(world);
+    Debugger debugger(&simulation, renderer, window, font);
 
     // Use the factory method to create an instance of Properties
     Properties* propertiesWindow = Properties::CreateInstance();
@@ -89,19 +220,52 @@ int main(int argc, char* argv[])
         debugger.SetPropertiesWindow(propertiesWindow);
         // Use floating point math for correct placement
         propertiesWindow->Init({
-            []{ Vector<double> v(2); v.set((2.0/3.0)*WINDOW_WIDTH, (1.0/3.0)*WINDOW_HEIGHT); return v; }(),
-            []{ Vector<double> v(2); v.set((2.0/3.0)*WINDOW_WIDTH, (2.0 / 3.0)*WINDOW_HEIGHT); return v; }(),
-            []{ Vector<double> v(2); v.set(WINDOW_WIDTH, (2.0 / 3.0)*WINDOW_HEIGHT); return v; }(),
-            []{ Vector<double> v(2); v.set(WINDOW_WIDTH, (1.0/3.0)*WINDOW_HEIGHT); return v; }()
+            []{ Vector<Real> v(2); v.set((2.0/3.0)*WINDOW_WIDTH, (1.0/3.0)*WINDOW_HEIGHT); return v; }(),
+            []{ Vector<Real> v(2); v.set((2.0/3.0)*WINDOW_WIDTH, (2.0 / 3.0)*WINDOW_HEIGHT); return v; }(),
+            []{ Vector<Real> v(2); v.set(WINDOW_WIDTH, (2.0 / 3.0)*WINDOW_HEIGHT); return v; }(),
+            []{ Vector<Real> v(2); v.set(WINDOW_WIDTH, (1.0/3.0)*WINDOW_HEIGHT); return v; }()
 			});
     }
     // Add a circle object to the world
     //world.AddBody(WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2, 0, 0, 5, 0, new Circle(50));
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--scene") {
+            std::string error;
+            if (!SceneFile::Load(world, argv[i + 1], error, world.threadPool))
+                SDL_Log("Couldn't load scene: %s", error.c_str());
+        }
+    }
 
     bool running = true;
     SDL_Event event;
-    int lastTime = SDL_GetTicks();
-    double deltaTime = 0.0;
+
+    // Start stepping the world at a fixed rate on its own thread
+    simulation.Start();
+
+    // Optional local control socket for orchestration scripts
+    ControlServer controlServer;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--control") {
+            std::string error;
+            if (controlServer.Start(argv[i + 1], simulation, error))
+                std::cout << "Control server listening on " << argv[i + 1] << std::endl;
+            else
+                SDL_Log("Couldn't start control server on %s: %s", argv[i + 1], error.c_str());
+        }
+    }
+
+    // Optional recording of the displayed frames
+    FrameCapture recorder;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--record") {
+            FrameCapture::Format format = i + 2 < argc && std::string(argv[i + 2]) == "png"
+                ? FrameCapture::Format::Png : FrameCapture::Format::Raw;
+            int width = WINDOW_WIDTH, height = WINDOW_HEIGHT;
+            SDL_GetRenderOutputSize(renderer, &width, &height);
+            if (!recorder.Start(renderer, width, height, argv[i + 1], format))
+                SDL_Log("Couldn't start recording to %s", argv[i + 1]);
+        }
+    }
 
     // Main event loop
     while (running) {
@@ -113,30 +277,38 @@ int main(int argc, char* argv[])
             debugger.HandleEvent(event);
         }
 
-        // Update world timing
-        int currentTime = SDL_GetTicks();
-        deltaTime = (currentTime - lastTime) / 1000.0;
-        lastTime = currentTime;
+        // Grab the newest simulation state (never blocks the simulation)
+        const RenderSnapshot& snapshot = simulation.AcquireSnapshot();
 
-        // Update simulation
-        world.Update(deltaTime);
-
-        // Clear screen
+        // Clear screen (into the capture target while recording)
+        recorder.BeginFrame();
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
 
         // Render world and debugger overlay
-        world.Render(renderer);
-        debugger.Update();
+        {
+            AllocationScope scope(AllocationSubsystem::Render);
+            snapshot.Render(renderer);
+        }
+        {
+            AllocationScope scope(AllocationSubsystem::Overlay);
+            debugger.Update(snapshot);
+        }
 
         // Present the rendered frame
+        recorder.EndFrame(true);
         SDL_RenderPresent(renderer);
     }
 
+    // Stop the control server and simulation before the debugger and world go away
+    controlServer.Stop();
+    simulation.Stop();
+    recorder.Stop();
+
     // Cleanup resources
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
-    TTF_CloseFont(gFont);
+    TTF_CloseFont(font);
     TTF_Quit();
     SDL_Quit();
     return 0;